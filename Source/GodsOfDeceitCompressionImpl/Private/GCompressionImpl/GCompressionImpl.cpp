@@ -38,6 +38,7 @@
 #include "GCompressionImpl/GCompressionImpl.h"
 
 #include <ios>
+#include <utility>
 
 #include <Containers/StringConv.h>
 #include <Misc/AssertionMacros.h>
@@ -64,6 +65,92 @@ THIRD_PARTY_INCLUDES_END
 #define GCOMPRESSION_DECOMPRESS_ERROR_DIALOG_TITLE  "Decompression Error"
 #define GGCOMPRESSION_UNKNOWN_ERROR_MESSAGE         "GCompression: unknown error!"
 
+namespace
+{
+    /// NOTE
+    /// Forwards whatever the filter chain emits to the stream's sink
+    class SinkDevice
+    {
+    public:
+        typedef GCompressionByte char_type;
+        typedef boost::iostreams::sink_tag category;
+
+    private:
+        const GCompressionImpl::StreamSink* Sink;
+
+    public:
+        explicit SinkDevice(const GCompressionImpl::StreamSink* InSink)
+            : Sink(InSink)
+        {
+
+        }
+
+        std::streamsize write(const char_type* Data, std::streamsize Length)
+        {
+            (*Sink)(Data, static_cast<uint64>(Length));
+            return Length;
+        }
+    };
+
+    template <typename CALLABLE>
+    void GuardStream(const char* Title, CALLABLE Callable)
+    {
+        try
+        {
+            Callable();
+        }
+
+        catch (const boost::exception& Exception)
+        {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+            MessageBoxA(0, boost::diagnostic_information(Exception).c_str(),
+                        Title, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+            (void)Title;
+            checkf(false,
+                   TEXT("%s"),
+                   StringCast<WIDECHAR>(
+                       boost::diagnostic_information(Exception).c_str()).Get());
+        }
+
+        catch (const std::exception& Exception)
+        {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+            MessageBoxA(0, Exception.what(), Title, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+            (void)Title;
+            checkf(false, TEXT("%s"),
+                   StringCast<WIDECHAR>(Exception.what()).Get());
+        }
+
+        catch (...)
+        {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+            MessageBoxA(0, GGCOMPRESSION_UNKNOWN_ERROR_MESSAGE, Title, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+            (void)Title;
+            checkf(false,
+                   TEXT("%s"),
+                   StringCast<WIDECHAR>(
+                       GGCOMPRESSION_UNKNOWN_ERROR_MESSAGE).Get());
+        }
+    }
+}
+
+struct GCompressionImpl::Stream::Impl
+{
+public:
+    StreamSink Sink;
+    bool bCompress;
+    bool bFinished;
+    boost::iostreams::filtering_streambuf<boost::iostreams::output> Output;
+
+public:
+    Impl(const bool bInCompress, const StreamSink& InSink);
+
+    const char* GetErrorTitle() const;
+};
+
 void GCompressionImpl::Compress(const GCompressionByte* DataArray,
                                 const uint64 Length,
                                 GCompressionBuffer& Out_CompressedBuffer,
@@ -288,3 +375,111 @@ void GCompressionImpl::Decompress(const GCompressionBuffer& DataBuffer,
 
     Out_UncompressedString.assign(&DataBuffer[0], DataBuffer.size());
 }
+
+GCompressionImpl::Stream::Stream(const bool bCompress, const StreamSink& Sink,
+                                 const EGCompressionAlgorithm& Algorithm)
+    : Pimpl(std::make_unique<GCompressionImpl::Stream::Impl>(bCompress, Sink))
+{
+    GuardStream(Pimpl->GetErrorTitle(), [&]()
+    {
+        switch(Algorithm) {
+        case EGCompressionAlgorithm::Zlib:
+            if (bCompress)
+            {
+                Pimpl->Output.push(boost::iostreams::zlib_compressor());
+            }
+            else
+            {
+                Pimpl->Output.push(boost::iostreams::zlib_decompressor());
+            }
+            break;
+        case EGCompressionAlgorithm::Gzip:
+            checkf(false, TEXT("FATAL: Gzip compression algorithm is not"
+                               " supported! Use Zlib instead!"));
+            break;
+        case EGCompressionAlgorithm::Bzip2:
+            checkf(false, TEXT("FATAL: Bzip2 compression algorithm is not"
+                               " supported! Use Zlib instead!"));
+            break;
+        }
+
+        Pimpl->Output.push(SinkDevice(&Pimpl->Sink));
+    });
+}
+
+GCompressionImpl::Stream::Stream(Stream&& Other) = default;
+
+GCompressionImpl::Stream& GCompressionImpl::Stream::operator=(
+        Stream&& Other) = default;
+
+GCompressionImpl::Stream::~Stream()
+{
+    /// NOTE
+    /// An unfinished stream is abandoned, its pending output gets dropped
+    if (Pimpl && !Pimpl->bFinished)
+    {
+        try
+        {
+            Pimpl->Output.set_auto_close(false);
+            Pimpl->Output.reset();
+        }
+
+        catch (...)
+        {
+
+        }
+    }
+}
+
+void GCompressionImpl::Stream::Write(const GCompressionByte* Data,
+                                     const uint64 Length)
+{
+    checkf(!Pimpl->bFinished, TEXT("FATAL: write to a finished stream!"));
+
+    boost::iostreams::write(Pimpl->Output, Data,
+                            static_cast<std::streamsize>(Length));
+}
+
+void GCompressionImpl::Stream::Finish()
+{
+    if (Pimpl->bFinished)
+    {
+        return;
+    }
+
+    Pimpl->bFinished = true;
+
+    /// NOTE
+    /// Closing the chain flushes the filter and emits the trailer
+    Pimpl->Output.reset();
+}
+
+GCompressionImpl::Stream GCompressionImpl::CreateCompressor(
+        const StreamSink& Sink,
+        const EGCompressionAlgorithm& Algorithm)
+{
+    return Stream(true, Sink, Algorithm);
+}
+
+GCompressionImpl::Stream GCompressionImpl::CreateDecompressor(
+        const StreamSink& Sink,
+        const EGCompressionAlgorithm& Algorithm)
+{
+    return Stream(false, Sink, Algorithm);
+}
+
+GCompressionImpl::Stream::Impl::Impl(const bool bInCompress,
+                                     const StreamSink& InSink)
+    : Sink(InSink),
+      bCompress(bInCompress),
+      bFinished(false)
+{
+
+}
+
+const char* GCompressionImpl::Stream::Impl::GetErrorTitle() const
+{
+    return bCompress
+            ? GCOMPRESSION_COMPRESS_ERROR_DIALOG_TITLE
+            : GCOMPRESSION_DECOMPRESS_ERROR_DIALOG_TITLE;
+}
@@ -37,6 +37,8 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 
 #include <Containers/UnrealString.h>
@@ -46,6 +48,44 @@
 
 class GODSOFDECEITCOMPRESSIONIMPL_API GCompressionImpl
 {
+public:
+    /// NOTE
+    /// Receives each chunk a stream produces, as soon as it is produced
+    typedef std::function<void(const GCompressionByte* Data,
+                               const uint64 Length)> StreamSink;
+
+    /// NOTE
+    /// Incremental counterparts of Compress and Decompress. Input is fed in
+    /// arbitrary pieces through Write(), output is pushed to the sink in
+    /// bounded chunks, and Finish() flushes whatever the algorithm still
+    /// holds, e.g. zlib's trailer. Nothing is ever accumulated in memory.
+    ///
+    /// Unlike Compress and Decompress, Write() and Finish() show no error
+    /// dialog: corrupt input and anything the sink throws, e.g. an
+    /// std::ios_base::failure from a full disk, propagate to the caller.
+    class GODSOFDECEITCOMPRESSIONIMPL_API Stream
+    {
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> Pimpl;
+
+    public:
+        Stream(const bool bCompress, const StreamSink& Sink,
+               const EGCompressionAlgorithm& Algorithm);
+        Stream(Stream&& Other);
+        Stream& operator=(Stream&& Other);
+        virtual ~Stream();
+
+    public:
+        void Write(const GCompressionByte* Data, const uint64 Length);
+        void Finish();
+    };
+
+    static Stream CreateCompressor(const StreamSink& Sink,
+                                   const EGCompressionAlgorithm& Algorithm);
+    static Stream CreateDecompressor(const StreamSink& Sink,
+                                     const EGCompressionAlgorithm& Algorithm);
+
 public:
     static void Compress(const GCompressionByte* DataArray,
                          const uint64 Length,
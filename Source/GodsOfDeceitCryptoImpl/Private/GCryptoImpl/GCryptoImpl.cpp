@@ -52,6 +52,7 @@ THIRD_PARTY_INCLUDES_END
 
 THIRD_PARTY_INCLUDES_START
 #include <cryptopp/base64.h>
+#include <cryptopp/blake2.h>
 #include <cryptopp/filters.h>
 #include <cryptopp/hex.h>
 #include <cryptopp/hmac.h>
@@ -68,6 +69,8 @@ THIRD_PARTY_INCLUDES_END
 #define     GCRYPTO_ERROR_DIALOG_TITLE          "Cryptography Error"
 #define     GCRYPTO_UNKNOWN_ERROR_MESSAGE       "GCrypto: unknown error!"
 
+#define     GCRYPTO_HASH_SIZE                   32
+
 struct GCryptoImpl::Impl
 {
 public:
@@ -79,6 +82,15 @@ public:
     ~Impl();
 };
 
+struct GCryptoImpl::Signer::Impl
+{
+public:
+    CryptoPP::HMAC<CryptoPP::SHA512> HMAC;
+
+public:
+    Impl(const GCryptoByte* const Key, const uint64 KeySize);
+};
+
 void GCryptoImpl::ByteArrayToString(const GCryptoByte* Array,
                                     const uint64 Length,
                                     FString& Out_String)
@@ -384,6 +396,42 @@ void GCryptoImpl::Base64Encode(const FString& RawBuffer,
                 Out_Encoded);
 }
 
+uint64 GCryptoImpl::GetHashSize()
+{
+    return GCRYPTO_HASH_SIZE;
+}
+
+void GCryptoImpl::Hash(const GCryptoByte* const Data, const uint64 DataSize,
+                       GCryptoBuffer& Out_Digest)
+{
+    try
+    {
+        CryptoPP::BLAKE2b Hasher(false, GCRYPTO_HASH_SIZE);
+
+        Out_Digest.resize(GCRYPTO_HASH_SIZE);
+        Hasher.CalculateDigest(&Out_Digest[0], Data,
+                               static_cast<std::size_t>(DataSize));
+    }
+
+    catch (const CryptoPP::Exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GCRYPTO_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GCRYPTO_UNKNOWN_ERROR_MESSAGE, GCRYPTO_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GCRYPTO_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+}
+
 void GCryptoImpl::Sign(const GCryptoByte* Key, const uint64 KeySize,
                        const GCryptoByte* PlainBuffer, uint64 PlainBufferSize,
                        FString& Out_MAC)
@@ -508,6 +556,116 @@ void GCryptoImpl::Sign(const FString& PlainString, FString& Out_MAC) const
                       PlainString, Out_MAC);
 }
 
+GCryptoImpl::Signer GCryptoImpl::CreateSigner() const
+{
+    return Signer(Pimpl->SignKey, Pimpl->SignKeySize);
+}
+
+GCryptoImpl::Signer::Signer(const GCryptoByte* const Key, const uint64 KeySize)
+    : Pimpl(std::make_unique<GCryptoImpl::Signer::Impl>(Key, KeySize))
+{
+
+}
+
+GCryptoImpl::Signer::Signer(Signer&& Other) = default;
+
+GCryptoImpl::Signer& GCryptoImpl::Signer::operator=(Signer&& Other) = default;
+
+GCryptoImpl::Signer::~Signer() = default;
+
+uint64 GCryptoImpl::Signer::GetMACSize()
+{
+    return static_cast<uint64>(CryptoPP::HMAC<CryptoPP::SHA512>::DIGESTSIZE);
+}
+
+void GCryptoImpl::Signer::Update(const GCryptoByte* const Data,
+                                 const uint64 Length)
+{
+    try
+    {
+        Pimpl->HMAC.Update(Data, static_cast<std::size_t>(Length));
+    }
+
+    catch (const CryptoPP::Exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GCRYPTO_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GCRYPTO_UNKNOWN_ERROR_MESSAGE, GCRYPTO_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GCRYPTO_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+}
+
+void GCryptoImpl::Signer::Final(GCryptoBuffer& Out_MAC)
+{
+    Out_MAC.resize(static_cast<std::size_t>(GetMACSize()));
+    Pimpl->HMAC.Final(&Out_MAC[0]);
+}
+
+void GCryptoImpl::Signer::Final(FString& Out_MAC)
+{
+    GCryptoBuffer MAC;
+    Final(MAC);
+
+    Out_MAC = FString();
+
+    try
+    {
+        std::string Encoded;
+        CryptoPP::StringSource(&MAC[0], MAC.size(), true,
+                               new CryptoPP::Base64Encoder(
+                                   new CryptoPP::StringSink(Encoded)));
+
+        Out_MAC = StringCast<WIDECHAR>(Encoded.c_str()).Get();
+    }
+
+    catch (const CryptoPP::Exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GCRYPTO_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GCRYPTO_UNKNOWN_ERROR_MESSAGE, GCRYPTO_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GCRYPTO_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+}
+
+bool GCryptoImpl::Signer::Verify(const GCryptoByte* const MAC,
+                                 const uint64 MACSize)
+{
+    if (MACSize != GetMACSize())
+    {
+        Pimpl->HMAC.Restart();
+        return false;
+    }
+
+    return Pimpl->HMAC.Verify(MAC);
+}
+
+GCryptoImpl::Signer::Impl::Impl(const GCryptoByte* const Key,
+                                const uint64 KeySize)
+    : HMAC(Key, static_cast<std::size_t>(KeySize))
+{
+
+}
+
 GCryptoImpl::Impl::Impl()
 {
 
@@ -47,6 +47,41 @@
 
 class GODSOFDECEITCRYPTOIMPL_API GCryptoImpl
 {
+public:
+    /// NOTE
+    /// Incremental HMAC-SHA512, for data that is never held in memory as a
+    /// whole. Feed it through Update() and call Final() or Verify() once.
+    class GODSOFDECEITCRYPTOIMPL_API Signer
+    {
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> Pimpl;
+
+    public:
+        Signer(const GCryptoByte* const Key, const uint64 KeySize);
+        Signer(Signer&& Other);
+        Signer& operator=(Signer&& Other);
+        virtual ~Signer();
+
+    public:
+        static uint64 GetMACSize();
+
+        void Update(const GCryptoByte* const Data, const uint64 Length);
+
+        /// NOTE
+        /// Raw digest of everything fed so far; the signer starts over
+        /// afterwards
+        void Final(GCryptoBuffer& Out_MAC);
+        /// NOTE
+        /// Base64-encoded, same format as Sign()
+        void Final(FString& Out_MAC);
+
+        /// NOTE
+        /// Compares against a raw digest in constant time; the signer starts
+        /// over afterwards
+        bool Verify(const GCryptoByte* const MAC, const uint64 MACSize);
+    };
+
 private:
     struct Impl;
     std::unique_ptr<Impl> Pimpl;
@@ -86,6 +121,12 @@ public:
     static void Base64Encode(const FString& RawBuffer,
                              FString& Out_Encoded);
 
+    /// NOTE
+    /// BLAKE2b with a 256-bit digest; fast enough to key content by
+    static uint64 GetHashSize();
+    static void Hash(const GCryptoByte* const Data, const uint64 DataSize,
+                     GCryptoBuffer& Out_Digest);
+
     static void Sign(const GCryptoByte* const Key, const uint64 KeySize,
                      const GCryptoByte* const PlainBuffer, uint64 PlainBufferSize,
                      FString& Out_MAC);
@@ -106,4 +147,6 @@ public:
     void Sign(const GCryptoBuffer& PlainBuffer, FString& Out_MAC) const;
     void Sign(const std::string& PlainString, FString& Out_MAC) const;
     void Sign(const FString& PlainString, FString& Out_MAC) const;
+
+    Signer CreateSigner() const;
 };
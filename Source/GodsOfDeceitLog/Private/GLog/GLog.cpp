@@ -36,7 +36,10 @@
 
 #include "GLog/GLog.h"
 
+#include <mutex>
+
 #include <Containers/Map.h>
+#include <CoreGlobals.h>
 #include <Engine/Engine.h>
 #include <Logging/LogMacros.h>
 
@@ -67,7 +70,9 @@ public:
 public:
     TMap<GLogCore::EVerbosity, VerbosityMapper> VerbosityMap;
 
-    bool bInitialized;
+    /// NOTE
+    /// Loggers get constructed on worker threads as well
+    std::once_flag InitializedFlag;
 
 public:
     StaticImpl();
@@ -99,7 +104,7 @@ GLogCore::GLogCore(const EVerbosity& Verbosity,
       bAnyEntries(false)
 {
 #if defined ( GOD_LOGGING )
-    if (!SPimpl->bInitialized)
+    std::call_once(SPimpl->InitializedFlag, []()
     {
         SPimpl->VerbosityMap.Add(
                     GLogCore::EVerbosity::Fatal,
@@ -126,9 +131,7 @@ GLogCore::GLogCore(const EVerbosity& Verbosity,
                     GLogCore::EVerbosity::VeryVerbose,
                     StaticImpl::VerbosityMapper(TEXT("VERY_VERBOSE"),
                                                 FColor::Magenta));
-
-        SPimpl->bInitialized = true;
-    }
+    });
 
     Pimpl->Verbosity = Verbosity;
     Pimpl->Category = Category;
@@ -673,7 +676,10 @@ GLogCore::~GLogCore()
         }
     }
 
-    if (GEngine)
+    /// NOTE
+    /// The on-screen messages are only safe to touch from the game thread,
+    /// other threads make do with the log above
+    if (GEngine && IsInGameThread())
     {
         const FString OnScreenMessage(
                     FString::Printf(TEXT("[%s %s %s] %s"),
@@ -690,7 +696,6 @@ GLogCore::~GLogCore()
 }
 
 GLogCore::StaticImpl::StaticImpl()
-    : bInitialized(false)
 {
 
 }
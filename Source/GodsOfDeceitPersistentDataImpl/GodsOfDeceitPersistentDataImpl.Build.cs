@@ -108,6 +108,7 @@ public class GodsOfDeceitPersistentDataImpl : ModuleRules
         Utils.GameModules.AddCryptoImpl(false);
         Utils.GameModules.AddHacks(false);
         Utils.GameModules.AddInterop(false);
+        Utils.GameModules.AddLog(false);
         Utils.GameModules.AddPlatformImpl(false);
         Utils.GameModules.AddTypes(false);
         Utils.GameModules.AddUtilsImpl(false);
@@ -33,14 +33,29 @@
  * SQL connectivity layer with support for SQLite3
  */
 
-#define  GDATABASE_USE_CONNECTION_POOLING       0
+#define  GDATABASE_USE_CONNECTION_POOLING       1
+#define  GDATABASE_BUSY_TIMEOUT_MILLISECONDS    5000
+#define  GDATABASE_PROFILER_SAMPLES_PER_STATEMENT    512
+#define  GDATABASE_PROFILER_DEFAULT_SLOW_QUERY_MICROSECONDS    16000
 
 #include "GDatabase.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cctype>
 #include <cstddef>
 
+#include <Containers/Array.h>
 #include <Containers/StringConv.h>
 #include <Misc/AssertionMacros.h>
 
@@ -48,9 +63,7 @@ THIRD_PARTY_INCLUDES_START
 #include <cppdb/backend.h>
 #include <cppdb/driver_manager.h>
 #if GDATABASE_USE_CONNECTION_POOLING
-THIRD_PARTY_INCLUDES_START
 #include <cppdb/pool.h>
-THIRD_PARTY_INCLUDES_END
 #endif  /* GDATABASE_USE_CONNECTION_POOLING */
 #include <cppdb/utils.h>
 #include <fmt/format.h>
@@ -58,6 +71,7 @@ THIRD_PARTY_INCLUDES_END
 THIRD_PARTY_INCLUDES_END
 
 #include <GHacks/GInclude_Windows.h>
+#include <GLog/GLog.h>
 #include <GUtilsImpl/GStringUtilsImpl.h>
 
 #define  GDATABASE_ERROR_DIALOG_TITLE                 "Database Error"
@@ -74,18 +88,222 @@ extern "C"
                 cppdb::connection_info const&);
 }
 
+/// NOTE
+/// One-entry per-thread cache to skip the thread sessions map lookup on the
+/// hot path, keyed by instance id since addresses may be reused
+static thread_local uint64 CachedInstanceId = 0;
+static thread_local void* CachedSession = nullptr;
+
+/// NOTE
+/// Shared between a database and every thread holding one of its sessions;
+/// whichever of the two goes away first takes Lock and Release stops the
+/// other one from touching the session again
+struct GDatabaseThreadSessionRegistry
+{
+    std::mutex Lock;
+    std::function<void(void*)> Release;
+};
+
+/// NOTE
+/// Owns the calling thread's sessions, one per database instance, and hands
+/// them back to their database once the thread exits, so a thread that never
+/// calls ReleaseThreadSession() does not leak its connection
+struct GDatabaseThreadSessionHolder
+{
+    struct Entry
+    {
+        uint64 InstanceId;
+        void* Session;
+        std::weak_ptr<GDatabaseThreadSessionRegistry> Registry;
+    };
+
+    std::vector<Entry> Entries;
+
+    ~GDatabaseThreadSessionHolder()
+    {
+        for (Entry& Session : Entries)
+        {
+            std::shared_ptr<GDatabaseThreadSessionRegistry> Registry =
+                    Session.Registry.lock();
+
+            if (!Registry)
+            {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> LockGuard(Registry->Lock);
+            (void)LockGuard;
+
+            if (Registry->Release)
+            {
+                Registry->Release(Session.Session);
+            }
+        }
+    }
+};
+
+static thread_local GDatabaseThreadSessionHolder ThreadSessionHolder;
+
+/// NOTE
+/// Number of ErrorPropagationScope instances alive on this thread
+static thread_local uint32 ErrorPropagationDepth = 0;
+
+/// NOTE
+/// Only to be called from within a handler; logs and rethrows the exception
+/// being handled when the calling thread asked for it to be propagated
+static void RethrowIfPropagating(const char* What)
+{
+    if (ErrorPropagationDepth == 0)
+    {
+        return;
+    }
+
+    GLOG_SQL_WARNING(GLOG_KEY_SQL, FString(StringCast<WIDECHAR>(What).Get()));
+
+    throw;
+}
+
+/// NOTE
+/// Folds whitespace and replaces literals with '?' so that statements which
+/// only differ by inlined values end up under the same profiler entry
+static std::string NormalizeQuery(const std::string& Query)
+{
+    std::string Result;
+    Result.reserve(Query.size());
+
+    std::size_t i = 0;
+    while (i < Query.size())
+    {
+        const char Character = Query[i];
+
+        if (std::isspace(static_cast<unsigned char>(Character)))
+        {
+            while (i < Query.size()
+                   && std::isspace(static_cast<unsigned char>(Query[i])))
+            {
+                ++i;
+            }
+
+            if (!Result.empty())
+            {
+                Result += ' ';
+            }
+        }
+        else if (Character == '\'' || Character == '[' || Character == '"'
+                 || Character == '`')
+        {
+            const char Closing = (Character == '[' ? ']' : Character);
+            const std::size_t Start = i++;
+
+            while (i < Query.size() && Query[i] != Closing)
+            {
+                ++i;
+            }
+
+            i = std::min(i + 1, Query.size());
+
+            /// NOTE
+            /// Quoted identifiers are kept, string literals are not
+            if (Character == '\'')
+            {
+                Result += '?';
+            }
+            else
+            {
+                Result.append(Query, Start, i - Start);
+            }
+        }
+        else if (std::isdigit(static_cast<unsigned char>(Character))
+                 && (Result.empty()
+                     || !(std::isalnum(static_cast<unsigned char>(
+                                           Result.back()))
+                          || Result.back() == '_')))
+        {
+            while (i < Query.size()
+                   && (std::isalnum(static_cast<unsigned char>(Query[i]))
+                       || Query[i] == '.'))
+            {
+                ++i;
+            }
+
+            Result += '?';
+        }
+        else
+        {
+            Result += Character;
+            ++i;
+        }
+    }
+
+    while (!Result.empty() && Result.back() == ' ')
+    {
+        Result.pop_back();
+    }
+
+    return Result;
+}
+
+/// NOTE
+/// Some pragmas answer with a row (e.g. journal_mode or mmap_size), which
+/// cppdb::exec refuses, so every pragma is run as a query and drained
+static void ExecPragma(cppdb::session& Sql, const std::string& Pragma)
+{
+    cppdb::result Result = Sql << Pragma;
+    while (Result.next())
+    {
+
+    }
+}
+
+static void ApplyProfile(cppdb::session& Sql,
+                         const GDatabaseImpl::Profile& InProfile)
+{
+    static const char* const SynchronousModes[] = {
+        "OFF", "NORMAL", "FULL", "EXTRA"
+    };
+    static const char* const TempStores[] = {
+        "DEFAULT", "FILE", "MEMORY"
+    };
+    static const char* const LockingModes[] = {
+        "NORMAL", "EXCLUSIVE"
+    };
+
+    ExecPragma(Sql, fmt::format("PRAGMA page_size={0};", InProfile.PageSize));
+    ExecPragma(Sql, fmt::format("PRAGMA mmap_size={0};", InProfile.MmapSize));
+    ExecPragma(Sql, fmt::format("PRAGMA cache_size={0};",
+                                InProfile.CacheSize));
+    ExecPragma(Sql, fmt::format(
+                   "PRAGMA synchronous={0};",
+                   SynchronousModes[static_cast<uint8>(
+                       InProfile.Synchronous)]));
+    ExecPragma(Sql, fmt::format(
+                   "PRAGMA temp_store={0};",
+                   TempStores[static_cast<uint8>(InProfile.TempStore)]));
+    ExecPragma(Sql, fmt::format(
+                   "PRAGMA locking_mode={0};",
+                   LockingModes[static_cast<uint8>(InProfile.LockingMode)]));
+}
+
 struct Config
 {
     bool bWALMode;
+    GDatabaseImpl::Profile ConnectionProfile;
 
     void operator()(cppdb::session& Sql) const
     {
+        /// NOTE
+        /// page_size has to be set before the switch to WAL, it cannot
+        /// change afterwards
+        ApplyProfile(Sql, ConnectionProfile);
+
         if (bWALMode) {
-            Sql << "PRAGMA journal_mode=WAL;" << cppdb::exec;
+            ExecPragma(Sql, "PRAGMA journal_mode=WAL;");
         }
     }
 
-    Config(bool bInWALMode) : bWALMode(bInWALMode)
+    Config(bool bInWALMode, const GDatabaseImpl::Profile& InProfile)
+        : bWALMode(bInWALMode),
+          ConnectionProfile(InProfile)
     {
 
     }
@@ -106,6 +324,90 @@ GDatabaseImpl::SessionGuard::~SessionGuard()
     }
 }
 
+GDatabaseImpl::ErrorPropagationScope::ErrorPropagationScope()
+{
+    ++ErrorPropagationDepth;
+}
+
+GDatabaseImpl::ErrorPropagationScope::~ErrorPropagationScope()
+{
+    --ErrorPropagationDepth;
+}
+
+GDatabaseImpl::Profile GDatabaseImpl::Profile::Default()
+{
+    Profile Result;
+    Result.Name = TEXT("default");
+    Result.MmapSize = 0;
+    Result.CacheSize = -2000;
+    Result.PageSize = 4096;
+    Result.Synchronous = ESynchronous::Full;
+    Result.TempStore = ETempStore::Default;
+    Result.LockingMode = ELockingMode::Normal;
+    return Result;
+}
+
+GDatabaseImpl::Profile GDatabaseImpl::Profile::FastAutosave()
+{
+    Profile Result;
+    Result.Name = TEXT("fast-autosave");
+    Result.MmapSize = 64ll * 1024ll * 1024ll;
+    Result.CacheSize = -16384;
+    Result.PageSize = 4096;
+    Result.Synchronous = ESynchronous::Normal;
+    Result.TempStore = ETempStore::Memory;
+    Result.LockingMode = ELockingMode::Normal;
+    return Result;
+}
+
+GDatabaseImpl::Profile GDatabaseImpl::Profile::DurableCheckpoint()
+{
+    Profile Result;
+    Result.Name = TEXT("durable-checkpoint");
+    Result.MmapSize = 64ll * 1024ll * 1024ll;
+    Result.CacheSize = -8192;
+    Result.PageSize = 4096;
+    Result.Synchronous = ESynchronous::Full;
+    Result.TempStore = ETempStore::Default;
+    Result.LockingMode = ELockingMode::Normal;
+    return Result;
+}
+
+GDatabaseImpl::Profile GDatabaseImpl::Profile::ReadMostly()
+{
+    Profile Result;
+    Result.Name = TEXT("read-mostly");
+    Result.MmapSize = 256ll * 1024ll * 1024ll;
+    Result.CacheSize = -32768;
+    Result.PageSize = 4096;
+    Result.Synchronous = ESynchronous::Normal;
+    Result.TempStore = ETempStore::Memory;
+    Result.LockingMode = ELockingMode::Normal;
+    return Result;
+}
+
+bool GDatabaseImpl::Profile::FromName(const FString& Name,
+                                      Profile& Out_Profile)
+{
+    static const Profile Presets[] = {
+        Default(),
+        FastAutosave(),
+        DurableCheckpoint(),
+        ReadMostly()
+    };
+
+    for (const Profile& Preset : Presets)
+    {
+        if (Preset.Name.Equals(Name, ESearchCase::IgnoreCase))
+        {
+            Out_Profile = Preset;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 struct GDatabaseImpl::Impl
 {
 public:
@@ -117,22 +419,266 @@ public:
         GStringUtilsImpl::FStringKeyHasher, GStringUtilsImpl::FStringKeyEqual>
         TableFieldsHashTable;
 
-    Impl(const FString& databasePath, bool bWALMode);
+    enum class EStatementOperation : uint8
+    {
+        None,
+        Insert,
+        Update,
+        Delete,
+        BulkInsert,
+        Select
+    };
+
+    struct PreparedStatement
+    {
+        std::string Query;
+        cppdb::statement Statement;
+
+        /// NOTE
+        /// Held by every open cursor reading from Statement, so that the
+        /// statement does not get reset underneath it
+        std::shared_ptr<void> Lease;
+
+        /// NOTE
+        /// What the statement was prepared for, compared on a hash hit
+        EStatementOperation Operation = EStatementOperation::None;
+        int32 Variant = 0;
+        std::vector<FString> Shape;
+    };
+
+    /// NOTE
+    /// Identifies a cached statement by its operation, table id and shape
+    /// (i.e. the fields, set or where clauses) without concatenating or
+    /// copying any of them; they only get copied once, on a cache miss
+    struct StatementKey
+    {
+        static constexpr std::size_t MaxParts = 4;
+
+        EStatementOperation Operation;
+        int32 Variant;
+        const FString* Parts[MaxParts];
+        std::size_t PartsCount;
+        uint64 Hash;
+
+        StatementKey(const EStatementOperation InOperation,
+                     const int32 InVariant,
+                     std::initializer_list<const FString*> InParts);
+
+        bool Matches(const PreparedStatement& Entry) const;
+        std::vector<FString> MakeShape() const;
+    };
+
+    /// NOTE
+    /// Keyed by StatementKey::Hash; a repeated write only pays for hashing
+    /// its arguments in place, while collisions get told apart by Matches()
+    typedef std::unordered_multimap<uint64, PreparedStatement>
+        PreparedStatementsHashTable;
+
+    struct StatementProfile
+    {
+        uint64 Calls;
+        uint64 RowsAffected;
+        double TotalMilliseconds;
+        double MaxMilliseconds;
+        uint64 SlowCalls;
+        bool bPlanLogged;
+        std::vector<float> Samples;
+
+        StatementProfile()
+            : Calls(0),
+              RowsAffected(0),
+              TotalMilliseconds(0.0),
+              MaxMilliseconds(0.0),
+              SlowCalls(0),
+              bPlanLogged(false)
+        {
+
+        }
+    };
+
+    typedef std::unordered_map<std::string, StatementProfile>
+        StatementProfilesHashTable;
+    typedef std::unordered_map<std::string, std::string>
+        NormalizedQueriesHashTable;
+
+    /// NOTE
+    /// Statement timings of a single thread, merged only when the stats get
+    /// read; its lock is contended by nothing but such a read
+    struct ThreadProfile
+    {
+        std::mutex Lock;
+        StatementProfilesHashTable StatementProfiles;
+        NormalizedQueriesHashTable NormalizedQueries;
+        std::minstd_rand SampleGenerator;
+    };
+
+    /// NOTE
+    /// Every thread talks to the database through its own session (and its
+    /// own statement cache), so that readers on worker threads can run in
+    /// parallel with the game thread under WAL
+    struct ThreadSession
+    {
+        cppdb::session Sql;
+        PreparedStatementsHashTable PreparedStatements;
+        /// NOTE
+        /// Typed table statements, indexed by their process-wide slot
+        std::vector<PreparedStatement> SlotStatements;
+        uint64 SchemaGeneration;
+        uint64 ProfileGeneration;
+        /// NOTE
+        /// Between OpenSession() and CloseSession(); Sql stays connected
+        /// past the latter
+        bool bOpen;
+        /// NOTE
+        /// Created by the first statement the thread profiles
+        std::shared_ptr<ThreadProfile> Profiler;
+
+        ThreadSession()
+            : SchemaGeneration(0),
+              ProfileGeneration(0),
+              bOpen(false)
+        {
+
+        }
+    };
+
+    /// NOTE
+    /// Keyed by the session itself rather than by std::thread::id, since a
+    /// finished thread's id may be handed to a brand new thread
+    typedef std::unordered_map<ThreadSession*, std::unique_ptr<ThreadSession>>
+        ThreadSessionsHashTable;
+
+    /// NOTE
+    /// Times one execution of a prepared statement; nothing is recorded if
+    /// the statement throws before Stop() gets called
+    class StatementTimer
+    {
+    private:
+        Impl& Owner;
+        cppdb::session& Session;
+        const std::string& Query;
+        std::chrono::steady_clock::time_point Start;
+        bool bEnabled;
+
+    public:
+        StatementTimer(Impl& InOwner, cppdb::session& InSession,
+                       const std::string& InQuery);
+
+        void Stop(const uint64 RowsAffected);
+    };
+
+    Impl(const FString& databasePath, bool bWALMode,
+         uint32 ConnectionPoolSize, const Profile& InProfile);
     ~Impl();
 
 public:
+    ThreadSession& FindThreadSession();
+    ThreadSession& GetThreadSession();
+    void ReleaseThreadSession();
+    void CloseThreadSession(ThreadSession* Released);
+
+    static PreparedStatementsHashTable::iterator FindPreparedStatement(
+            PreparedStatementsHashTable& PreparedStatements,
+            const StatementKey& Key);
+    template <typename QUERY_BUILDER>
+    PreparedStatement& GetPreparedStatement(cppdb::session& Session,
+                                           const StatementKey& Key,
+                                           QUERY_BUILDER&& BuildQuery);
+    template <typename QUERY_BUILDER>
+    cppdb::statement GetLeasedStatement(cppdb::session& Session,
+                                        const StatementKey& Key,
+                                        QUERY_BUILDER&& BuildQuery,
+                                        std::shared_ptr<void>& Out_Lease);
+    PreparedStatement& GetSlotStatement(cppdb::session& Session,
+                                        const std::size_t Slot,
+                                        const std::string& Query);
+    cppdb::statement GetLeasedSlotStatement(cppdb::session& Session,
+                                            const std::size_t Slot,
+                                            const std::string& Query,
+                                            std::shared_ptr<void>& Out_Lease);
+    void ResetPreparedStatements();
+    void InvalidatePreparedStatements();
+
+    Profile GetProfile() const;
+    void RefreshProfile(ThreadSession& Session);
+
+    static void MergeProfile(const StatementProfile& From,
+                             StatementProfile& Into);
+    ThreadProfile& GetThreadProfile();
+    void RetireThreadProfile(ThreadSession& Session);
+    void RecordStatement(cppdb::session& Session, const std::string& Query,
+                         const std::chrono::steady_clock::duration& Elapsed,
+                         const uint64 RowsAffected);
+
+public:
+    static std::atomic<uint64> NextInstanceId;
+    static std::atomic<std::size_t> NextStatementSlot;
+
+    const uint64 InstanceId;
+    const FString DatabasePath;
+    const bool bWALMode;
+    const uint32 ConnectionPoolSize;
+
     cppdb::connection_info Connection;
 
 #if GDATABASE_USE_CONNECTION_POOLING
     cppdb::pool::pointer Pool;
 #endif  /* GDATABASE_USE_CONNECTION_POOLING */
 
-    cppdb::session Sql;
-
+    std::mutex ThreadSessionsLock;
+    ThreadSessionsHashTable ThreadSessions;
+    std::shared_ptr<GDatabaseThreadSessionRegistry> ThreadSessionRegistry;
+
+    /// NOTE
+    /// SQLite allows a single writer at a time, serializing mutations here
+    /// keeps concurrent writers from running into SQLITE_BUSY
+    std::recursive_mutex WriteLock;
+
+    std::atomic<uint64> SchemaGeneration;
+
+    mutable std::mutex ProfileLock;
+    Profile ActiveProfile;
+    std::atomic<uint64> ProfileGeneration;
+
+    std::atomic<uint64> SessionsOpened;
+    std::atomic<uint64> SessionsClosed;
+    std::atomic<uint64> WriteLockContentions;
+
+    std::atomic<bool> bProfileStatements;
+    std::atomic<int64> SlowQueryThreshold;
+    /// NOTE
+    /// Guards the list of thread profiles and what threads that released
+    /// their session left behind; never taken per statement
+    mutable std::mutex ProfilerLock;
+    std::vector<std::shared_ptr<ThreadProfile>> ThreadProfiles;
+    StatementProfilesHashTable RetiredProfiles;
+
+    /// NOTE
+    /// Guards TableNames and TableFields, which get read while building the
+    /// queries of any thread's statement cache
+    mutable std::mutex TablesLock;
     TableNamesHashTable TableNames;
     TableFieldsHashTable TableFields;
 };
 
+std::atomic<uint64> GDatabaseImpl::Impl::NextInstanceId(1);
+std::atomic<std::size_t> GDatabaseImpl::Impl::NextStatementSlot(0);
+
+GDatabaseImpl::WriteGuard::WriteGuard(GDatabaseImpl& InInstance)
+    : Instance(InInstance)
+{
+    if (!Instance.Pimpl->WriteLock.try_lock())
+    {
+        ++Instance.Pimpl->WriteLockContentions;
+        Instance.Pimpl->WriteLock.lock();
+    }
+}
+
+GDatabaseImpl::WriteGuard::~WriteGuard()
+{
+    Instance.Pimpl->WriteLock.unlock();
+}
+
 bool GDatabaseImpl::bSqlite3DriverLoaded = false;
 
 void GDatabaseImpl::LoadSqlite3Driver()
@@ -172,22 +718,34 @@ void GDatabaseImpl::LoadSqlite3Driver()
 
 bool GDatabaseImpl::Sqlite3Vacuum(const FString& DatabasePath)
 {
-    sqlite3* Database;
+    sqlite3* Database = nullptr;
 
     int ReturnCode = sqlite3_open(StringCast<ANSICHAR>(*DatabasePath).Get(),
                                   &Database);
 
     if (!ReturnCode)
     {
-        sqlite3_exec(Database, "VACUUM;", 0, 0, 0);
-        return true;
+        ReturnCode = sqlite3_exec(Database, "VACUUM;", 0, 0, 0);
     }
 
-    return false;
+    /// NOTE
+    /// sqlite3_open() hands out a handle even when it fails
+    sqlite3_close(Database);
+
+    return ReturnCode == SQLITE_OK;
+}
+
+std::size_t GDatabaseImpl::AllocateStatementSlot()
+{
+    return Impl::NextStatementSlot++;
 }
 
-GDatabaseImpl::GDatabaseImpl(const FString& DatabasePath, bool bWALMode)
-    : Pimpl(std::make_unique<GDatabaseImpl::Impl>(DatabasePath, bWALMode))
+GDatabaseImpl::GDatabaseImpl(const FString& DatabasePath, bool bWALMode,
+                             uint32 ConnectionPoolSize,
+                             const Profile& InProfile)
+    : Pimpl(std::make_unique<GDatabaseImpl::Impl>(DatabasePath, bWALMode,
+                                                  ConnectionPoolSize,
+                                                  InProfile))
 {
 
 }
@@ -197,18 +755,48 @@ GDatabaseImpl::~GDatabaseImpl()
 
 }
 
+const FString& GDatabaseImpl::GetDatabasePath() const
+{
+    return Pimpl->DatabasePath;
+}
+
 bool GDatabaseImpl::IsSessionOpen()
 {
-    return Pimpl->Sql.is_open();
+    return Pimpl->GetThreadSession().bOpen;
 }
 
 bool GDatabaseImpl::OpenSession()
 {
     try
     {
-        if (!Pimpl->Sql.is_open())
+        Impl::ThreadSession& Session = Pimpl->GetThreadSession();
+
+        if (!Session.bOpen)
         {
-            Pimpl->Sql.open(Pimpl->Connection);
+            /// NOTE
+            /// The thread keeps its connection, and the statements prepared
+            /// on it, from one session to the next
+            if (!Session.Sql.is_open())
+            {
+#if GDATABASE_USE_CONNECTION_POOLING
+                Session.Sql = cppdb::session(Pimpl->Pool->open(),
+                                             Config(Pimpl->bWALMode,
+                                                    Pimpl->GetProfile()));
+#else
+                Session.Sql = cppdb::session(Pimpl->Connection,
+                                             Config(Pimpl->bWALMode,
+                                                    Pimpl->GetProfile()));
+#endif  /* GDATABASE_USE_CONNECTION_POOLING */
+
+                ++Pimpl->SessionsOpened;
+            }
+
+            /// NOTE
+            /// A pooled or kept connection may still carry the profile that
+            /// was active when it was last used
+            Pimpl->RefreshProfile(Session);
+
+            Session.bOpen = true;
         }
         else
         {
@@ -249,9 +837,15 @@ bool GDatabaseImpl::OpenSession()
 bool GDatabaseImpl::CloseSession()
 {
     try {
-        if (Pimpl->Sql.is_open())
+        Impl::ThreadSession& Session = Pimpl->GetThreadSession();
+
+        if (Session.bOpen)
         {
-            Pimpl->Sql.close();
+            /// NOTE
+            /// Only ends the session; the connection and its prepared
+            /// statements stay with the thread until ReleaseThreadSession()
+            Pimpl->ResetPreparedStatements();
+            Session.bOpen = false;
 
             return true;
         }
@@ -309,11 +903,27 @@ bool GDatabaseImpl::Initialize()
             return false;
         }
 
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
+
         cppdb::transaction TransactionGuard(Sql());
 
-        for (const auto& TableName : Pimpl->TableNames)
+        std::vector<FString> TableIds;
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+            (void)LockGuard;
+
+            TableIds.reserve(Pimpl->TableNames.size());
+            for (const auto& TableName : Pimpl->TableNames)
+            {
+                TableIds.push_back(TableName.first);
+            }
+        }
+
+        for (const FString& TableId : TableIds)
         {
-            CreateTable(TableName.first);
+            CreateTable(TableId);
         }
 
         TransactionGuard.commit();
@@ -362,15 +972,22 @@ void GDatabaseImpl::RegisterTable(
         const FString& name,
         const FString& fields)
 {
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+    (void)LockGuard;
+
     Pimpl->TableNames[id] = name;
     Pimpl->TableFields[id] = fields;
 }
 
 FString GDatabaseImpl::GetTableName(const FString& Id) const
 {
-    if (Pimpl->TableNames.find(Id) != Pimpl->TableNames.end())
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+    (void)LockGuard;
+
+    auto Iterator = Pimpl->TableNames.find(Id);
+    if (Iterator != Pimpl->TableNames.end())
     {
-        return Pimpl->TableNames[Id];
+        return Iterator->second;
     }
 
     checkf(false, TEXT("%s"),
@@ -383,9 +1000,13 @@ FString GDatabaseImpl::GetTableName(const FString& Id) const
 
 FString GDatabaseImpl::GetTableFields(const FString& Id) const
 {
-    if (Pimpl->TableFields.find(Id) != Pimpl->TableFields.end())
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+    (void)LockGuard;
+
+    auto Iterator = Pimpl->TableFields.find(Id);
+    if (Iterator != Pimpl->TableFields.end())
     {
-        return Pimpl->TableFields[Id];
+        return Iterator->second;
     }
 
     checkf(false, TEXT("%s"),
@@ -398,10 +1019,14 @@ FString GDatabaseImpl::GetTableFields(const FString& Id) const
 
 void GDatabaseImpl::SetTableName(const FString& Id, const FString& NewName)
 {
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+    (void)LockGuard;
+
     auto Iterator = Pimpl->TableNames.find(Id);
     if (Iterator != Pimpl->TableNames.end())
     {
         Iterator->second = NewName;
+        Pimpl->InvalidatePreparedStatements();
         return;
     }
 
@@ -413,6 +1038,9 @@ void GDatabaseImpl::SetTableName(const FString& Id, const FString& NewName)
 
 void GDatabaseImpl::SetTableFields(const FString& Id, const FString& Fields)
 {
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+    (void)LockGuard;
+
     auto Iterator = Pimpl->TableFields.find(Id);
     if (Iterator != Pimpl->TableFields.end()) {
         Iterator->second = Fields;
@@ -427,7 +1055,9 @@ void GDatabaseImpl::SetTableFields(const FString& Id, const FString& Fields)
 
 cppdb::session& GDatabaseImpl::Sql()
 {
-    bool bIsOpen = Pimpl->Sql.is_open();
+    Impl::ThreadSession& ThreadSession = Pimpl->GetThreadSession();
+    cppdb::session& Session = ThreadSession.Sql;
+    bool bIsOpen = ThreadSession.bOpen && Session.is_open();
 
 #if defined ( _WIN32 ) || defined ( _WIN64 )
     if (!bIsOpen)
@@ -439,22 +1069,39 @@ cppdb::session& GDatabaseImpl::Sql()
     checkf(bIsOpen, TEXT("%s"),
            StringCast<WIDECHAR>(GDATABASE_CONNECTION_NOT_OPENED_ERROR).Get());
 
-    return Pimpl->Sql;
+    return Session;
 }
 
-void GDatabaseImpl::CreateTable(const FString& Id)
+GDatabaseImpl::Profile GDatabaseImpl::GetProfile() const
+{
+    return Pimpl->GetProfile();
+}
+
+void GDatabaseImpl::SetProfile(const Profile& NewProfile)
 {
     try
     {
-        std::string Query(
-                    fmt::format(
-                        "CREATE TABLE IF NOT EXISTS [{0}] ( {1} );",
-                        StringCast<ANSICHAR>(
-                            *GetTableName(Id)).Get(),
-                        StringCast<ANSICHAR>(
-                            *GetTableFields(Id)).Get()));
+        {
+            std::lock_guard<std::mutex> LockGuard(Pimpl->ProfileLock);
+            (void)LockGuard;
 
-        Sql() << Query << cppdb::exec;
+            Pimpl->ActiveProfile = NewProfile;
+            ++Pimpl->ProfileGeneration;
+        }
+
+#if GDATABASE_USE_CONNECTION_POOLING
+        /// NOTE
+        /// Idle connections would come back with the old settings, new ones
+        /// get the profile applied as they open
+        Pimpl->Pool->clear();
+#endif  /* GDATABASE_USE_CONNECTION_POOLING */
+
+        Impl::ThreadSession& Session = Pimpl->GetThreadSession();
+
+        if (Session.Sql.is_open())
+        {
+            Pimpl->RefreshProfile(Session);
+        }
     }
 
     catch (const fmt::v5::format_error& Exception)
@@ -486,85 +1133,205 @@ void GDatabaseImpl::CreateTable(const FString& Id)
     }
 }
 
-void GDatabaseImpl::DropTable(const FString& Id)
+bool GDatabaseImpl::SetProfile(const FString& Name)
 {
-    try
-    {
-        std::string Query(
-                    fmt::format(
-                        "DROP TABLE IF EXISTS [{0}];",
-                        StringCast<ANSICHAR>(*GetTableName(Id)).Get()));
-
-        Sql() << Query << cppdb::exec;
-    }
+    Profile NewProfile;
 
-    catch (const fmt::v5::format_error& Exception)
+    if (!Profile::FromName(Name, NewProfile))
     {
-#if defined ( _WIN32 ) || defined ( _WIN64 )
-        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
-#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
-        checkf(false, TEXT("%s"),
-               StringCast<WIDECHAR>(Exception.what()).Get());
+        return false;
     }
 
-    catch (const std::exception& Exception)
-    {
-#if defined ( _WIN32 ) || defined ( _WIN64 )
-        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
-#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
-        checkf(false, TEXT("%s"),
-               StringCast<WIDECHAR>(Exception.what()).Get());
-    }
+    SetProfile(NewProfile);
+    return true;
+}
 
-    catch (...)
-    {
-#if defined ( _WIN32 ) || defined ( _WIN64 )
-        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
-                    MB_OK);
-#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
-        checkf(false, TEXT("%s"),
-               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
-    }
+void GDatabaseImpl::SetStatementProfilingEnabled(bool bEnabled)
+{
+    Pimpl->bProfileStatements = bEnabled;
 }
 
-void GDatabaseImpl::RenameTable(const FString& Id, const FString& NewName)
+bool GDatabaseImpl::IsStatementProfilingEnabled() const
 {
-    try
+    return Pimpl->bProfileStatements.load();
+}
+
+void GDatabaseImpl::SetSlowQueryThreshold(
+        const std::chrono::microseconds& Threshold)
+{
+    Pimpl->SlowQueryThreshold = static_cast<int64>(Threshold.count());
+}
+
+std::chrono::microseconds GDatabaseImpl::GetSlowQueryThreshold() const
+{
+    return std::chrono::microseconds(Pimpl->SlowQueryThreshold.load());
+}
+
+std::vector<GDatabaseImpl::StatementStats> GDatabaseImpl::GetStatementStats() const
+{
+    std::vector<StatementStats> Result;
+
+    Impl::StatementProfilesHashTable Merged;
+
     {
-        auto Iterator = Pimpl->TableNames.find(Id);
-        if (Iterator != Pimpl->TableNames.end())
-        {
-            std::string Query(
-                        fmt::format(
-                            "ALTER TABLE [{0}] RENAME TO [{1}];",
-                            StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
-                            StringCast<ANSICHAR>(*NewName).Get()));
+        std::lock_guard<std::mutex> LockGuard(Pimpl->ProfilerLock);
+        (void)LockGuard;
 
-            Sql() << Query << cppdb::exec;
+        Merged = Pimpl->RetiredProfiles;
+
+        for (const std::shared_ptr<Impl::ThreadProfile>& Thread
+             : Pimpl->ThreadProfiles)
+        {
+            std::lock_guard<std::mutex> ThreadLockGuard(Thread->Lock);
+            (void)ThreadLockGuard;
 
-            Iterator->second = NewName;
+            for (const auto& Statement : Thread->StatementProfiles)
+            {
+                Impl::MergeProfile(Statement.second,
+                                   Merged[Statement.first]);
+            }
         }
     }
 
-    catch (const fmt::v5::format_error& Exception)
-    {
-#if defined ( _WIN32 ) || defined ( _WIN64 )
-        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
-#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
-        checkf(false, TEXT("%s"),
-               StringCast<WIDECHAR>(Exception.what()).Get());
-    }
+    Result.reserve(Merged.size());
 
-    catch (const std::exception& Exception)
+    std::vector<float> Samples;
+
+    for (const auto& Statement : Merged)
     {
-#if defined ( _WIN32 ) || defined ( _WIN64 )
+        StatementStats Stats;
+        Stats.Sql = StringCast<WIDECHAR>(Statement.first.c_str()).Get();
+        Stats.Calls = Statement.second.Calls;
+        Stats.RowsAffected = Statement.second.RowsAffected;
+        Stats.TotalMilliseconds = Statement.second.TotalMilliseconds;
+        Stats.MaxMilliseconds = Statement.second.MaxMilliseconds;
+        Stats.SlowCalls = Statement.second.SlowCalls;
+        Stats.P50Milliseconds = 0.0;
+        Stats.P99Milliseconds = 0.0;
+
+        Samples = Statement.second.Samples;
+
+        if (!Samples.empty())
+        {
+            const std::size_t P50 = (Samples.size() - 1) * 50 / 100;
+            const std::size_t P99 = (Samples.size() - 1) * 99 / 100;
+
+            std::nth_element(Samples.begin(), Samples.begin() + P50,
+                             Samples.end());
+            Stats.P50Milliseconds = Samples[P50];
+
+            std::nth_element(Samples.begin(), Samples.begin() + P99,
+                             Samples.end());
+            Stats.P99Milliseconds = Samples[P99];
+        }
+
+        Result.push_back(std::move(Stats));
+    }
+
+    std::sort(Result.begin(), Result.end(),
+              [](const StatementStats& Left, const StatementStats& Right) {
+        return Left.TotalMilliseconds > Right.TotalMilliseconds;
+    });
+
+    return Result;
+}
+
+FString GDatabaseImpl::DumpStatementStats() const
+{
+    const std::vector<StatementStats> Stats(GetStatementStats());
+
+    FString Result(TEXT("SQL statement profile "
+                        "(calls, rows, total ms, p50 ms, p99 ms, max ms, "
+                        "slow calls, statement):"));
+
+    for (const StatementStats& Entry : Stats)
+    {
+        Result += FString::Printf(
+                    TEXT("\n%8llu %10llu %12.3f %9.3f %9.3f %9.3f %6llu  %s"),
+                    static_cast<unsigned long long>(Entry.Calls),
+                    static_cast<unsigned long long>(Entry.RowsAffected),
+                    Entry.TotalMilliseconds, Entry.P50Milliseconds,
+                    Entry.P99Milliseconds, Entry.MaxMilliseconds,
+                    static_cast<unsigned long long>(Entry.SlowCalls),
+                    *Entry.Sql);
+    }
+
+    GLOG_SQL(Result);
+
+    return Result;
+}
+
+void GDatabaseImpl::ResetStatementStats()
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->ProfilerLock);
+    (void)LockGuard;
+
+    Pimpl->RetiredProfiles.clear();
+
+    for (const std::shared_ptr<Impl::ThreadProfile>& Thread
+         : Pimpl->ThreadProfiles)
+    {
+        std::lock_guard<std::mutex> ThreadLockGuard(Thread->Lock);
+        (void)ThreadLockGuard;
+
+        Thread->StatementProfiles.clear();
+    }
+}
+
+GDatabaseImpl::ConnectionPoolStats GDatabaseImpl::GetConnectionPoolStats()
+{
+    ConnectionPoolStats Stats;
+
+    Stats.PoolSize = Pimpl->ConnectionPoolSize;
+    Stats.ThreadSessions = 0;
+    Stats.OpenSessions = 0;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->ThreadSessionsLock);
+        (void)LockGuard;
+
+        for (const auto& Session : Pimpl->ThreadSessions)
+        {
+            ++Stats.ThreadSessions;
+
+            if (Session.second->Sql.is_open())
+            {
+                ++Stats.OpenSessions;
+            }
+        }
+    }
+
+    Stats.SessionsOpened = Pimpl->SessionsOpened.load();
+    Stats.SessionsClosed = Pimpl->SessionsClosed.load();
+    Stats.WriteLockContentions = Pimpl->WriteLockContentions.load();
+
+    return Stats;
+}
+
+void GDatabaseImpl::ReleaseThreadSession()
+{
+    Pimpl->ReleaseThreadSession();
+}
+
+void GDatabaseImpl::CollectIdleConnections()
+{
+#if GDATABASE_USE_CONNECTION_POOLING
+    try
+    {
+        Pimpl->Pool->gc();
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
 #endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
         checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(Exception.what()).Get());
     }
 
-    catch (...) {
+    catch (...)
+    {
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
                     MB_OK);
@@ -572,43 +1339,25 @@ void GDatabaseImpl::RenameTable(const FString& Id, const FString& NewName)
         checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
     }
+#endif  /* GDATABASE_USE_CONNECTION_POOLING */
 }
 
-void GDatabaseImpl::Insert(
-        const FString& Id,
-        const FString& Fields,
-        const std::initializer_list<FString>& Args)
+void GDatabaseImpl::CreateTable(const FString& Id)
 {
     try
     {
-        FString PreparedArgs;
-        for (std::size_t i = 0; i < Args.size(); ++i)
-        {
-            if (i != 0) {
-                PreparedArgs += TEXT(", ");
-            }
-
-            PreparedArgs += TEXT("?");
-        }
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
 
         std::string Query(
                     fmt::format(
-                        "INSERT INTO [{0}] ( {1} ) VALUES ( {2} );",
-                        StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
-                        StringCast<ANSICHAR>(*Fields).Get(),
-                        StringCast<ANSICHAR>(*PreparedArgs).Get()));
-
-        cppdb::statement Statement = Sql() << Query;
-
-        bool bFirstLogStringArg = true;
-        FString ArgsLogString;
-
-        for(const FString& Arg : Args)
-        {
-            Statement.bind(StringCast<ANSICHAR>(*Arg).Get());
-        }
+                        "CREATE TABLE IF NOT EXISTS [{0}] ( {1} );",
+                        StringCast<ANSICHAR>(
+                            *GetTableName(Id)).Get(),
+                        StringCast<ANSICHAR>(
+                            *GetTableFields(Id)).Get()));
 
-        Statement.exec();
+        Sql() << Query << cppdb::exec;
     }
 
     catch (const fmt::v5::format_error& Exception)
@@ -640,30 +1389,84 @@ void GDatabaseImpl::Insert(
     }
 }
 
-void GDatabaseImpl::Update(
-        const FString& Id,
-        const FString& Where,
-        const FString& Value,
-        const FString& Set,
-        const std::initializer_list<FString>& Args)
+void GDatabaseImpl::DropTable(const FString& Id)
 {
     try
     {
         std::string Query(
                     fmt::format(
-                        "UPDATE ONLY [{0}] SET {1} WHERE {2} = ?;",
-                        StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
-                        StringCast<ANSICHAR>(*Set).Get(),
-                        StringCast<ANSICHAR>(*Where).Get()));
+                        "DROP TABLE IF EXISTS [{0}];",
+                        StringCast<ANSICHAR>(*GetTableName(Id)).Get()));
 
-        cppdb::statement Statement = Sql() << Query;
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
+
+        Pimpl->InvalidatePreparedStatements();
+        Sql() << Query << cppdb::exec;
+    }
+
+    catch (const fmt::v5::format_error& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+}
+
+void GDatabaseImpl::RenameTable(const FString& Id, const FString& NewName)
+{
+    try
+    {
+        bool bRegistered = false;
 
-        for(const FString& Arg : Args)
         {
-            Statement.bind(StringCast<ANSICHAR>(*Arg).Get());
+            std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+            (void)LockGuard;
+
+            bRegistered = Pimpl->TableNames.find(Id)
+                    != Pimpl->TableNames.end();
         }
 
-        Statement.exec();
+        if (bRegistered)
+        {
+            std::string Query(
+                        fmt::format(
+                            "ALTER TABLE [{0}] RENAME TO [{1}];",
+                            StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
+                            StringCast<ANSICHAR>(*NewName).Get()));
+
+            GDatabaseImpl::WriteGuard WriteGuard(*this);
+            (void)WriteGuard;
+
+            Pimpl->InvalidatePreparedStatements();
+            Sql() << Query << cppdb::exec;
+
+            std::lock_guard<std::mutex> LockGuard(Pimpl->TablesLock);
+            (void)LockGuard;
+
+            Pimpl->TableNames[Id] = NewName;
+        }
     }
 
     catch (const fmt::v5::format_error& Exception)
@@ -684,8 +1487,7 @@ void GDatabaseImpl::Update(
                StringCast<WIDECHAR>(Exception.what()).Get());
     }
 
-    catch (...)
-    {
+    catch (...) {
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
                     MB_OK);
@@ -695,26 +1497,59 @@ void GDatabaseImpl::Update(
     }
 }
 
-void GDatabaseImpl::Delete(
+bool GDatabaseImpl::Insert(
         const FString& Id,
-        const FString& Where,
-        const FString& Value)
+        const FString& Fields,
+        const std::initializer_list<FString>& Args)
 {
     try
     {
-        std::string Query(
-                    fmt::format(
-                        "DELETE FROM ONLY [{0}] WHERE {1} = ?;",
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
+
+        cppdb::session& Session = Sql();
+
+        Impl::PreparedStatement& Entry = Pimpl->GetPreparedStatement(
+                    Session,
+                    Impl::StatementKey(Impl::EStatementOperation::Insert, 0,
+                                       { &Id, &Fields }),
+                    [&]()
+        {
+            FString PreparedArgs;
+            for (std::size_t i = 0; i < Args.size(); ++i)
+            {
+                if (i != 0) {
+                    PreparedArgs += TEXT(", ");
+                }
+
+                PreparedArgs += TEXT("?");
+            }
+
+            return fmt::format(
+                        "INSERT INTO [{0}] ( {1} ) VALUES ( {2} );",
                         StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
-                        StringCast<ANSICHAR>(*Where).Get()));
+                        StringCast<ANSICHAR>(*Fields).Get(),
+                        StringCast<ANSICHAR>(*PreparedArgs).Get());
+        });
+
+        cppdb::statement& Statement = Entry.Statement;
+        Impl::StatementTimer Timer(*Pimpl, Session, Entry.Query);
+
+        for(const FString& Arg : Args)
+        {
+            Statement.bind(StringCast<ANSICHAR>(*Arg).Get());
+        }
+
+        Statement.exec();
+        Timer.Stop(static_cast<uint64>(Statement.affected()));
 
-        Sql() << Query
-              << StringCast<ANSICHAR>(*Value).Get()
-              << cppdb::exec;
+        return true;
     }
 
     catch (const fmt::v5::format_error& Exception)
     {
+        RethrowIfPropagating(Exception.what());
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
 #endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
@@ -724,15 +1559,19 @@ void GDatabaseImpl::Delete(
 
     catch (const std::exception& Exception)
     {
+        RethrowIfPropagating(Exception.what());
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
 #endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
-        checkf(false,TEXT("%s"),
+        checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(Exception.what()).Get());
     }
 
     catch (...)
     {
+        RethrowIfPropagating(GDATABASE_UNKNOWN_ERROR);
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
                     MB_OK);
@@ -740,35 +1579,68 @@ void GDatabaseImpl::Delete(
         checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
     }
+
+    return false;
 }
 
-GDatabaseImpl::Impl::Impl(
-        const FString& DatabasePath,
-        bool bWALMode)
-    : Connection(fmt::format(
-                     "sqlite3:db={0};",
-                     StringCast<ANSICHAR>(*DatabasePath).Get())),
-      #if GDATABASE_USE_CONNECTION_POOLING
-      Pool(cppdb::pool::create(Connection)),
-      #endif  /* GDATABASE_USE_CONNECTION_POOLING */
-      Sql(
-          #if GDATABASE_USE_CONNECTION_POOLING
-          Pool->open(),
-          #else
-          Connection,
-          #endif  /* GDATABASE_USE_CONNECTION_POOLING */
-          Config(bWALMode))
+bool GDatabaseImpl::Update(
+        const FString& Id,
+        const FString& Where,
+        const FString& Value,
+        const FString& Set,
+        const std::initializer_list<FString>& Args)
 {
     try
     {
-        if (Sql.is_open())
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
+
+        cppdb::session& Session = Sql();
+
+        Impl::PreparedStatement& Entry = Pimpl->GetPreparedStatement(
+                    Session,
+                    Impl::StatementKey(Impl::EStatementOperation::Update, 0,
+                                       { &Id, &Set, &Where }),
+                    [&]()
         {
-            Sql.close();
+            return fmt::format(
+                        "UPDATE [{0}] SET {1} WHERE {2} = ?;",
+                        StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
+                        StringCast<ANSICHAR>(*Set).Get(),
+                        StringCast<ANSICHAR>(*Where).Get());
+        });
+
+        cppdb::statement& Statement = Entry.Statement;
+        Impl::StatementTimer Timer(*Pimpl, Session, Entry.Query);
+
+        for(const FString& Arg : Args)
+        {
+            Statement.bind(StringCast<ANSICHAR>(*Arg).Get());
         }
+
+        Statement.bind(StringCast<ANSICHAR>(*Value).Get());
+
+        Statement.exec();
+        Timer.Stop(static_cast<uint64>(Statement.affected()));
+
+        return true;
+    }
+
+    catch (const fmt::v5::format_error& Exception)
+    {
+        RethrowIfPropagating(Exception.what());
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
     }
 
     catch (const std::exception& Exception)
     {
+        RethrowIfPropagating(Exception.what());
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
 #endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
@@ -778,6 +1650,8 @@ GDatabaseImpl::Impl::Impl(
 
     catch (...)
     {
+        RethrowIfPropagating(GDATABASE_UNKNOWN_ERROR);
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
                     MB_OK);
@@ -785,20 +1659,49 @@ GDatabaseImpl::Impl::Impl(
         checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
     }
+
+    return false;
 }
 
-GDatabaseImpl::Impl::~Impl()
+bool GDatabaseImpl::Delete(
+        const FString& Id,
+        const FString& Where,
+        const FString& Value)
 {
     try
     {
-        if (Sql.is_open())
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
+
+        cppdb::session& Session = Sql();
+
+        Impl::PreparedStatement& Entry = Pimpl->GetPreparedStatement(
+                    Session,
+                    Impl::StatementKey(Impl::EStatementOperation::Delete, 0,
+                                       { &Id, &Where }),
+                    [&]()
         {
-            Sql.close();
-        }
+            return fmt::format(
+                        "DELETE FROM [{0}] WHERE {1} = ?;",
+                        StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
+                        StringCast<ANSICHAR>(*Where).Get());
+        });
+
+        cppdb::statement& Statement = Entry.Statement;
+        Impl::StatementTimer Timer(*Pimpl, Session, Entry.Query);
+
+        Statement.bind(StringCast<ANSICHAR>(*Value).Get());
+
+        Statement.exec();
+        Timer.Stop(static_cast<uint64>(Statement.affected()));
+
+        return true;
     }
 
-    catch (const std::exception& Exception)
+    catch (const fmt::v5::format_error& Exception)
     {
+        RethrowIfPropagating(Exception.what());
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
 #endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
@@ -806,8 +1709,21 @@ GDatabaseImpl::Impl::~Impl()
                StringCast<WIDECHAR>(Exception.what()).Get());
     }
 
+    catch (const std::exception& Exception)
+    {
+        RethrowIfPropagating(Exception.what());
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false,TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
     catch (...)
     {
+        RethrowIfPropagating(GDATABASE_UNKNOWN_ERROR);
+
 #if defined ( _WIN32 ) || defined ( _WIN64 )
         MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
                     MB_OK);
@@ -815,4 +1731,1364 @@ GDatabaseImpl::Impl::~Impl()
         checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
     }
+
+    return false;
+}
+
+bool GDatabaseImpl::BulkInsert(
+        const FString& Id,
+        const FString& Fields,
+        const std::size_t FieldsCount,
+        const std::size_t RowsCount,
+        const RowBinder& Binder,
+        const EConflictResolution Resolution,
+        const FString& ConflictTarget)
+{
+    /// NOTE
+    /// Held outside of the try block so that the rollback in the handlers
+    /// below still runs under the write lock
+    GDatabaseImpl::WriteGuard WriteGuard(*this);
+    (void)WriteGuard;
+
+    bool bSavepointActive = false;
+
+    /// NOTE
+    /// Runs before an error gets reported, since the check below may abort
+    /// the process and leave the savepoint open otherwise
+    const auto RollbackSavepoint = [this, &bSavepointActive]()
+    {
+        if (!bSavepointActive)
+        {
+            return;
+        }
+
+        bSavepointActive = false;
+
+        try
+        {
+            Sql() << "ROLLBACK TO [GDatabase_BulkInsert];" << cppdb::exec;
+            Sql() << "RELEASE [GDatabase_BulkInsert];" << cppdb::exec;
+        }
+
+        catch (...)
+        {
+
+        }
+    };
+
+    try
+    {
+        if (RowsCount == 0)
+        {
+            return true;
+        }
+
+        cppdb::session& Session = Sql();
+
+        Impl::PreparedStatement& Entry = Pimpl->GetPreparedStatement(
+                    Session,
+                    Impl::StatementKey(Impl::EStatementOperation::BulkInsert,
+                                       static_cast<int32>(Resolution),
+                                       { &Id, &Fields, &ConflictTarget }),
+                    [&]()
+        {
+            std::string PreparedArgs;
+            for (std::size_t i = 0; i < FieldsCount; ++i)
+            {
+                if (i != 0) {
+                    PreparedArgs += ", ";
+                }
+
+                PreparedArgs += "?";
+            }
+
+            const char* Verb = "INSERT";
+            std::string Clause;
+
+            switch (Resolution)
+            {
+            case EConflictResolution::Abort:
+                break;
+            case EConflictResolution::Ignore:
+                Verb = "INSERT OR IGNORE";
+                break;
+            case EConflictResolution::Replace:
+                Verb = "INSERT OR REPLACE";
+                break;
+            case EConflictResolution::Upsert:
+            {
+                TArray<FString> FieldNames;
+                Fields.ParseIntoArray(FieldNames, TEXT(","), true);
+
+                TArray<FString> TargetNames;
+                ConflictTarget.ParseIntoArray(TargetNames, TEXT(","), true);
+                for (FString& TargetName : TargetNames)
+                {
+                    TargetName.TrimStartAndEndInline();
+                }
+
+                std::string Assignments;
+                for (FString& FieldName : FieldNames)
+                {
+                    FieldName.TrimStartAndEndInline();
+
+                    if (TargetNames.Contains(FieldName))
+                    {
+                        continue;
+                    }
+
+                    if (!Assignments.empty())
+                    {
+                        Assignments += ", ";
+                    }
+
+                    Assignments += fmt::format(
+                                "{0} = excluded.{0}",
+                                StringCast<ANSICHAR>(*FieldName).Get());
+                }
+
+                Clause = Assignments.empty()
+                        ? fmt::format(
+                              " ON CONFLICT ( {0} ) DO NOTHING",
+                              StringCast<ANSICHAR>(*ConflictTarget).Get())
+                        : fmt::format(
+                              " ON CONFLICT ( {0} ) DO UPDATE SET {1}",
+                              StringCast<ANSICHAR>(*ConflictTarget).Get(),
+                              Assignments);
+            } break;
+            }
+
+            return fmt::format(
+                        "{0} INTO [{1}] ( {2} ) VALUES ( {3} ){4};",
+                        Verb,
+                        StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
+                        StringCast<ANSICHAR>(*Fields).Get(),
+                        PreparedArgs, Clause);
+        });
+
+        cppdb::statement& Statement = Entry.Statement;
+
+        /// NOTE
+        /// The whole batch, commit included, counts as a single execution
+        Impl::StatementTimer Timer(*Pimpl, Session, Entry.Query);
+        uint64 RowsAffected = 0;
+
+        /// NOTE
+        /// A savepoint starts a transaction on its own when there is none,
+        /// and nests properly when the caller already opened one
+        Session << "SAVEPOINT [GDatabase_BulkInsert];" << cppdb::exec;
+        bSavepointActive = true;
+
+        for (std::size_t Row = 0; Row < RowsCount; ++Row)
+        {
+            Statement.reset();
+            Binder(Row, Statement);
+            Statement.exec();
+            RowsAffected += static_cast<uint64>(Statement.affected());
+        }
+
+        Session << "RELEASE [GDatabase_BulkInsert];" << cppdb::exec;
+        bSavepointActive = false;
+
+        Timer.Stop(RowsAffected);
+
+        return true;
+    }
+
+    catch (const fmt::v5::format_error& Exception)
+    {
+        RollbackSavepoint();
+        RethrowIfPropagating(Exception.what());
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (const std::exception& Exception)
+    {
+        RollbackSavepoint();
+        RethrowIfPropagating(Exception.what());
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+        RollbackSavepoint();
+        RethrowIfPropagating(GDATABASE_UNKNOWN_ERROR);
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    return false;
+}
+
+bool GDatabaseImpl::ExecuteSlot(
+        const std::size_t Slot,
+        const std::string& Query,
+        const std::function<void(cppdb::statement& Statement)>& Binder)
+{
+    try
+    {
+        GDatabaseImpl::WriteGuard WriteGuard(*this);
+        (void)WriteGuard;
+
+        cppdb::session& Session = Sql();
+
+        Impl::PreparedStatement& Entry =
+                Pimpl->GetSlotStatement(Session, Slot, Query);
+
+        cppdb::statement& Statement = Entry.Statement;
+        Impl::StatementTimer Timer(*Pimpl, Session, Entry.Query);
+
+        Binder(Statement);
+
+        Statement.exec();
+        Timer.Stop(static_cast<uint64>(Statement.affected()));
+
+        return true;
+    }
+
+    catch (const std::exception& Exception)
+    {
+        RethrowIfPropagating(Exception.what());
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+        RethrowIfPropagating(GDATABASE_UNKNOWN_ERROR);
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    return false;
+}
+
+bool GDatabaseImpl::ExecuteSlotBatch(
+        const std::size_t Slot,
+        const std::string& Query,
+        const std::size_t RowsCount,
+        const RowBinder& Binder)
+{
+    /// NOTE
+    /// Same transaction handling as BulkInsert()
+    GDatabaseImpl::WriteGuard WriteGuard(*this);
+    (void)WriteGuard;
+
+    bool bSavepointActive = false;
+
+    const auto RollbackSavepoint = [this, &bSavepointActive]()
+    {
+        if (!bSavepointActive)
+        {
+            return;
+        }
+
+        bSavepointActive = false;
+
+        try
+        {
+            Sql() << "ROLLBACK TO [GDatabase_BulkInsert];" << cppdb::exec;
+            Sql() << "RELEASE [GDatabase_BulkInsert];" << cppdb::exec;
+        }
+
+        catch (...)
+        {
+
+        }
+    };
+
+    try
+    {
+        if (RowsCount == 0)
+        {
+            return true;
+        }
+
+        cppdb::session& Session = Sql();
+
+        Impl::PreparedStatement& Entry =
+                Pimpl->GetSlotStatement(Session, Slot, Query);
+
+        cppdb::statement& Statement = Entry.Statement;
+        Impl::StatementTimer Timer(*Pimpl, Session, Entry.Query);
+        uint64 RowsAffected = 0;
+
+        Session << "SAVEPOINT [GDatabase_BulkInsert];" << cppdb::exec;
+        bSavepointActive = true;
+
+        for (std::size_t Row = 0; Row < RowsCount; ++Row)
+        {
+            Statement.reset();
+            Binder(Row, Statement);
+            Statement.exec();
+            RowsAffected += static_cast<uint64>(Statement.affected());
+        }
+
+        Session << "RELEASE [GDatabase_BulkInsert];" << cppdb::exec;
+        bSavepointActive = false;
+
+        Timer.Stop(RowsAffected);
+
+        return true;
+    }
+
+    catch (const std::exception& Exception)
+    {
+        RollbackSavepoint();
+        RethrowIfPropagating(Exception.what());
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+        RollbackSavepoint();
+        RethrowIfPropagating(GDATABASE_UNKNOWN_ERROR);
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    return false;
+}
+
+GDatabaseImpl::Cursor GDatabaseImpl::SelectSlot(
+        const std::size_t Slot,
+        const std::string& Query,
+        const std::function<void(cppdb::statement& Statement)>& Binder)
+{
+    try
+    {
+        std::shared_ptr<void> Lease;
+
+        cppdb::statement Statement = Pimpl->GetLeasedSlotStatement(
+                    Sql(), Slot, Query, Lease);
+
+        Binder(Statement);
+
+        return Cursor(Statement.query(), std::move(Lease));
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    return Cursor();
+}
+
+GDatabaseImpl::Cursor GDatabaseImpl::SelectWithBinder(
+        const FString& Id,
+        const FString& Fields,
+        const FString& Where,
+        const std::function<void(cppdb::statement& Statement)>& Binder)
+{
+    try
+    {
+        std::shared_ptr<void> Lease;
+
+        cppdb::statement Statement = Pimpl->GetLeasedStatement(
+                    Sql(),
+                    Impl::StatementKey(Impl::EStatementOperation::Select, 0,
+                                       { &Id, &Fields, &Where }),
+                    [&]()
+        {
+            if (Where.IsEmpty())
+            {
+                return fmt::format(
+                            "SELECT {0} FROM [{1}];",
+                            StringCast<ANSICHAR>(*Fields).Get(),
+                            StringCast<ANSICHAR>(*GetTableName(Id)).Get());
+            }
+
+            return fmt::format(
+                        "SELECT {0} FROM [{1}] WHERE {2};",
+                        StringCast<ANSICHAR>(*Fields).Get(),
+                        StringCast<ANSICHAR>(*GetTableName(Id)).Get(),
+                        StringCast<ANSICHAR>(*Where).Get());
+        }, Lease);
+
+        Binder(Statement);
+
+        return Cursor(Statement.query(), std::move(Lease));
+    }
+
+    catch (const fmt::v5::format_error& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    return Cursor();
+}
+
+GDatabaseImpl::Cursor::Cursor()
+    : bOpen(false)
+{
+
+}
+
+GDatabaseImpl::Cursor::Cursor(cppdb::result&& InResult,
+                              std::shared_ptr<void> InLease)
+    : Result(std::move(InResult)),
+      Lease(std::move(InLease)),
+      bOpen(true)
+{
+
+}
+
+GDatabaseImpl::Cursor::~Cursor()
+{
+
+}
+
+bool GDatabaseImpl::Cursor::Next()
+{
+    if (!bOpen)
+    {
+        return false;
+    }
+
+    try
+    {
+        if (Result.next())
+        {
+            return true;
+        }
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    /// NOTE
+    /// Hand the cached statement back as soon as the rows run out
+    Result.clear();
+    Lease.reset();
+    bOpen = false;
+
+    return false;
+}
+
+int32 GDatabaseImpl::Cursor::GetColumnsCount()
+{
+    return bOpen ? static_cast<int32>(Result.cols()) : 0;
+}
+
+bool GDatabaseImpl::Cursor::IsNull(const int32 Column)
+{
+    return !bOpen || Result.is_null(Column);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, bool& Out_Value)
+{
+    int Value = 0;
+    if (FetchValue<int, int>(Column, Value))
+    {
+        Out_Value = (Value != 0);
+        return true;
+    }
+
+    return false;
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, int8& Out_Value)
+{
+    return FetchValue<int8, int>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, int16& Out_Value)
+{
+    return FetchValue<int16, int>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, int32& Out_Value)
+{
+    return FetchValue<int32, int>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, int64& Out_Value)
+{
+    return FetchValue<int64, long long>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, uint8& Out_Value)
+{
+    return FetchValue<uint8, unsigned>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, uint16& Out_Value)
+{
+    return FetchValue<uint16, unsigned>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, uint32& Out_Value)
+{
+    return FetchValue<uint32, unsigned>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, uint64& Out_Value)
+{
+    return FetchValue<uint64, unsigned long long>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, float& Out_Value)
+{
+    return FetchValue<float, double>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, double& Out_Value)
+{
+    return FetchValue<double, double>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, std::string& Out_Value)
+{
+    return FetchValue<std::string, std::string>(Column, Out_Value);
+}
+
+bool GDatabaseImpl::Cursor::Fetch(const int32 Column, FString& Out_Value)
+{
+    /// NOTE
+    /// The narrow buffer is reused across cells and rows, so the only
+    /// allocation left is the FString itself
+    if (FetchValue<std::string, std::string>(Column, Buffer))
+    {
+        const auto Converted(StringCast<WIDECHAR>(
+                                 Buffer.c_str(),
+                                 static_cast<int32>(Buffer.size())));
+        Out_Value = FString(Converted.Length(), Converted.Get());
+        return true;
+    }
+
+    return false;
+}
+
+template <typename TYPE, typename FETCH_TYPE>
+bool GDatabaseImpl::Cursor::FetchValue(const int32 Column, TYPE& Out_Value)
+{
+    try
+    {
+        if (!bOpen)
+        {
+            return false;
+        }
+
+        FETCH_TYPE Value;
+        if (Result.fetch(Column, Value))
+        {
+            Out_Value = static_cast<TYPE>(std::move(Value));
+            return true;
+        }
+
+        return false;
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+
+    return false;
+}
+
+GDatabaseImpl::Impl::Impl(
+        const FString& InDatabasePath,
+        bool bInWALMode,
+        uint32 InConnectionPoolSize,
+        const Profile& InProfile)
+    : InstanceId(NextInstanceId++),
+      DatabasePath(InDatabasePath),
+      bWALMode(bInWALMode),
+      ConnectionPoolSize(InConnectionPoolSize > 0 ? InConnectionPoolSize : 1),
+      Connection(fmt::format(
+                     "sqlite3:db={0};busy_timeout={1};@pool_size={2};",
+                     StringCast<ANSICHAR>(*DatabasePath).Get(),
+                     GDATABASE_BUSY_TIMEOUT_MILLISECONDS,
+                     ConnectionPoolSize)),
+      #if GDATABASE_USE_CONNECTION_POOLING
+      Pool(cppdb::pool::create(Connection)),
+      #endif  /* GDATABASE_USE_CONNECTION_POOLING */
+      ThreadSessionRegistry(
+          std::make_shared<GDatabaseThreadSessionRegistry>()),
+      SchemaGeneration(0),
+      ActiveProfile(InProfile),
+      ProfileGeneration(0),
+      SessionsOpened(0),
+      SessionsClosed(0),
+      WriteLockContentions(0),
+      bProfileStatements(false),
+      SlowQueryThreshold(GDATABASE_PROFILER_DEFAULT_SLOW_QUERY_MICROSECONDS)
+{
+    ThreadSessionRegistry->Release = [this](void* Session) {
+        CloseThreadSession(static_cast<ThreadSession*>(Session));
+    };
+
+    try
+    {
+        /// NOTE
+        /// Open one connection up front so that the journal mode is in
+        /// place before any worker thread asks for a session
+#if GDATABASE_USE_CONNECTION_POOLING
+        cppdb::session Sql(Pool->open(), Config(bWALMode, ActiveProfile));
+#else
+        cppdb::session Sql(Connection, Config(bWALMode, ActiveProfile));
+#endif  /* GDATABASE_USE_CONNECTION_POOLING */
+
+        if (Sql.is_open())
+        {
+            Sql.close();
+        }
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+}
+
+GDatabaseImpl::Impl::~Impl()
+{
+    {
+        /// NOTE
+        /// Waits for any exiting thread that is releasing its session
+        std::lock_guard<std::mutex> LockGuard(ThreadSessionRegistry->Lock);
+        (void)LockGuard;
+
+        ThreadSessionRegistry->Release = nullptr;
+    }
+
+    try
+    {
+        std::lock_guard<std::mutex> LockGuard(ThreadSessionsLock);
+        (void)LockGuard;
+
+        for (auto& Session : ThreadSessions)
+        {
+            /// NOTE
+            /// A cppdb statement keeps its backend connection alive, so the
+            /// cache must be emptied before the session gets closed
+            Session.second->PreparedStatements.clear();
+            Session.second->SlotStatements.clear();
+
+            if (Session.second->Sql.is_open())
+            {
+                Session.second->Sql.close();
+            }
+        }
+
+        ThreadSessions.clear();
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_UNKNOWN_ERROR, GDATABASE_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_UNKNOWN_ERROR).Get());
+    }
+}
+
+GDatabaseImpl::Impl::ThreadSession& GDatabaseImpl::Impl::FindThreadSession()
+{
+    if (CachedInstanceId != InstanceId || CachedSession == nullptr)
+    {
+        std::vector<GDatabaseThreadSessionHolder::Entry>& Entries =
+                ThreadSessionHolder.Entries;
+
+        /// NOTE
+        /// Forget the sessions of databases that are already gone
+        Entries.erase(std::remove_if(Entries.begin(), Entries.end(),
+                                     [](const auto& Entry) {
+                          return Entry.Registry.expired();
+                      }), Entries.end());
+
+        void* Found = nullptr;
+
+        for (const auto& Entry : Entries)
+        {
+            if (Entry.InstanceId == InstanceId)
+            {
+                Found = Entry.Session;
+                break;
+            }
+        }
+
+        if (Found == nullptr)
+        {
+            std::unique_ptr<ThreadSession> Session =
+                    std::make_unique<ThreadSession>();
+            Session->SchemaGeneration = SchemaGeneration.load();
+            Found = static_cast<void*>(Session.get());
+
+            {
+                std::lock_guard<std::mutex> LockGuard(ThreadSessionsLock);
+                (void)LockGuard;
+
+                ThreadSessions.emplace(Session.get(), std::move(Session));
+            }
+
+            Entries.push_back({ InstanceId, Found, ThreadSessionRegistry });
+        }
+
+        CachedInstanceId = InstanceId;
+        CachedSession = Found;
+    }
+
+    return *static_cast<ThreadSession*>(CachedSession);
+}
+
+GDatabaseImpl::Impl::ThreadSession& GDatabaseImpl::Impl::GetThreadSession()
+{
+    ThreadSession& Session = FindThreadSession();
+    uint64 Generation = SchemaGeneration.load();
+
+    if (Session.SchemaGeneration != Generation)
+    {
+        Session.PreparedStatements.clear();
+        Session.SlotStatements.clear();
+        Session.SchemaGeneration = Generation;
+    }
+
+    return Session;
+}
+
+void GDatabaseImpl::Impl::ReleaseThreadSession()
+{
+    std::vector<GDatabaseThreadSessionHolder::Entry>& Entries =
+            ThreadSessionHolder.Entries;
+    void* Released = nullptr;
+
+    for (auto Iterator = Entries.begin(); Iterator != Entries.end();
+         ++Iterator)
+    {
+        if (Iterator->InstanceId == InstanceId)
+        {
+            Released = Iterator->Session;
+            Entries.erase(Iterator);
+            break;
+        }
+    }
+
+    if (CachedInstanceId == InstanceId)
+    {
+        CachedInstanceId = 0;
+        CachedSession = nullptr;
+    }
+
+    if (Released != nullptr)
+    {
+        CloseThreadSession(static_cast<ThreadSession*>(Released));
+    }
+}
+
+void GDatabaseImpl::Impl::CloseThreadSession(ThreadSession* Released)
+{
+    std::unique_ptr<ThreadSession> Session;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(ThreadSessionsLock);
+        (void)LockGuard;
+
+        auto Iterator = ThreadSessions.find(Released);
+        if (Iterator == ThreadSessions.end())
+        {
+            return;
+        }
+
+        Session = std::move(Iterator->second);
+        ThreadSessions.erase(Iterator);
+    }
+
+    Session->PreparedStatements.clear();
+    Session->SlotStatements.clear();
+
+    RetireThreadProfile(*Session);
+
+    if (Session->Sql.is_open())
+    {
+        RefreshProfile(*Session);
+        Session->Sql.close();
+        ++SessionsClosed;
+    }
+}
+
+GDatabaseImpl::Impl::StatementKey::StatementKey(
+        const EStatementOperation InOperation,
+        const int32 InVariant,
+        std::initializer_list<const FString*> InParts)
+    : Operation(InOperation),
+      Variant(InVariant),
+      PartsCount(0),
+      Hash(14695981039346656037ULL)
+{
+    checkf(InParts.size() <= MaxParts, TEXT("Too many statement key parts!"));
+
+    /// NOTE
+    /// FNV-1a over the operation, the variant and every part's characters,
+    /// with a separator in between so that ("ab", "c") != ("a", "bc")
+    auto Mix = [this](const uint64 Value) {
+        Hash ^= Value;
+        Hash *= 1099511628211ULL;
+    };
+
+    Mix(static_cast<uint64>(Operation));
+    Mix(static_cast<uint64>(static_cast<uint32>(Variant)));
+
+    for (const FString* Part : InParts)
+    {
+        Parts[PartsCount++] = Part;
+
+        const TCHAR* Characters = **Part;
+        for (int32 i = 0; i < Part->Len(); ++i)
+        {
+            Mix(static_cast<uint64>(Characters[i]));
+        }
+
+        Mix(0xFFFFFFFFULL);
+    }
+}
+
+bool GDatabaseImpl::Impl::StatementKey::Matches(
+        const PreparedStatement& Entry) const
+{
+    if (Entry.Operation != Operation || Entry.Variant != Variant
+            || Entry.Shape.size() != PartsCount)
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < PartsCount; ++i)
+    {
+        if (!Entry.Shape[i].Equals(*Parts[i], ESearchCase::CaseSensitive))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<FString> GDatabaseImpl::Impl::StatementKey::MakeShape() const
+{
+    std::vector<FString> Shape;
+    Shape.reserve(PartsCount);
+
+    for (std::size_t i = 0; i < PartsCount; ++i)
+    {
+        Shape.push_back(*Parts[i]);
+    }
+
+    return Shape;
+}
+
+GDatabaseImpl::Impl::PreparedStatementsHashTable::iterator
+GDatabaseImpl::Impl::FindPreparedStatement(
+        PreparedStatementsHashTable& PreparedStatements,
+        const StatementKey& Key)
+{
+    auto Range = PreparedStatements.equal_range(Key.Hash);
+
+    for (auto Iterator = Range.first; Iterator != Range.second; ++Iterator)
+    {
+        if (Key.Matches(Iterator->second))
+        {
+            return Iterator;
+        }
+    }
+
+    return PreparedStatements.end();
+}
+
+template <typename QUERY_BUILDER>
+GDatabaseImpl::Impl::PreparedStatement& GDatabaseImpl::Impl::GetPreparedStatement(
+        cppdb::session& Session,
+        const StatementKey& Key,
+        QUERY_BUILDER&& BuildQuery)
+{
+    PreparedStatementsHashTable& PreparedStatements =
+            GetThreadSession().PreparedStatements;
+
+    auto Iterator = FindPreparedStatement(PreparedStatements, Key);
+
+    if (Iterator == PreparedStatements.end())
+    {
+        std::string Query(BuildQuery());
+        cppdb::statement Statement(Session.create_prepared_statement(Query));
+
+        PreparedStatement Entry;
+        Entry.Query = std::move(Query);
+        Entry.Statement = std::move(Statement);
+        Entry.Lease = std::make_shared<int32>(0);
+        Entry.Operation = Key.Operation;
+        Entry.Variant = Key.Variant;
+        Entry.Shape = Key.MakeShape();
+
+        Iterator = PreparedStatements.emplace(Key.Hash, std::move(Entry));
+    }
+    else
+    {
+        Iterator->second.Statement.reset();
+    }
+
+    return Iterator->second;
+}
+
+template <typename QUERY_BUILDER>
+cppdb::statement GDatabaseImpl::Impl::GetLeasedStatement(
+        cppdb::session& Session,
+        const StatementKey& Key,
+        QUERY_BUILDER&& BuildQuery,
+        std::shared_ptr<void>& Out_Lease)
+{
+    PreparedStatementsHashTable& PreparedStatements =
+            GetThreadSession().PreparedStatements;
+
+    auto Iterator = FindPreparedStatement(PreparedStatements, Key);
+
+    if (Iterator != PreparedStatements.end()
+            && Iterator->second.Lease.use_count() > 1)
+    {
+        /// NOTE
+        /// Another cursor is still stepping through the cached statement
+        /// (e.g. a nested query of the same shape), fall back to a private
+        /// one instead of resetting it under its feet
+        Out_Lease.reset();
+        return Session.create_prepared_statement(Iterator->second.Query);
+    }
+
+    PreparedStatement& Entry =
+            GetPreparedStatement(Session, Key,
+                                 std::forward<QUERY_BUILDER>(BuildQuery));
+
+    Out_Lease = Entry.Lease;
+    return Entry.Statement;
+}
+
+GDatabaseImpl::Impl::PreparedStatement& GDatabaseImpl::Impl::GetSlotStatement(
+        cppdb::session& Session,
+        const std::size_t Slot,
+        const std::string& Query)
+{
+    std::vector<PreparedStatement>& SlotStatements =
+            GetThreadSession().SlotStatements;
+
+    if (SlotStatements.size() <= Slot)
+    {
+        SlotStatements.resize(Slot + 1);
+    }
+
+    PreparedStatement& Entry = SlotStatements[Slot];
+
+    if (Entry.Statement.empty())
+    {
+        Entry.Query = Query;
+        Entry.Statement = Session.create_prepared_statement(Query);
+        Entry.Lease = std::make_shared<int32>(0);
+    }
+    else
+    {
+        Entry.Statement.reset();
+    }
+
+    return Entry;
+}
+
+cppdb::statement GDatabaseImpl::Impl::GetLeasedSlotStatement(
+        cppdb::session& Session,
+        const std::size_t Slot,
+        const std::string& Query,
+        std::shared_ptr<void>& Out_Lease)
+{
+    std::vector<PreparedStatement>& SlotStatements =
+            GetThreadSession().SlotStatements;
+
+    if (Slot < SlotStatements.size()
+            && SlotStatements[Slot].Lease.use_count() > 1)
+    {
+        /// NOTE
+        /// Same as GetLeasedStatement(), a cursor is still reading from the
+        /// cached statement
+        Out_Lease.reset();
+        return Session.create_prepared_statement(Query);
+    }
+
+    PreparedStatement& Entry = GetSlotStatement(Session, Slot, Query);
+
+    Out_Lease = Entry.Lease;
+    return Entry.Statement;
+}
+
+void GDatabaseImpl::Impl::ResetPreparedStatements()
+{
+    /// NOTE
+    /// A statement left half-stepped keeps its read transaction open, which
+    /// would hold WAL checkpoints back for as long as the thread sits idle
+    ThreadSession& Session = GetThreadSession();
+
+    for (auto& Entry : Session.PreparedStatements)
+    {
+        if (Entry.second.Lease.use_count() <= 1
+                && !Entry.second.Statement.empty())
+        {
+            Entry.second.Statement.reset();
+        }
+    }
+
+    for (PreparedStatement& Entry : Session.SlotStatements)
+    {
+        if (Entry.Lease.use_count() <= 1 && !Entry.Statement.empty())
+        {
+            Entry.Statement.reset();
+        }
+    }
+}
+
+GDatabaseImpl::Profile GDatabaseImpl::Impl::GetProfile() const
+{
+    std::lock_guard<std::mutex> LockGuard(ProfileLock);
+    (void)LockGuard;
+
+    return ActiveProfile;
+}
+
+void GDatabaseImpl::Impl::RefreshProfile(ThreadSession& Session)
+{
+    const uint64 Generation = ProfileGeneration.load();
+
+    if (Session.ProfileGeneration != Generation)
+    {
+        ApplyProfile(Session.Sql, GetProfile());
+        Session.ProfileGeneration = Generation;
+    }
+}
+
+GDatabaseImpl::Impl::StatementTimer::StatementTimer(
+        Impl& InOwner,
+        cppdb::session& InSession,
+        const std::string& InQuery)
+    : Owner(InOwner),
+      Session(InSession),
+      Query(InQuery),
+      bEnabled(InOwner.bProfileStatements.load())
+{
+    if (bEnabled)
+    {
+        Start = std::chrono::steady_clock::now();
+    }
+}
+
+void GDatabaseImpl::Impl::StatementTimer::Stop(const uint64 RowsAffected)
+{
+    if (bEnabled)
+    {
+        Owner.RecordStatement(Session, Query,
+                              std::chrono::steady_clock::now() - Start,
+                              RowsAffected);
+        bEnabled = false;
+    }
+}
+
+/// NOTE
+/// Samples from several threads are pooled up to the usual cap, which keeps
+/// the percentiles an estimate, as the per-thread reservoirs already are
+void GDatabaseImpl::Impl::MergeProfile(const StatementProfile& From,
+                                       StatementProfile& Into)
+{
+    Into.Calls += From.Calls;
+    Into.RowsAffected += From.RowsAffected;
+    Into.TotalMilliseconds += From.TotalMilliseconds;
+    Into.MaxMilliseconds = std::max(Into.MaxMilliseconds,
+                                    From.MaxMilliseconds);
+    Into.SlowCalls += From.SlowCalls;
+    Into.bPlanLogged = Into.bPlanLogged || From.bPlanLogged;
+
+    const std::size_t Room = Into.Samples.size()
+            < GDATABASE_PROFILER_SAMPLES_PER_STATEMENT
+            ? GDATABASE_PROFILER_SAMPLES_PER_STATEMENT - Into.Samples.size()
+            : 0;
+    Into.Samples.insert(Into.Samples.end(), From.Samples.begin(),
+                        From.Samples.begin()
+                        + static_cast<std::ptrdiff_t>(
+                            std::min(Room, From.Samples.size())));
+}
+
+GDatabaseImpl::Impl::ThreadProfile& GDatabaseImpl::Impl::GetThreadProfile()
+{
+    /// NOTE
+    /// Skips the schema check of GetThreadSession(), which could drop the
+    /// statement whose query is being recorded
+    ThreadSession& Session = FindThreadSession();
+
+    if (!Session.Profiler)
+    {
+        Session.Profiler = std::make_shared<ThreadProfile>();
+
+        std::lock_guard<std::mutex> LockGuard(ProfilerLock);
+        (void)LockGuard;
+
+        ThreadProfiles.push_back(Session.Profiler);
+    }
+
+    return *Session.Profiler;
+}
+
+void GDatabaseImpl::Impl::RetireThreadProfile(ThreadSession& Session)
+{
+    if (!Session.Profiler)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> LockGuard(ProfilerLock);
+    (void)LockGuard;
+
+    for (const auto& Statement : Session.Profiler->StatementProfiles)
+    {
+        MergeProfile(Statement.second, RetiredProfiles[Statement.first]);
+    }
+
+    ThreadProfiles.erase(std::remove(ThreadProfiles.begin(),
+                                     ThreadProfiles.end(),
+                                     Session.Profiler),
+                         ThreadProfiles.end());
+    Session.Profiler.reset();
+}
+
+void GDatabaseImpl::Impl::RecordStatement(
+        cppdb::session& Session,
+        const std::string& Query,
+        const std::chrono::steady_clock::duration& Elapsed,
+        const uint64 RowsAffected)
+{
+    const double Milliseconds =
+            std::chrono::duration<double, std::milli>(Elapsed).count();
+    const int64 Threshold = SlowQueryThreshold.load();
+    const bool bSlow = Threshold > 0
+            && std::chrono::duration_cast<std::chrono::microseconds>(
+                Elapsed).count() >= Threshold;
+
+    bool bLogPlan = false;
+    std::string Normalized;
+
+    ThreadProfile& Profiler = GetThreadProfile();
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Profiler.Lock);
+        (void)LockGuard;
+
+        auto NormalizedIterator = Profiler.NormalizedQueries.find(Query);
+        if (NormalizedIterator == Profiler.NormalizedQueries.end())
+        {
+            NormalizedIterator = Profiler.NormalizedQueries.emplace(
+                        Query, NormalizeQuery(Query)).first;
+        }
+
+        Normalized = NormalizedIterator->second;
+
+        StatementProfile& Entry = Profiler.StatementProfiles[Normalized];
+
+        ++Entry.Calls;
+        Entry.RowsAffected += RowsAffected;
+        Entry.TotalMilliseconds += Milliseconds;
+        Entry.MaxMilliseconds = std::max(Entry.MaxMilliseconds,
+                                           Milliseconds);
+
+        /// NOTE
+        /// Reservoir sampling keeps the percentiles representative of the
+        /// whole run with a fixed amount of memory per statement
+        if (Entry.Samples.size() < GDATABASE_PROFILER_SAMPLES_PER_STATEMENT)
+        {
+            Entry.Samples.push_back(static_cast<float>(Milliseconds));
+        }
+        else
+        {
+            std::uniform_int_distribution<uint64> Distribution(
+                        0, Entry.Calls - 1);
+            const uint64 Slot = Distribution(Profiler.SampleGenerator);
+
+            if (Slot < Entry.Samples.size())
+            {
+                Entry.Samples[static_cast<std::size_t>(Slot)] =
+                        static_cast<float>(Milliseconds);
+            }
+        }
+
+        if (bSlow)
+        {
+            ++Entry.SlowCalls;
+            bLogPlan = !Entry.bPlanLogged;
+            Entry.bPlanLogged = true;
+        }
+    }
+
+    if (!bSlow)
+    {
+        return;
+    }
+
+    FString Message(FString::Printf(
+                        TEXT("Slow query (%.3f ms, %llu rows): %s"),
+                        Milliseconds,
+                        static_cast<unsigned long long>(RowsAffected),
+                        StringCast<WIDECHAR>(Normalized.c_str()).Get()));
+
+    /// NOTE
+    /// The plan only gets logged the first time a statement turns out
+    /// slow, it does not change between executions
+    if (bLogPlan)
+    {
+        try
+        {
+            cppdb::result Plan = Session << ("EXPLAIN QUERY PLAN " + Query);
+
+            while (Plan.next())
+            {
+                std::string Detail;
+                Plan.fetch(3, Detail);
+
+                Message += TEXT("\n    ");
+                Message += StringCast<WIDECHAR>(Detail.c_str()).Get();
+            }
+        }
+
+        catch (...)
+        {
+            /// NOTE
+            /// Diagnostics must never fail the statement being profiled
+            Message += TEXT("\n    (query plan unavailable)");
+        }
+    }
+
+    GLOG_SQL_WARNING(GLOG_KEY_SQL, Message);
+}
+
+void GDatabaseImpl::Impl::InvalidatePreparedStatements()
+{
+    /// NOTE
+    /// Other threads drop their stale statements lazily, the next time they
+    /// look up their session
+    ++SchemaGeneration;
 }
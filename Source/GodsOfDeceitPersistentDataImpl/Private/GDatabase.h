@@ -36,8 +36,18 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
 
+#include <Containers/StringConv.h>
 #include <Containers/UnrealString.h>
 #include <CoreTypes.h>
 
@@ -52,9 +62,28 @@ namespace cppdb
     class session;
 }
 
+template <typename TABLE>
+struct GDatabaseTableTraits;
+
 class GODSOFDECEITPERSISTENTDATAIMPL_API GDatabaseImpl
 {
 public:
+    enum class EConflictResolution : uint8
+    {
+        /// Plain INSERT, a constraint violation aborts the whole batch
+        Abort,
+        /// INSERT OR IGNORE, conflicting rows are skipped
+        Ignore,
+        /// INSERT OR REPLACE, conflicting rows are deleted and re-inserted
+        Replace,
+        /// INSERT ... ON CONFLICT ( Target ) DO UPDATE SET, conflicting rows
+        /// get their non-target fields updated in place
+        Upsert
+    };
+
+    typedef std::function<void(const std::size_t Row,
+                               cppdb::statement& Statement)> RowBinder;
+
     class SessionGuard
     {
     private:
@@ -65,6 +94,227 @@ public:
         ~SessionGuard();
     };
 
+    /// NOTE
+    /// Serializes writers across threads. Insert, Update, Delete, BulkInsert
+    /// and the DDL methods take it on their own, hold one explicitly to
+    /// keep a multi-statement transaction on Sql() from interleaving with
+    /// other writers. The lock is recursive.
+    class GODSOFDECEITPERSISTENTDATAIMPL_API WriteGuard
+    {
+    private:
+        GDatabaseImpl& Instance;
+
+    public:
+        WriteGuard(GDatabaseImpl& InInstance);
+        ~WriteGuard();
+    };
+
+    /// NOTE
+    /// While one is alive on a thread, a failing write on that thread gets
+    /// logged to Log_SQL and rethrown to the caller instead of being
+    /// reported as fatal. Meant for callers that recover from it, e.g. by
+    /// rolling back their own transaction.
+    class GODSOFDECEITPERSISTENTDATAIMPL_API ErrorPropagationScope
+    {
+    public:
+        ErrorPropagationScope();
+        ~ErrorPropagationScope();
+    };
+
+    struct ConnectionPoolStats
+    {
+        uint32 PoolSize;
+        uint32 ThreadSessions;
+        uint32 OpenSessions;
+        uint64 SessionsOpened;
+        uint64 SessionsClosed;
+        uint64 WriteLockContentions;
+    };
+
+    /// NOTE
+    /// Per-statement numbers gathered by the statement profiler. Latency
+    /// percentiles come from a bounded sample of the executions.
+    struct StatementStats
+    {
+        FString Sql;
+        uint64 Calls;
+        uint64 RowsAffected;
+        double TotalMilliseconds;
+        double P50Milliseconds;
+        double P99Milliseconds;
+        double MaxMilliseconds;
+        uint64 SlowCalls;
+    };
+
+    /// NOTE
+    /// Connection-level tuning, applied to every SQLite connection when it
+    /// opens. Sizes follow SQLite's own conventions: a negative CacheSize is
+    /// in KiB, a positive one in pages.
+    struct GODSOFDECEITPERSISTENTDATAIMPL_API Profile
+    {
+        enum class ESynchronous : uint8
+        {
+            Off,
+            /// NOTE
+            /// Safe against corruption in WAL mode, only the last commits
+            /// may be lost on a power cut
+            Normal,
+            Full,
+            Extra
+        };
+
+        enum class ETempStore : uint8
+        {
+            Default,
+            File,
+            Memory
+        };
+
+        enum class ELockingMode : uint8
+        {
+            Normal,
+            /// NOTE
+            /// Only meant for a single connection, e.g. ConnectionPoolSize
+            /// of 1 and no worker threads; other pooled connections would
+            /// be locked out
+            Exclusive
+        };
+
+        FString Name;
+
+        /// NOTE
+        /// Bytes of the database file read through mmap() instead of
+        /// copies through the page cache, 0 disables memory-mapped I/O
+        int64 MmapSize;
+        int64 CacheSize;
+        /// NOTE
+        /// Only takes effect on a new database file, or in rollback journal
+        /// mode after a VACUUM
+        uint32 PageSize;
+        ESynchronous Synchronous;
+        ETempStore TempStore;
+        ELockingMode LockingMode;
+
+        /// NOTE
+        /// SQLite's own defaults
+        static Profile Default();
+        /// NOTE
+        /// Frequent small saves: relaxed syncing, bigger cache
+        static Profile FastAutosave();
+        /// NOTE
+        /// Manual saves and checkpoints that must survive a power cut
+        static Profile DurableCheckpoint();
+        /// NOTE
+        /// Loading and browsing large save tables
+        static Profile ReadMostly();
+
+        /// NOTE
+        /// Looks a preset up by name: "default", "fast-autosave",
+        /// "durable-checkpoint" or "read-mostly"
+        static bool FromName(const FString& Name, Profile& Out_Profile);
+    };
+
+    /// NOTE
+    /// Forward-only cursor over the rows of a Select(). Rows are stepped
+    /// lazily from SQLite, and each column is fetched straight into the
+    /// caller's variable, struct member or column array.
+    class GODSOFDECEITPERSISTENTDATAIMPL_API Cursor
+    {
+    private:
+        cppdb::result Result;
+        std::shared_ptr<void> Lease;
+        std::string Buffer;
+        bool bOpen;
+
+    public:
+        Cursor();
+        Cursor(cppdb::result&& InResult, std::shared_ptr<void> InLease);
+        Cursor(Cursor&& Other) = default;
+        Cursor& operator=(Cursor&& Other) = default;
+        ~Cursor();
+
+    public:
+        bool Next();
+        int32 GetColumnsCount();
+        bool IsNull(const int32 Column);
+
+        /// NOTE
+        /// Each Fetch() returns false and leaves Out_Value untouched when
+        /// the column is NULL
+        bool Fetch(const int32 Column, bool& Out_Value);
+        bool Fetch(const int32 Column, int8& Out_Value);
+        bool Fetch(const int32 Column, int16& Out_Value);
+        bool Fetch(const int32 Column, int32& Out_Value);
+        bool Fetch(const int32 Column, int64& Out_Value);
+        bool Fetch(const int32 Column, uint8& Out_Value);
+        bool Fetch(const int32 Column, uint16& Out_Value);
+        bool Fetch(const int32 Column, uint32& Out_Value);
+        bool Fetch(const int32 Column, uint64& Out_Value);
+        bool Fetch(const int32 Column, float& Out_Value);
+        bool Fetch(const int32 Column, double& Out_Value);
+        bool Fetch(const int32 Column, std::string& Out_Value);
+        bool Fetch(const int32 Column, FString& Out_Value);
+
+        /// NOTE
+        /// Fetches the current row's columns, in order, into Out_Values
+        template <typename... TYPES>
+        void FetchRow(TYPES&... Out_Values)
+        {
+            int32 Column = 0;
+            int Expander[] = { 0, (Fetch(Column++, Out_Values), 0)... };
+            (void)Expander;
+        }
+
+        /// NOTE
+        /// Fetches the current row's columns, in order, into the given
+        /// members of Out_Record, e.g.
+        /// Cursor.FetchInto(Record, &FRecord::Id, &FRecord::Name)
+        template <typename RECORD, typename... MEMBERS>
+        void FetchInto(RECORD& Out_Record, MEMBERS RECORD::*... Members)
+        {
+            FetchRow((Out_Record.*Members)...);
+        }
+
+        /// NOTE
+        /// Drains the remaining rows into one array per column (SoA),
+        /// returning the number of rows appended
+        template <typename... TYPES>
+        std::size_t FetchColumns(std::vector<TYPES>&... Out_Columns)
+        {
+            std::size_t Count = 0;
+
+            while (Next())
+            {
+                int32 Column = 0;
+                int Expander[] = { 0, (Out_Columns.emplace_back(),
+                                       Fetch(Column++, Out_Columns.back()),
+                                       0)... };
+                (void)Expander;
+                ++Count;
+            }
+
+            return Count;
+        }
+
+        template <typename FUNCTOR>
+        std::size_t ForEach(FUNCTOR&& Functor)
+        {
+            std::size_t Count = 0;
+
+            while (Next())
+            {
+                Functor(*this);
+                ++Count;
+            }
+
+            return Count;
+        }
+
+    private:
+        template <typename TYPE, typename FETCH_TYPE>
+        bool FetchValue(const int32 Column, TYPE& Out_Value);
+    };
+
 private:
     struct Impl;
     std::unique_ptr<Impl> Pimpl;
@@ -80,14 +330,29 @@ public:
 
     static void LoadSqlite3Driver();
 
+    /// NOTE
+    /// Full, blocking rebuild of the database file. Prefer
+    /// GDatabaseMaintenanceImpl's incremental vacuum during gameplay.
     static bool Sqlite3Vacuum(const FString& DatabasePath);
 
+    /// NOTE
+    /// Hands out a process-wide index into the per-thread statement cache,
+    /// see GDatabaseTableTraits
+    static std::size_t AllocateStatementSlot();
+
 public:
+    /// NOTE
+    /// Sessions are per calling thread and backed by a pool of at most
+    /// ConnectionPoolSize idle SQLite connections
     explicit GDatabaseImpl(const FString& DatabasePath,
-                           bool bWALMode = false);
+                           bool bWALMode = false,
+                           uint32 ConnectionPoolSize = 8,
+                           const Profile& InProfile = Profile::Default());
     virtual ~GDatabaseImpl();
 
 public:
+    const FString& GetDatabasePath() const;
+
     bool IsSessionOpen();
     bool OpenSession();
     bool CloseSession();
@@ -104,19 +369,313 @@ public:
 
     cppdb::session& Sql();
 
+    Profile GetProfile() const;
+    /// NOTE
+    /// Switches the profile at runtime. The calling thread's session picks
+    /// it up right away, other threads the next time they touch theirs.
+    void SetProfile(const Profile& NewProfile);
+    bool SetProfile(const FString& Name);
+
+    /// NOTE
+    /// Insert, Update, Delete and BulkInsert are timed per statement, keyed
+    /// by their normalized SQL. Executions slower than the threshold get
+    /// logged to Log_SQL along with their query plan; zero disables the
+    /// slow-query log. Off by default; each thread records into its own
+    /// table, merged when the stats are read.
+    void SetStatementProfilingEnabled(bool bEnabled);
+    bool IsStatementProfilingEnabled() const;
+    void SetSlowQueryThreshold(const std::chrono::microseconds& Threshold);
+    std::chrono::microseconds GetSlowQueryThreshold() const;
+    std::vector<StatementStats> GetStatementStats() const;
+    /// NOTE
+    /// Writes a table of the collected stats, slowest total first, to
+    /// Log_SQL and returns it
+    FString DumpStatementStats() const;
+    void ResetStatementStats();
+
+    ConnectionPoolStats GetConnectionPoolStats();
+    /// NOTE
+    /// Returns the calling thread's connection to the pool right away; it
+    /// also happens on its own once the thread exits
+    void ReleaseThreadSession();
+    void CollectIdleConnections();
+
     void CreateTable(const FString& Id);
     void DropTable(const FString& Id);
     void RenameTable(const FString& Id, const FString& NewName);
 
-    void Insert(const FString& Id,
+    /// NOTE
+    /// The writes return false when they failed, see ErrorPropagationScope
+    bool Insert(const FString& Id,
                 const FString& Fields,
                 const std::initializer_list<FString>& Args);
-    void Update(const FString& Id,
+    bool Update(const FString& Id,
                 const FString& Where,
                 const FString& Value,
                 const FString& Set,
                 const std::initializer_list<FString>& Args);
-    void Delete(const FString& Id,
+    bool Delete(const FString& Id,
                 const FString& Where,
                 const FString& Value);
+
+    bool BulkInsert(const FString& Id,
+                    const FString& Fields,
+                    const std::size_t FieldsCount,
+                    const std::size_t RowsCount,
+                    const RowBinder& Binder,
+                    const EConflictResolution Resolution
+                    = EConflictResolution::Abort,
+                    const FString& ConflictTarget = FString());
+
+    /// NOTE
+    /// Rows is any range of std::tuple (or std::pair) whose elements are
+    /// bound in the same order as Fields, e.g. std::vector<std::tuple<int64,
+    /// FString, double>>. All rows get written through a single prepared
+    /// statement inside a single transaction.
+    template <typename RANGE>
+    bool BulkInsert(const FString& Id,
+                    const FString& Fields,
+                    const RANGE& Rows,
+                    const EConflictResolution Resolution
+                    = EConflictResolution::Abort,
+                    const FString& ConflictTarget = FString())
+    {
+        typedef typename std::decay<
+                decltype(*std::begin(Rows))>::type RowType;
+
+        auto Iterator = std::begin(Rows);
+
+        return BulkInsert(Id, Fields, std::tuple_size<RowType>::value,
+                          static_cast<std::size_t>(
+                              std::distance(std::begin(Rows),
+                                            std::end(Rows))),
+                          [&Iterator](const std::size_t Row,
+                          cppdb::statement& Statement)
+        {
+            (void)Row;
+            BindRow(Statement, *Iterator,
+                    std::make_index_sequence<
+                    std::tuple_size<RowType>::value>());
+            ++Iterator;
+        }, Resolution, ConflictTarget);
+    }
+
+    /// NOTE
+    /// Slot-keyed counterparts of Insert, BulkInsert and Select; Query is
+    /// only prepared the first time a thread uses the slot. The writes
+    /// return false when they failed.
+    bool ExecuteSlot(const std::size_t Slot,
+                     const std::string& Query,
+                     const std::function<void(
+                         cppdb::statement& Statement)>& Binder);
+    bool ExecuteSlotBatch(const std::size_t Slot,
+                          const std::string& Query,
+                          const std::size_t RowsCount,
+                          const RowBinder& Binder);
+    Cursor SelectSlot(const std::size_t Slot,
+                      const std::string& Query,
+                      const std::function<void(
+                          cppdb::statement& Statement)>& Binder);
+
+    /// NOTE
+    /// Typed table API, TABLE being a descriptor as documented in
+    /// GDatabaseTable.h
+    template <typename TABLE>
+    bool CreateTable()
+    {
+        typedef GDatabaseTableTraits<TABLE> Traits;
+
+        return ExecuteSlot(Traits::GetStatementSlot(Traits::CreateStatement),
+                           Traits::CreateSql(),
+                           [](cppdb::statement& Statement)
+        {
+            (void)Statement;
+        });
+    }
+
+    template <typename TABLE>
+    bool InsertRecord(const typename TABLE::RecordType& Record,
+                      const EConflictResolution Resolution
+                      = EConflictResolution::Abort)
+    {
+        typedef GDatabaseTableTraits<TABLE> Traits;
+
+        return ExecuteSlot(Traits::GetStatementSlot(
+                               Traits::InsertStatement
+                               + static_cast<std::size_t>(Resolution)),
+                           Traits::InsertSql(Resolution),
+                           [&Record](cppdb::statement& Statement)
+        {
+            Traits::BindRecord(Statement, Record);
+        });
+    }
+
+    template <typename TABLE, typename RANGE>
+    bool InsertRecords(const RANGE& Records,
+                       const EConflictResolution Resolution
+                       = EConflictResolution::Abort)
+    {
+        typedef GDatabaseTableTraits<TABLE> Traits;
+
+        auto Iterator = std::begin(Records);
+
+        return ExecuteSlotBatch(Traits::GetStatementSlot(
+                                    Traits::InsertStatement
+                                    + static_cast<std::size_t>(Resolution)),
+                                Traits::InsertSql(Resolution),
+                                static_cast<std::size_t>(
+                                    std::distance(std::begin(Records),
+                                                  std::end(Records))),
+                                [&Iterator](const std::size_t Row,
+                                cppdb::statement& Statement)
+        {
+            (void)Row;
+            Traits::BindRecord(Statement, *Iterator);
+            ++Iterator;
+        });
+    }
+
+    template <typename TABLE>
+    bool UpdateRecord(const typename TABLE::RecordType& Record)
+    {
+        typedef GDatabaseTableTraits<TABLE> Traits;
+
+        return ExecuteSlot(Traits::GetStatementSlot(Traits::UpdateStatement),
+                           Traits::UpdateSql(),
+                           [&Record](cppdb::statement& Statement)
+        {
+            Traits::BindUpdate(Statement, Record);
+        });
+    }
+
+    template <typename TABLE>
+    bool DeleteRecord(
+            const typename GDatabaseTableTraits<TABLE>::KeyType& Key)
+    {
+        typedef GDatabaseTableTraits<TABLE> Traits;
+
+        return ExecuteSlot(Traits::GetStatementSlot(Traits::DeleteStatement),
+                           Traits::DeleteSql(),
+                           [&Key](cppdb::statement& Statement)
+        {
+            BindValue(Statement, Key);
+        });
+    }
+
+    template <typename TABLE>
+    bool FindRecord(const typename GDatabaseTableTraits<TABLE>::KeyType& Key,
+                    typename TABLE::RecordType& Out_Record)
+    {
+        typedef GDatabaseTableTraits<TABLE> Traits;
+
+        Cursor Rows(SelectSlot(Traits::GetStatementSlot(
+                                   Traits::SelectStatement),
+                               Traits::SelectSql(),
+                               [&Key](cppdb::statement& Statement)
+        {
+            BindValue(Statement, Key);
+        }));
+
+        if (!Rows.Next())
+        {
+            return false;
+        }
+
+        Traits::FetchRecord(Rows, Out_Record);
+        return true;
+    }
+
+    Cursor SelectWithBinder(const FString& Id,
+                            const FString& Fields,
+                            const FString& Where,
+                            const std::function<void(
+                                cppdb::statement& Statement)>& Binder);
+
+    /// NOTE
+    /// Where is everything that follows the WHERE keyword, e.g.
+    /// TEXT("level = ? ORDER BY id"), or empty to select every row. Args are
+    /// bound to its placeholders with their native types.
+    template <typename... ARGS>
+    Cursor Select(const FString& Id,
+                  const FString& Fields,
+                  const FString& Where,
+                  const ARGS&... Args)
+    {
+        return SelectWithBinder(Id, Fields, Where,
+                                [&](cppdb::statement& Statement)
+        {
+            int Expander[] = { 0, (BindValue(Statement, Args), 0)... };
+            (void)Expander;
+            (void)Statement;
+        });
+    }
+
+    Cursor Select(const FString& Id, const FString& Fields)
+    {
+        return SelectWithBinder(Id, Fields, FString(),
+                                [](cppdb::statement& Statement)
+        {
+            (void)Statement;
+        });
+    }
+
+public:
+    static FORCEINLINE void BindValue(cppdb::statement& Statement,
+                                      const FString& Value)
+    {
+        Statement.bind(StringCast<ANSICHAR>(*Value).Get());
+    }
+
+    static FORCEINLINE void BindValue(cppdb::statement& Statement,
+                                      const std::string& Value)
+    {
+        Statement.bind(Value);
+    }
+
+    static FORCEINLINE void BindValue(cppdb::statement& Statement,
+                                      const char* Value)
+    {
+        Statement.bind(Value);
+    }
+
+    static FORCEINLINE void BindValue(cppdb::statement& Statement,
+                                      const bool Value)
+    {
+        Statement.bind(Value ? 1 : 0);
+    }
+
+    template <typename TYPE>
+    static FORCEINLINE typename std::enable_if<
+    std::is_integral<TYPE>::value && std::is_signed<TYPE>::value>::type
+    BindValue(cppdb::statement& Statement, const TYPE Value)
+    {
+        Statement.bind(static_cast<long long>(Value));
+    }
+
+    template <typename TYPE>
+    static FORCEINLINE typename std::enable_if<
+    std::is_integral<TYPE>::value && std::is_unsigned<TYPE>::value>::type
+    BindValue(cppdb::statement& Statement, const TYPE Value)
+    {
+        Statement.bind(static_cast<unsigned long long>(Value));
+    }
+
+    template <typename TYPE>
+    static FORCEINLINE typename std::enable_if<
+    std::is_floating_point<TYPE>::value>::type
+    BindValue(cppdb::statement& Statement, const TYPE Value)
+    {
+        Statement.bind(static_cast<double>(Value));
+    }
+
+private:
+    template <typename ROW, std::size_t... INDICES>
+    static FORCEINLINE void BindRow(cppdb::statement& Statement,
+                                    const ROW& Row,
+                                    std::index_sequence<INDICES...>)
+    {
+        int Expander[] = { 0, (BindValue(Statement,
+                                         std::get<INDICES>(Row)), 0)... };
+        (void)Expander;
+    }
 };
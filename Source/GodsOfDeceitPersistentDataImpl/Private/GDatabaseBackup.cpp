@@ -0,0 +1,426 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Incremental online backup of a live database through the SQLite backup
+ * API
+ */
+
+
+#include "GDatabaseBackup.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <sqlite3.h>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GPlatformImpl/GFileSystemImpl.h>
+
+#include "GDatabase.h"
+
+#define  GDATABASE_BACKUP_PARTIAL_SUFFIX          ".partial"
+#define  GDATABASE_BACKUP_COMMIT_ERROR            \
+    "Failed to move the finished backup to its destination!"
+
+struct GDatabaseBackupImpl::Impl
+{
+public:
+    FString SourcePath;
+    FString DestinationPath;
+    FString PartialPath;
+    Settings BackupSettings;
+
+    sqlite3* Source;
+    sqlite3* Target;
+    sqlite3_backup* Backup;
+
+    /// NOTE
+    /// Serializes Step() between the owner and the background thread, and
+    /// guards everything below
+    mutable std::mutex Lock;
+    Progress Current;
+    FString Error;
+
+    int32 Restarts;
+    int32 BusyRetries;
+
+    std::atomic<bool> bCancelRequested;
+    std::thread Thread;
+
+public:
+    Impl(GDatabaseImpl& Database, const FString& InDestinationPath,
+         const Settings& InSettings);
+    ~Impl();
+
+public:
+    bool Step();
+    void Run();
+
+    bool Start();
+    void Finish(const EState State, const FString& Message);
+    bool IsFinished() const;
+};
+
+GDatabaseBackupImpl::GDatabaseBackupImpl(GDatabaseImpl& Database,
+                                         const FString& DestinationPath,
+                                         const Settings& InSettings)
+    : Pimpl(std::make_unique<GDatabaseBackupImpl::Impl>(
+                Database, DestinationPath, InSettings))
+{
+
+}
+
+GDatabaseBackupImpl::~GDatabaseBackupImpl()
+{
+
+}
+
+bool GDatabaseBackupImpl::Step()
+{
+    checkf(!Pimpl->Thread.joinable(),
+           TEXT("FATAL: cannot step a database backup running in the "
+                "background!"));
+
+    return Pimpl->Step();
+}
+
+void GDatabaseBackupImpl::RunAsync()
+{
+    checkf(!Pimpl->Thread.joinable(),
+           TEXT("FATAL: database backup is running in the background "
+                "already!"));
+
+    Pimpl->Thread = std::thread(&GDatabaseBackupImpl::Impl::Run,
+                                Pimpl.get());
+}
+
+bool GDatabaseBackupImpl::Wait()
+{
+    if (Pimpl->Thread.joinable())
+    {
+        Pimpl->Thread.join();
+    }
+    else
+    {
+        while (Pimpl->Step())
+        {
+
+        }
+    }
+
+    return GetProgress().State == EState::Succeeded;
+}
+
+void GDatabaseBackupImpl::Cancel()
+{
+    Pimpl->bCancelRequested = true;
+}
+
+GDatabaseBackupImpl::Progress GDatabaseBackupImpl::GetProgress() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return Pimpl->Current;
+}
+
+FString GDatabaseBackupImpl::GetError() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return Pimpl->Error;
+}
+
+GDatabaseBackupImpl::Impl::Impl(GDatabaseImpl& Database,
+                                const FString& InDestinationPath,
+                                const Settings& InSettings)
+    : SourcePath(Database.GetDatabasePath()),
+      DestinationPath(InDestinationPath),
+      PartialPath(InDestinationPath + TEXT(GDATABASE_BACKUP_PARTIAL_SUFFIX)),
+      BackupSettings(InSettings),
+      Source(nullptr),
+      Target(nullptr),
+      Backup(nullptr),
+      Restarts(0),
+      BusyRetries(0),
+      bCancelRequested(false)
+{
+    if (BackupSettings.PagesPerStep <= 0)
+    {
+        BackupSettings.PagesPerStep = 1;
+    }
+
+    if (BackupSettings.MaxRestarts < 0)
+    {
+        BackupSettings.MaxRestarts = 0;
+    }
+
+    if (BackupSettings.MaxBusyRetries < 0)
+    {
+        BackupSettings.MaxBusyRetries = 0;
+    }
+
+    Current.State = EState::Pending;
+    Current.TotalPages = 0;
+    Current.RemainingPages = 0;
+    Current.Fraction = 0.0f;
+}
+
+GDatabaseBackupImpl::Impl::~Impl()
+{
+    bCancelRequested = true;
+
+    if (Thread.joinable())
+    {
+        Thread.join();
+    }
+
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    (void)LockGuard;
+
+    if (!IsFinished())
+    {
+        Finish(EState::Cancelled, FString());
+    }
+}
+
+bool GDatabaseBackupImpl::Impl::Step()
+{
+    Progress Report;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        if (IsFinished())
+        {
+            return false;
+        }
+
+        if (bCancelRequested)
+        {
+            Finish(EState::Cancelled, FString());
+            Report = Current;
+        }
+        else if (Current.State == EState::Pending && !Start())
+        {
+            Report = Current;
+        }
+        else
+        {
+            const bool bFirstStep = Current.TotalPages == 0
+                    && Current.RemainingPages == 0;
+            const int32 PreviousRemainingPages = Current.RemainingPages;
+
+            /// NOTE
+            /// -1 copies every remaining page at once
+            const int ReturnCode = sqlite3_backup_step(
+                        Backup, Restarts < BackupSettings.MaxRestarts
+                        ? BackupSettings.PagesPerStep : -1);
+
+            Current.TotalPages = sqlite3_backup_pagecount(Backup);
+            Current.RemainingPages = sqlite3_backup_remaining(Backup);
+
+            /// NOTE
+            /// SQLite does not report restarts, the remaining page count
+            /// growing again is the only hint of one
+            if (!bFirstStep
+                    && Current.RemainingPages > PreviousRemainingPages)
+            {
+                ++Restarts;
+            }
+            Current.Fraction = Current.TotalPages > 0
+                    ? 1.0f - static_cast<float>(Current.RemainingPages)
+                      / static_cast<float>(Current.TotalPages)
+                    : 0.0f;
+
+            if (ReturnCode == SQLITE_DONE)
+            {
+                Current.Fraction = 1.0f;
+                Finish(EState::Succeeded, FString());
+            }
+            else if (ReturnCode == SQLITE_BUSY || ReturnCode == SQLITE_LOCKED)
+            {
+                /// NOTE
+                /// Busy and locked are transient, the same pages get
+                /// retried on the next step unless that keeps happening
+                if (++BusyRetries > BackupSettings.MaxBusyRetries)
+                {
+                    Finish(EState::Failed,
+                           StringCast<WIDECHAR>(
+                               sqlite3_errstr(ReturnCode)).Get());
+                }
+            }
+            else if (ReturnCode != SQLITE_OK)
+            {
+                Finish(EState::Failed,
+                       StringCast<WIDECHAR>(sqlite3_errstr(ReturnCode)).Get());
+            }
+            else
+            {
+                BusyRetries = 0;
+            }
+
+            Report = Current;
+        }
+    }
+
+    if (BackupSettings.OnProgress)
+    {
+        BackupSettings.OnProgress(Report);
+    }
+
+    return Report.State == EState::Running;
+}
+
+void GDatabaseBackupImpl::Impl::Run()
+{
+    while (Step())
+    {
+        if (BackupSettings.StepInterval.count() > 0)
+        {
+            std::this_thread::sleep_for(BackupSettings.StepInterval);
+        }
+    }
+}
+
+bool GDatabaseBackupImpl::Impl::Start()
+{
+    /// NOTE
+    /// Leftover from a backup that got interrupted by a crash
+    if (GFileSystemImpl::FileExists(PartialPath))
+    {
+        GFileSystemImpl::TryErase(PartialPath, false);
+    }
+
+    /// NOTE
+    /// The backup reads through its own connection so that it never
+    /// competes with the pooled sessions for a statement or transaction
+    int ReturnCode = sqlite3_open_v2(
+                StringCast<ANSICHAR>(*SourcePath).Get(), &Source,
+                SQLITE_OPEN_READONLY, nullptr);
+
+    if (ReturnCode == SQLITE_OK)
+    {
+        /// NOTE
+        /// Step() may run on the game thread, so a busy source must not
+        /// block it; SQLITE_BUSY comes back right away and the same pages
+        /// get retried on the next step
+        sqlite3_busy_timeout(Source, 0);
+
+        ReturnCode = sqlite3_open_v2(
+                    StringCast<ANSICHAR>(*PartialPath).Get(), &Target,
+                    SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    }
+
+    if (ReturnCode == SQLITE_OK)
+    {
+        Backup = sqlite3_backup_init(Target, "main", Source, "main");
+
+        if (Backup == nullptr)
+        {
+            ReturnCode = sqlite3_errcode(Target);
+        }
+    }
+
+    if (ReturnCode != SQLITE_OK)
+    {
+        Finish(EState::Failed,
+               StringCast<WIDECHAR>(sqlite3_errstr(ReturnCode)).Get());
+        return false;
+    }
+
+    Current.State = EState::Running;
+    return true;
+}
+
+void GDatabaseBackupImpl::Impl::Finish(const EState State,
+                                       const FString& Message)
+{
+    EState FinalState = State;
+    FString FinalError(Message);
+
+    if (Backup != nullptr)
+    {
+        const int ReturnCode = sqlite3_backup_finish(Backup);
+        Backup = nullptr;
+
+        if (FinalState == EState::Succeeded && ReturnCode != SQLITE_OK)
+        {
+            FinalState = EState::Failed;
+            FinalError = StringCast<WIDECHAR>(
+                        sqlite3_errstr(ReturnCode)).Get();
+        }
+    }
+
+    /// NOTE
+    /// sqlite3_open_v2() hands out a handle even when it fails, and
+    /// closing a null handle is a no-op
+    sqlite3_close(Target);
+    Target = nullptr;
+    sqlite3_close(Source);
+    Source = nullptr;
+
+    if (FinalState == EState::Succeeded)
+    {
+        /// NOTE
+        /// Syncs the copy before renaming it over the destination, and
+        /// removes it when that fails
+        if (!GFileSystemImpl::CommitTemporary(PartialPath, DestinationPath))
+        {
+            FinalState = EState::Failed;
+            FinalError = TEXT(GDATABASE_BACKUP_COMMIT_ERROR);
+        }
+    }
+    else if (GFileSystemImpl::FileExists(PartialPath))
+    {
+        GFileSystemImpl::TryErase(PartialPath, false);
+    }
+
+    Current.State = FinalState;
+    Error = FinalError;
+}
+
+bool GDatabaseBackupImpl::Impl::IsFinished() const
+{
+    return Current.State == EState::Succeeded
+            || Current.State == EState::Failed
+            || Current.State == EState::Cancelled;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Incremental online backup of a live database through the SQLite backup
+ * API
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+class GDatabaseImpl;
+
+class GODSOFDECEITPERSISTENTDATAIMPL_API GDatabaseBackupImpl
+{
+public:
+    enum class EState : uint8
+    {
+        Pending,
+        Running,
+        Succeeded,
+        Failed,
+        Cancelled
+    };
+
+    struct Progress
+    {
+        EState State;
+        int32 TotalPages;
+        int32 RemainingPages;
+        /// NOTE
+        /// 0.0 to 1.0, only meaningful once the first step has run
+        float Fraction;
+    };
+
+    typedef std::function<void(const Progress& Report)> ProgressCallback;
+
+    struct Settings
+    {
+        /// NOTE
+        /// Pages copied per sqlite3_backup_step() call. The source is only
+        /// read-locked for the duration of a single step, so smaller steps
+        /// mean shorter stalls for the game's own writers.
+        int32 PagesPerStep;
+
+        /// NOTE
+        /// A write to the source from any other connection restarts the
+        /// copy from its first page. After this many restarts the rest gets
+        /// copied in a single step instead, which keeps the source
+        /// read-locked until it is done but is bound to finish.
+        int32 MaxRestarts;
+
+        /// NOTE
+        /// Consecutive steps that may find the source busy or locked before
+        /// the backup gives up
+        int32 MaxBusyRetries;
+
+        /// NOTE
+        /// Pause between two steps when running on the background thread
+        std::chrono::milliseconds StepInterval;
+
+        /// NOTE
+        /// Called after every step, from whichever thread ran it
+        ProgressCallback OnProgress;
+
+        Settings()
+            : PagesPerStep(256),
+              MaxRestarts(8),
+              MaxBusyRetries(1000),
+              StepInterval(1)
+        {
+
+        }
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    /// NOTE
+    /// Copies Database into DestinationPath while sessions stay open. The
+    /// copy is written next to the destination and only moved into place
+    /// once complete, so a half-written backup never replaces a good one.
+    GDatabaseBackupImpl(GDatabaseImpl& Database,
+                        const FString& DestinationPath,
+                        const Settings& InSettings = Settings());
+    virtual ~GDatabaseBackupImpl();
+
+public:
+    /// NOTE
+    /// Frame-spread mode: copies one batch of pages per call and returns
+    /// true while there is more to do
+    bool Step();
+
+    /// NOTE
+    /// Background mode: runs the remaining steps on a worker thread
+    void RunAsync();
+
+    /// NOTE
+    /// Blocks until the backup has finished and returns whether it
+    /// succeeded
+    bool Wait();
+
+    void Cancel();
+
+    Progress GetProgress() const;
+    FString GetError() const;
+};
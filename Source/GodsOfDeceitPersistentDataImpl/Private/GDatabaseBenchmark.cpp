@@ -0,0 +1,652 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Throughput measurements for the SQL connectivity layer
+ */
+
+
+#include "GDatabaseBenchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <tuple>
+
+#include <Containers/StringConv.h>
+#include <HAL/IConsoleManager.h>
+#include <Misc/Paths.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GLog/GLog.h>
+#include <GPlatformImpl/GFileSystemImpl.h>
+
+#include "GDatabase.h"
+
+#define  GDATABASE_BENCHMARK_TABLE_ID       "Benchmark"
+#define  GDATABASE_BENCHMARK_TABLE_NAME     "benchmark"
+#define  GDATABASE_BENCHMARK_TABLE_FIELDS   "id INTEGER PRIMARY KEY, name TEXT, value REAL"
+
+#define  GDATABASE_BENCHMARK_WRITER_BATCH_ROWS      100
+#define  GDATABASE_BENCHMARK_TEMPORARY_FILE_MODEL   "godsofdeceit-benchmark-%%%%-%%%%-%%%%.db"
+#define  GDATABASE_BENCHMARK_REPORT_FILE            "DatabaseBenchmark.json"
+#define  GDATABASE_BENCHMARK_COMMAND                "GodsOfDeceit.Database.Benchmark"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+    typedef std::tuple<int64, FString, double> Row;
+
+    void EraseDatabase(const FString& DatabasePath)
+    {
+        static const TCHAR* const Suffixes[] = {
+            TEXT(""), TEXT("-journal"), TEXT("-wal"), TEXT("-shm")
+        };
+
+        for (const TCHAR* const Suffix : Suffixes)
+        {
+            const FString Path(DatabasePath + Suffix);
+            if (GFileSystemImpl::FileExists(Path))
+            {
+                GFileSystemImpl::Erase(Path, false);
+            }
+        }
+    }
+
+    void AddResult(const FString& Name, const FString& JournalMode,
+                   const uint64 Rows, const double Seconds,
+                   std::vector<GDatabaseBenchmarkImpl::Result>& Out_Results)
+    {
+        Out_Results.push_back(GDatabaseBenchmarkImpl::Result {
+                                  Name, JournalMode, Rows, Seconds,
+                                  Seconds > 0.0
+                                  ? static_cast<double>(Rows) / Seconds
+                                  : 0.0 });
+    }
+
+    void AddResult(const FString& Name, const FString& JournalMode,
+                   const uint64 Rows, const Clock::time_point& Start,
+                   std::vector<GDatabaseBenchmarkImpl::Result>& Out_Results)
+    {
+        AddResult(Name, JournalMode, Rows,
+                  std::chrono::duration<double>(Clock::now() - Start).count(),
+                  Out_Results);
+    }
+
+    void MakeRows(const uint64 RowsCount, std::vector<Row>& Out_Rows)
+    {
+        Out_Rows.clear();
+        Out_Rows.reserve(static_cast<std::size_t>(RowsCount));
+        for (uint64 i = 0; i < RowsCount; ++i)
+        {
+            Out_Rows.emplace_back(static_cast<int64>(i),
+                                  FString::Printf(TEXT("Row %llu"), i),
+                                  static_cast<double>(i) * 0.5);
+        }
+    }
+
+    void RegisterTable(GDatabaseImpl& Database)
+    {
+        Database.RegisterTable(TEXT(GDATABASE_BENCHMARK_TABLE_ID),
+                               TEXT(GDATABASE_BENCHMARK_TABLE_NAME),
+                               TEXT(GDATABASE_BENCHMARK_TABLE_FIELDS));
+    }
+
+    void ClearTable(GDatabaseImpl& Database)
+    {
+        GDatabaseImpl::WriteGuard WriteGuard(Database);
+        (void)WriteGuard;
+
+        Database.Sql() << "DELETE FROM [" GDATABASE_BENCHMARK_TABLE_NAME "];"
+                       << cppdb::exec;
+    }
+
+    void InsertSingle(GDatabaseImpl& Database, const Row& Data)
+    {
+        Database.Insert(TEXT(GDATABASE_BENCHMARK_TABLE_ID),
+                        TEXT("id, name, value"),
+                        { FString::Printf(TEXT("%lld"), std::get<0>(Data)),
+                          std::get<1>(Data),
+                          FString::SanitizeFloat(std::get<2>(Data)) });
+    }
+
+    void UpdateSingle(GDatabaseImpl& Database, const Row& Data)
+    {
+        Database.Update(TEXT(GDATABASE_BENCHMARK_TABLE_ID), TEXT("id"),
+                        FString::Printf(TEXT("%lld"), std::get<0>(Data)),
+                        TEXT("name = ?, value = ?"),
+                        { std::get<1>(Data) + TEXT(" updated"),
+                          FString::SanitizeFloat(std::get<2>(Data) * 2.0) });
+    }
+
+    void DeleteSingle(GDatabaseImpl& Database, const Row& Data)
+    {
+        Database.Delete(TEXT(GDATABASE_BENCHMARK_TABLE_ID), TEXT("id"),
+                        FString::Printf(TEXT("%lld"), std::get<0>(Data)));
+    }
+
+    /// NOTE
+    /// Runs Operation over Rows inside one explicit transaction, which is
+    /// what batching amounts to for statements with no bulk counterpart
+    template <typename OPERATION>
+    void RunBatched(GDatabaseImpl& Database, const std::vector<Row>& Rows,
+                    const std::size_t RowsCount, OPERATION Operation)
+    {
+        GDatabaseImpl::WriteGuard WriteGuard(Database);
+        (void)WriteGuard;
+
+        cppdb::transaction TransactionGuard(Database.Sql());
+        for (std::size_t i = 0; i < RowsCount; ++i)
+        {
+            Operation(Database, Rows[i]);
+        }
+        TransactionGuard.commit();
+    }
+
+    template <typename OPERATION>
+    void RunSingle(GDatabaseImpl& Database, const std::vector<Row>& Rows,
+                   const std::size_t RowsCount, OPERATION Operation)
+    {
+        for (std::size_t i = 0; i < RowsCount; ++i)
+        {
+            Operation(Database, Rows[i]);
+        }
+    }
+
+    uint64 CountRows(GDatabaseImpl& Database)
+    {
+        GDatabaseImpl::Cursor Rows(
+                    Database.Select(TEXT(GDATABASE_BENCHMARK_TABLE_ID),
+                                    TEXT("COUNT(*)"), FString()));
+
+        int64 Count = 0;
+        if (Rows.Next())
+        {
+            Rows.Fetch(0, Count);
+        }
+
+        return static_cast<uint64>(Count);
+    }
+
+    void RunStatementsBenchmark(
+            const FString& DatabasePath,
+            const bool bWALMode,
+            const FString& JournalMode,
+            const GDatabaseBenchmarkImpl::Settings& Settings,
+            std::vector<GDatabaseBenchmarkImpl::Result>& Out_Results)
+    {
+        const FString TableId(TEXT(GDATABASE_BENCHMARK_TABLE_ID));
+
+        GDatabaseImpl Database(DatabasePath, bWALMode);
+        RegisterTable(Database);
+        Database.Initialize();
+
+        GDatabaseImpl::SessionGuard SessionGuard(Database);
+        (void)SessionGuard;
+
+        Database.OpenSession();
+
+        std::vector<Row> Rows;
+        MakeRows(Settings.RowsCount, Rows);
+
+        const std::size_t SingleRowsCount = static_cast<std::size_t>(
+                    std::min(Settings.SingleRowsCount, Settings.RowsCount));
+        const std::size_t BatchedRowsCount = Rows.size();
+
+        Clock::time_point Start = Clock::now();
+        RunSingle(Database, Rows, SingleRowsCount, &InsertSingle);
+        AddResult(TEXT("Insert (one row per transaction)"), JournalMode,
+                  SingleRowsCount, Start, Out_Results);
+
+        ClearTable(Database);
+
+        Start = Clock::now();
+        RunBatched(Database, Rows, BatchedRowsCount, &InsertSingle);
+        AddResult(TEXT("Insert (single transaction)"), JournalMode,
+                  BatchedRowsCount, Start, Out_Results);
+
+        ClearTable(Database);
+
+        Start = Clock::now();
+        Database.BulkInsert(TableId, TEXT("id, name, value"), Rows);
+        AddResult(TEXT("BulkInsert"), JournalMode, BatchedRowsCount, Start,
+                  Out_Results);
+
+        Start = Clock::now();
+        Database.BulkInsert(TableId, TEXT("id, name, value"), Rows,
+                            GDatabaseImpl::EConflictResolution::Upsert,
+                            TEXT("id"));
+        AddResult(TEXT("BulkInsert (ON CONFLICT DO UPDATE)"), JournalMode,
+                  BatchedRowsCount, Start, Out_Results);
+
+        Start = Clock::now();
+        RunSingle(Database, Rows, SingleRowsCount, &UpdateSingle);
+        AddResult(TEXT("Update (one row per transaction)"), JournalMode,
+                  SingleRowsCount, Start, Out_Results);
+
+        Start = Clock::now();
+        RunBatched(Database, Rows, BatchedRowsCount, &UpdateSingle);
+        AddResult(TEXT("Update (single transaction)"), JournalMode,
+                  BatchedRowsCount, Start, Out_Results);
+
+        Start = Clock::now();
+        RunSingle(Database, Rows, SingleRowsCount, &DeleteSingle);
+        AddResult(TEXT("Delete (one row per transaction)"), JournalMode,
+                  SingleRowsCount, Start, Out_Results);
+
+        Database.BulkInsert(TableId, TEXT("id, name, value"), Rows,
+                            GDatabaseImpl::EConflictResolution::Replace);
+
+        Start = Clock::now();
+        RunBatched(Database, Rows, BatchedRowsCount, &DeleteSingle);
+        AddResult(TEXT("Delete (single transaction)"), JournalMode,
+                  BatchedRowsCount, Start, Out_Results);
+    }
+
+    /// NOTE
+    /// Cold opens build a fresh GDatabaseImpl, so SQLite has to open the
+    /// file and parse the schema again; warm opens reuse a pooled
+    /// connection. The OS page cache stays warm either way.
+    void RunOpenBenchmark(
+            const FString& DatabasePath,
+            const bool bWALMode,
+            const FString& JournalMode,
+            const GDatabaseBenchmarkImpl::Settings& Settings,
+            std::vector<GDatabaseBenchmarkImpl::Result>& Out_Results)
+    {
+        uint64 Rows = 0;
+
+        Clock::time_point Start = Clock::now();
+        for (uint32 i = 0; i < Settings.OpenIterations; ++i)
+        {
+            GDatabaseImpl Database(DatabasePath, bWALMode);
+            RegisterTable(Database);
+
+            GDatabaseImpl::SessionGuard SessionGuard(Database);
+            (void)SessionGuard;
+
+            Database.OpenSession();
+            Rows += CountRows(Database);
+        }
+        AddResult(TEXT("Open (cold)"), JournalMode, Settings.OpenIterations,
+                  Start, Out_Results);
+
+        GDatabaseImpl Database(DatabasePath, bWALMode);
+        RegisterTable(Database);
+        Database.OpenSession();
+        Rows += CountRows(Database);
+        Database.CloseSession();
+
+        Start = Clock::now();
+        for (uint32 i = 0; i < Settings.OpenIterations; ++i)
+        {
+            GDatabaseImpl::SessionGuard SessionGuard(Database);
+            (void)SessionGuard;
+
+            Database.OpenSession();
+            Rows += CountRows(Database);
+        }
+        AddResult(TEXT("Open (warm)"), JournalMode, Settings.OpenIterations,
+                  Start, Out_Results);
+
+        (void)Rows;
+    }
+
+    /// NOTE
+    /// Readers do point lookups on their own sessions while the calling
+    /// thread upserts batches, for ConcurrencyDuration
+    void RunConcurrencyBenchmark(
+            const FString& DatabasePath,
+            const bool bWALMode,
+            const FString& JournalMode,
+            const GDatabaseBenchmarkImpl::Settings& Settings,
+            std::vector<GDatabaseBenchmarkImpl::Result>& Out_Results)
+    {
+        const FString TableId(TEXT(GDATABASE_BENCHMARK_TABLE_ID));
+        const int64 RowsCount =
+                static_cast<int64>(std::max<uint64>(Settings.RowsCount, 1));
+
+        GDatabaseImpl Database(DatabasePath, bWALMode,
+                               Settings.ReaderThreads + 1);
+        RegisterTable(Database);
+
+        {
+            GDatabaseImpl::SessionGuard SessionGuard(Database);
+            (void)SessionGuard;
+
+            Database.OpenSession();
+
+            std::vector<Row> Rows;
+            MakeRows(static_cast<uint64>(RowsCount), Rows);
+            Database.BulkInsert(TableId, TEXT("id, name, value"), Rows,
+                                GDatabaseImpl::EConflictResolution::Replace);
+        }
+
+        std::atomic<bool> bRunning(true);
+        std::atomic<uint64> ReadsCount(0);
+        std::vector<std::thread> Readers;
+        Readers.reserve(Settings.ReaderThreads);
+
+        for (uint32 i = 0; i < Settings.ReaderThreads; ++i)
+        {
+            Readers.emplace_back([&, i]()
+            {
+                std::minstd_rand Random(i + 1);
+                std::uniform_int_distribution<int64> Distribution(
+                            0, RowsCount - 1);
+                uint64 Reads = 0;
+
+                {
+                    GDatabaseImpl::SessionGuard SessionGuard(Database);
+                    (void)SessionGuard;
+
+                    Database.OpenSession();
+
+                    while (bRunning.load(std::memory_order_relaxed))
+                    {
+                        GDatabaseImpl::Cursor Rows(
+                                    Database.Select(TableId,
+                                                    TEXT("name, value"),
+                                                    TEXT("id = ?"),
+                                                    Distribution(Random)));
+                        while (Rows.Next())
+                        {
+                            ++Reads;
+                        }
+                    }
+                }
+
+                Database.ReleaseThreadSession();
+                ReadsCount.fetch_add(Reads, std::memory_order_relaxed);
+            });
+        }
+
+        uint64 Writes = 0;
+
+        {
+            GDatabaseImpl::SessionGuard SessionGuard(Database);
+            (void)SessionGuard;
+
+            Database.OpenSession();
+
+            std::vector<Row> Batch;
+            Batch.reserve(GDATABASE_BENCHMARK_WRITER_BATCH_ROWS);
+
+            const Clock::time_point End =
+                    Clock::now() + Settings.ConcurrencyDuration;
+            int64 Id = 0;
+
+            while (Clock::now() < End)
+            {
+                Batch.clear();
+                for (uint32 i = 0; i < GDATABASE_BENCHMARK_WRITER_BATCH_ROWS;
+                     ++i, Id = (Id + 1) % RowsCount)
+                {
+                    Batch.emplace_back(Id,
+                                       FString::Printf(TEXT("Row %lld"), Id),
+                                       static_cast<double>(Writes + i));
+                }
+
+                Database.BulkInsert(TableId, TEXT("id, name, value"), Batch,
+                                    GDatabaseImpl::EConflictResolution::Upsert,
+                                    TEXT("id"));
+                Writes += Batch.size();
+            }
+        }
+
+        bRunning.store(false, std::memory_order_relaxed);
+
+        for (std::thread& Reader : Readers)
+        {
+            Reader.join();
+        }
+
+        const double Seconds = std::chrono::duration<double>(
+                    Settings.ConcurrencyDuration).count();
+
+        AddResult(FString::Printf(TEXT("Concurrent reads (%u readers)"),
+                                  Settings.ReaderThreads),
+                  JournalMode, ReadsCount.load(), Seconds, Out_Results);
+        AddResult(TEXT("Concurrent writes (upsert batches)"), JournalMode,
+                  Writes, Seconds, Out_Results);
+    }
+
+    FString EscapeJson(const FString& Value)
+    {
+        FString Escaped;
+        Escaped.Reserve(Value.Len());
+
+        for (const TCHAR Character : Value)
+        {
+            switch (Character)
+            {
+            case TEXT('"'):
+                Escaped += TEXT("\\\"");
+                break;
+            case TEXT('\\'):
+                Escaped += TEXT("\\\\");
+                break;
+            case TEXT('\n'):
+                Escaped += TEXT("\\n");
+                break;
+            case TEXT('\t'):
+                Escaped += TEXT("\\t");
+                break;
+            default:
+                if (Character < 0x20)
+                {
+                    Escaped += FString::Printf(TEXT("\\u%04x"),
+                                               static_cast<uint32>(Character));
+                }
+                else
+                {
+                    Escaped.AppendChar(Character);
+                }
+                break;
+            }
+        }
+
+        return Escaped;
+    }
+}
+
+void GDatabaseBenchmarkImpl::RunInsertBenchmark(
+        const FString& DatabasePath,
+        const uint64 RowsCount,
+        std::vector<Result>& Out_Results)
+{
+    const FString TableId(TEXT(GDATABASE_BENCHMARK_TABLE_ID));
+    const FString Fields(TEXT("id, name, value"));
+    const FString JournalMode(TEXT("wal"));
+
+    EraseDatabase(DatabasePath);
+
+    {
+        GDatabaseImpl Database(DatabasePath, true);
+        RegisterTable(Database);
+        Database.Initialize();
+
+        GDatabaseImpl::SessionGuard SessionGuard(Database);
+        (void)SessionGuard;
+
+        Database.OpenSession();
+
+        std::vector<Row> Rows;
+        MakeRows(RowsCount, Rows);
+
+        /// NOTE
+        /// Every autocommitted row pays for its own sync, the full row
+        /// count would keep this case going for minutes
+        const uint64 SingleRowsCount =
+                std::min(RowsCount, Settings().SingleRowsCount);
+
+        Clock::time_point Start = Clock::now();
+        RunSingle(Database, Rows, static_cast<std::size_t>(SingleRowsCount),
+                  &InsertSingle);
+        AddResult(TEXT("Insert (one row per transaction)"), JournalMode,
+                  SingleRowsCount, Start, Out_Results);
+
+        ClearTable(Database);
+
+        Start = Clock::now();
+        Database.BulkInsert(TableId, Fields, Rows);
+        AddResult(TEXT("BulkInsert"), JournalMode, RowsCount, Start,
+                  Out_Results);
+
+        Start = Clock::now();
+        Database.BulkInsert(TableId, Fields, Rows,
+                            GDatabaseImpl::EConflictResolution::Replace);
+        AddResult(TEXT("BulkInsert (INSERT OR REPLACE)"), JournalMode,
+                  RowsCount, Start, Out_Results);
+
+        Start = Clock::now();
+        Database.BulkInsert(TableId, Fields, Rows,
+                            GDatabaseImpl::EConflictResolution::Upsert,
+                            TEXT("id"));
+        AddResult(TEXT("BulkInsert (ON CONFLICT DO UPDATE)"), JournalMode,
+                  RowsCount, Start, Out_Results);
+    }
+
+    EraseDatabase(DatabasePath);
+}
+
+void GDatabaseBenchmarkImpl::RunSuite(const FString& DatabasePath,
+                                      const Settings& InSettings,
+                                      std::vector<Result>& Out_Results)
+{
+    const std::tuple<bool, bool, const TCHAR*> Modes[] = {
+        std::make_tuple(InSettings.bWALMode, true, TEXT("wal")),
+        std::make_tuple(InSettings.bRollbackJournalMode, false, TEXT("delete"))
+    };
+
+    for (const auto& Mode : Modes)
+    {
+        if (!std::get<0>(Mode))
+        {
+            continue;
+        }
+
+        const bool bWALMode = std::get<1>(Mode);
+        const FString JournalMode(std::get<2>(Mode));
+
+        EraseDatabase(DatabasePath);
+
+        RunStatementsBenchmark(DatabasePath, bWALMode, JournalMode,
+                               InSettings, Out_Results);
+        RunOpenBenchmark(DatabasePath, bWALMode, JournalMode,
+                         InSettings, Out_Results);
+        RunConcurrencyBenchmark(DatabasePath, bWALMode, JournalMode,
+                                InSettings, Out_Results);
+    }
+
+    EraseDatabase(DatabasePath);
+}
+
+FString GDatabaseBenchmarkImpl::MakeTemporaryDatabasePath()
+{
+    const boost::filesystem::path Path(
+                boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path(
+                    GDATABASE_BENCHMARK_TEMPORARY_FILE_MODEL));
+
+    return StringCast<WIDECHAR>(Path.string().c_str()).Get();
+}
+
+FString GDatabaseBenchmarkImpl::ToJson(const std::vector<Result>& Results)
+{
+    FString Json(TEXT("{\n  \"results\": ["));
+
+    for (std::size_t i = 0; i < Results.size(); ++i)
+    {
+        const Result& Entry = Results[i];
+
+        Json += FString::Printf(
+                    TEXT("%s\n    { \"name\": \"%s\", \"journal_mode\": \"%s\","
+                         " \"rows\": %llu, \"seconds\": %.6f,"
+                         " \"rows_per_second\": %.2f }"),
+                    i > 0 ? TEXT(",") : TEXT(""),
+                    *EscapeJson(Entry.Name),
+                    *EscapeJson(Entry.JournalMode),
+                    Entry.Rows, Entry.Seconds, Entry.RowsPerSecond);
+    }
+
+    Json += TEXT("\n  ]\n}\n");
+
+    return Json;
+}
+
+void GDatabaseBenchmarkImpl::WriteReport(const FString& ReportPath,
+                                         const std::vector<Result>& Results)
+{
+    GFileSystemImpl::Write(ReportPath, ToJson(Results));
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+    /// NOTE
+    /// Runs on the game thread and blocks it until the suite is done; meant
+    /// for a development build sitting in a menu, not for gameplay
+    void RunBenchmarkCommand(const TArray<FString>& Args)
+    {
+        const FString ReportPath(
+                    Args.Num() > 0
+                    ? Args[0]
+                    : FPaths::Combine(FPaths::ProjectSavedDir(),
+                                      TEXT(GDATABASE_BENCHMARK_REPORT_FILE)));
+
+        std::vector<GDatabaseBenchmarkImpl::Result> Results;
+        GDatabaseBenchmarkImpl::RunSuite(
+                    GDatabaseBenchmarkImpl::MakeTemporaryDatabasePath(),
+                    GDatabaseBenchmarkImpl::Settings(), Results);
+        GDatabaseBenchmarkImpl::WriteReport(ReportPath, Results);
+
+        GLOG_SQL_DISPLAY(GLOG_KEY_SQL,
+                         TEXT("Database benchmark report written to "),
+                         ReportPath);
+    }
+
+    FAutoConsoleCommand BenchmarkCommand(
+            TEXT(GDATABASE_BENCHMARK_COMMAND),
+            TEXT("Runs the database benchmark suite on a throw-away database"
+                 " and writes a JSON report, to the given path or to"
+                 " Saved/" GDATABASE_BENCHMARK_REPORT_FILE),
+            FConsoleCommandWithArgsDelegate::CreateStatic(
+                &RunBenchmarkCommand));
+}
+#endif  /* !UE_BUILD_SHIPPING */
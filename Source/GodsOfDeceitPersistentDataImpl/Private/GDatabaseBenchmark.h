@@ -0,0 +1,117 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Throughput measurements for the SQL connectivity layer
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+class GODSOFDECEITPERSISTENTDATAIMPL_API GDatabaseBenchmarkImpl
+{
+public:
+    struct Result
+    {
+        FString Name;
+        /// NOTE
+        /// Journal mode the measurement ran under, "wal" or "delete"
+        FString JournalMode;
+        uint64 Rows;
+        double Seconds;
+        double RowsPerSecond;
+    };
+
+    struct Settings
+    {
+        uint64 RowsCount;
+
+        /// NOTE
+        /// Single-row statements run in autocommit mode and are much
+        /// slower, so they are measured over fewer rows
+        uint64 SingleRowsCount;
+
+        uint32 OpenIterations;
+
+        uint32 ReaderThreads;
+        std::chrono::milliseconds ConcurrencyDuration;
+
+        bool bWALMode;
+        bool bRollbackJournalMode;
+
+        Settings()
+            : RowsCount(100000),
+              SingleRowsCount(2000),
+              OpenIterations(50),
+              ReaderThreads(4),
+              ConcurrencyDuration(2000),
+              bWALMode(true),
+              bRollbackJournalMode(true)
+        {
+
+        }
+    };
+
+public:
+    /// NOTE
+    /// Creates a throw-away database at DatabasePath and compares the
+    /// one-row-at-a-time Insert path, over at most Settings'
+    /// SingleRowsCount rows, against BulkInsert and bulk upserts. Any
+    /// existing file at DatabasePath gets erased.
+    static void RunInsertBenchmark(const FString& DatabasePath,
+                                   const uint64 RowsCount,
+                                   std::vector<Result>& Out_Results);
+
+    /// NOTE
+    /// Also available from the console in non-shipping builds, as
+    /// "GodsOfDeceit.Database.Benchmark [ReportPath]".
+    /// Full suite: single-row versus batched inserts, updates and deletes,
+    /// cold versus warm session opens, and readers on worker threads while
+    /// a writer keeps upserting, for every enabled journal mode. Any
+    /// existing file at DatabasePath gets erased.
+    static void RunSuite(const FString& DatabasePath,
+                         const Settings& InSettings,
+                         std::vector<Result>& Out_Results);
+
+    /// NOTE
+    /// A unique database path inside the system's temporary directory
+    static FString MakeTemporaryDatabasePath();
+
+    static FString ToJson(const std::vector<Result>& Results);
+    static void WriteReport(const FString& ReportPath,
+                            const std::vector<Result>& Results);
+};
@@ -0,0 +1,402 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Incremental vacuum and WAL checkpoint scheduler on top of the SQL
+ * connectivity layer
+ */
+
+
+#include "GDatabaseMaintenance.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <cppdb/frontend.h>
+#include <fmt/format.h>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GHacks/GInclude_Windows.h>
+
+#include "GDatabase.h"
+
+#define  GDATABASE_MAINTENANCE_ERROR_DIALOG_TITLE    "Database Error"
+#define  GDATABASE_MAINTENANCE_UNKNOWN_ERROR         "GDatabaseMaintenance: unknown error!"
+
+struct GDatabaseMaintenanceImpl::Impl
+{
+public:
+    GDatabaseImpl& Database;
+    Settings MaintenanceSettings;
+
+    /// NOTE
+    /// Serializes Tick() between the background thread and the owner
+    std::mutex TickLock;
+    Report LastReport;
+    std::chrono::steady_clock::time_point LastCheckpoint;
+
+    std::mutex Lock;
+    std::condition_variable StopCondition;
+    bool bStopping;
+
+    std::thread Thread;
+
+public:
+    Impl(GDatabaseImpl& InDatabase, const Settings& InSettings);
+    ~Impl();
+
+public:
+    void Run();
+    Report Tick(const std::chrono::microseconds& Budget);
+    void Checkpoint(cppdb::session& Session, Report& Out_Report);
+    void Vacuum(cppdb::session& Session,
+                const std::chrono::steady_clock::time_point& Deadline,
+                Report& Out_Report);
+};
+
+GDatabaseMaintenanceImpl::GDatabaseMaintenanceImpl(GDatabaseImpl& Database,
+                                                   const Settings& InSettings)
+    : Pimpl(std::make_unique<GDatabaseMaintenanceImpl::Impl>(Database,
+                                                             InSettings))
+{
+
+}
+
+GDatabaseMaintenanceImpl::~GDatabaseMaintenanceImpl()
+{
+
+}
+
+bool GDatabaseMaintenanceImpl::EnableIncrementalVacuum()
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TickLock);
+    (void)LockGuard;
+
+    bool bOpenedSession = false;
+    bool bEnabled = false;
+
+    try
+    {
+        if (!Pimpl->Database.IsSessionOpen())
+        {
+            bOpenedSession = Pimpl->Database.OpenSession();
+        }
+
+        GDatabaseImpl::WriteGuard WriteGuard(Pimpl->Database);
+        (void)WriteGuard;
+
+        cppdb::session& Session = Pimpl->Database.Sql();
+
+        int Mode = 0;
+        Session << "PRAGMA auto_vacuum;" << cppdb::row >> Mode;
+
+        /// NOTE
+        /// 0 = NONE, 1 = FULL, 2 = INCREMENTAL
+        if (Mode != 2)
+        {
+            Session << "PRAGMA auto_vacuum=INCREMENTAL;" << cppdb::exec;
+            Session << "PRAGMA auto_vacuum;" << cppdb::row >> Mode;
+
+            if (Mode != 2)
+            {
+                /// NOTE
+                /// The database already has tables, the new mode only
+                /// sticks after the file is rebuilt once
+                Session << "VACUUM;" << cppdb::exec;
+                Session << "PRAGMA auto_vacuum;" << cppdb::row >> Mode;
+            }
+        }
+
+        bEnabled = (Mode == 2);
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GDATABASE_MAINTENANCE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_MAINTENANCE_UNKNOWN_ERROR,
+                    GDATABASE_MAINTENANCE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GDATABASE_MAINTENANCE_UNKNOWN_ERROR).Get());
+    }
+
+    if (bOpenedSession && Pimpl->Database.IsSessionOpen())
+    {
+        Pimpl->Database.CloseSession();
+    }
+
+    return bEnabled;
+}
+
+GDatabaseMaintenanceImpl::Report GDatabaseMaintenanceImpl::Tick(
+        const std::chrono::microseconds& Budget)
+{
+    return Pimpl->Tick(Budget);
+}
+
+GDatabaseMaintenanceImpl::Report GDatabaseMaintenanceImpl::GetLastReport() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->TickLock);
+    (void)LockGuard;
+
+    return Pimpl->LastReport;
+}
+
+GDatabaseMaintenanceImpl::Impl::Impl(GDatabaseImpl& InDatabase,
+                                     const Settings& InSettings)
+    : Database(InDatabase),
+      MaintenanceSettings(InSettings),
+      LastReport(),
+      LastCheckpoint(std::chrono::steady_clock::now()),
+      bStopping(false)
+{
+    if (MaintenanceSettings.VacuumPagesPerStep == 0)
+    {
+        MaintenanceSettings.VacuumPagesPerStep = 1;
+    }
+
+    LastReport.WalFrames = -1;
+    LastReport.WalFramesCheckpointed = -1;
+
+    if (MaintenanceSettings.BackgroundInterval.count() > 0)
+    {
+        Thread = std::thread(&GDatabaseMaintenanceImpl::Impl::Run, this);
+    }
+}
+
+GDatabaseMaintenanceImpl::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        bStopping = true;
+    }
+
+    StopCondition.notify_one();
+
+    if (Thread.joinable())
+    {
+        Thread.join();
+    }
+}
+
+void GDatabaseMaintenanceImpl::Impl::Run()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> UniqueLock(Lock);
+
+            StopCondition.wait_for(UniqueLock,
+                                   MaintenanceSettings.BackgroundInterval,
+                                   [this]() {
+                return bStopping;
+            });
+
+            if (bStopping)
+            {
+                break;
+            }
+        }
+
+        Tick(MaintenanceSettings.BackgroundBudget);
+    }
+
+    /// NOTE
+    /// The background thread's session would otherwise stay checked out of
+    /// the pool until the database goes away
+    Database.ReleaseThreadSession();
+}
+
+GDatabaseMaintenanceImpl::Report GDatabaseMaintenanceImpl::Impl::Tick(
+        const std::chrono::microseconds& Budget)
+{
+    std::lock_guard<std::mutex> LockGuard(TickLock);
+    (void)LockGuard;
+
+    const auto Start = std::chrono::steady_clock::now();
+    const auto Deadline = Start + Budget;
+
+    Report Result;
+    Result.PagesVacuumed = 0;
+    Result.FreePagesLeft = 0;
+    Result.bCheckpointed = false;
+    Result.WalFrames = LastReport.WalFrames;
+    Result.WalFramesCheckpointed = LastReport.WalFramesCheckpointed;
+
+    bool bOpenedSession = false;
+
+    try
+    {
+        if (!Database.IsSessionOpen())
+        {
+            bOpenedSession = Database.OpenSession();
+        }
+
+        cppdb::session& Session = Database.Sql();
+
+        if (Start - LastCheckpoint >= MaintenanceSettings.CheckpointInterval)
+        {
+            Checkpoint(Session, Result);
+            LastCheckpoint = std::chrono::steady_clock::now();
+        }
+
+        Vacuum(Session, Deadline, Result);
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GDATABASE_MAINTENANCE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_MAINTENANCE_UNKNOWN_ERROR,
+                    GDATABASE_MAINTENANCE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GDATABASE_MAINTENANCE_UNKNOWN_ERROR).Get());
+    }
+
+    if (bOpenedSession && Database.IsSessionOpen())
+    {
+        Database.CloseSession();
+    }
+
+    Result.Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - Start);
+    LastReport = Result;
+
+    return Result;
+}
+
+void GDatabaseMaintenanceImpl::Impl::Checkpoint(cppdb::session& Session,
+                                                Report& Out_Report)
+{
+    /// NOTE
+    /// PASSIVE never waits on readers or writers, it copies whatever frames
+    /// are not pinned by an open read transaction and leaves the rest for
+    /// the next round. Returns ( busy, log frames, checkpointed frames ),
+    /// the latter two being -1 outside of WAL mode.
+    int Busy = 0;
+    int Frames = -1;
+    int Checkpointed = -1;
+
+    cppdb::result Result = Session << "PRAGMA wal_checkpoint(PASSIVE);"
+                                   << cppdb::row;
+    if (!Result.empty())
+    {
+        Result >> Busy >> Frames >> Checkpointed;
+    }
+
+    Out_Report.bCheckpointed = (Busy == 0 && Frames >= 0);
+    Out_Report.WalFrames = Frames;
+    Out_Report.WalFramesCheckpointed = Checkpointed;
+}
+
+void GDatabaseMaintenanceImpl::Impl::Vacuum(
+        cppdb::session& Session,
+        const std::chrono::steady_clock::time_point& Deadline,
+        Report& Out_Report)
+{
+    const std::string Query(fmt::format(
+                                "PRAGMA incremental_vacuum({0});",
+                                MaintenanceSettings.VacuumPagesPerStep));
+
+    int FreePages = 0;
+    Session << "PRAGMA freelist_count;" << cppdb::row >> FreePages;
+
+    while (FreePages > 0
+           && static_cast<uint32>(FreePages)
+           > MaintenanceSettings.FreePagesThreshold
+           && std::chrono::steady_clock::now() < Deadline)
+    {
+        {
+            /// NOTE
+            /// Each step is its own short write transaction, so game saves
+            /// only ever wait on a single step
+            GDatabaseImpl::WriteGuard WriteGuard(Database);
+            (void)WriteGuard;
+
+            /// NOTE
+            /// incremental_vacuum releases one page per sqlite3_step(), it
+            /// has to be stepped to completion rather than exec'ed
+            cppdb::result Result = Session << Query;
+            while (Result.next())
+            {
+
+            }
+        }
+
+        int Left = 0;
+        Session << "PRAGMA freelist_count;" << cppdb::row >> Left;
+
+        if (Left >= FreePages)
+        {
+            /// NOTE
+            /// Not in incremental mode, nothing more can be reclaimed
+            FreePages = Left;
+            break;
+        }
+
+        Out_Report.PagesVacuumed += static_cast<uint32>(FreePages - Left);
+        FreePages = Left;
+    }
+
+    Out_Report.FreePagesLeft = static_cast<uint32>(FreePages);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Incremental vacuum and WAL checkpoint scheduler on top of the SQL
+ * connectivity layer
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include <CoreTypes.h>
+
+class GDatabaseImpl;
+
+class GODSOFDECEITPERSISTENTDATAIMPL_API GDatabaseMaintenanceImpl
+{
+public:
+    struct Settings
+    {
+        /// NOTE
+        /// Pages released per PRAGMA incremental_vacuum step; the time
+        /// budget is checked between steps
+        uint32 VacuumPagesPerStep;
+
+        /// NOTE
+        /// Free pages tolerated before any vacuuming starts, so that pages
+        /// about to be reused by the next save are not given back to the
+        /// file system for nothing
+        uint32 FreePagesThreshold;
+
+        /// NOTE
+        /// Minimum time between two passive WAL checkpoints
+        std::chrono::milliseconds CheckpointInterval;
+
+        /// NOTE
+        /// When non-zero, a background thread ticks the scheduler on this
+        /// interval with BackgroundBudget; otherwise the owner is expected
+        /// to call Tick() on idle frames
+        std::chrono::milliseconds BackgroundInterval;
+        std::chrono::microseconds BackgroundBudget;
+
+        Settings()
+            : VacuumPagesPerStep(64),
+              FreePagesThreshold(256),
+              CheckpointInterval(2000),
+              BackgroundInterval(0),
+              BackgroundBudget(2000)
+        {
+
+        }
+    };
+
+    struct Report
+    {
+        uint32 PagesVacuumed;
+        uint32 FreePagesLeft;
+        bool bCheckpointed;
+        /// NOTE
+        /// Frames in the WAL and how many of them made it back into the
+        /// database file during the last checkpoint, -1 when not in WAL mode
+        int32 WalFrames;
+        int32 WalFramesCheckpointed;
+        std::chrono::microseconds Elapsed;
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    explicit GDatabaseMaintenanceImpl(GDatabaseImpl& Database,
+                                      const Settings& InSettings = Settings());
+    virtual ~GDatabaseMaintenanceImpl();
+
+public:
+    /// NOTE
+    /// Switches the database to auto_vacuum=INCREMENTAL. An existing
+    /// database needs a one-off full VACUUM for the switch to take effect,
+    /// which happens here as well, so call this at load time rather than
+    /// during gameplay.
+    bool EnableIncrementalVacuum();
+
+    /// NOTE
+    /// Does as much maintenance as fits in Budget: a passive checkpoint
+    /// when one is due, then bounded incremental vacuum steps. A step that
+    /// has started always finishes, so the budget may be overrun by one.
+    Report Tick(const std::chrono::microseconds& Budget);
+
+    Report GetLastReport() const;
+};
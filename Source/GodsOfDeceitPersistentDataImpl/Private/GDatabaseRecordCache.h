@@ -0,0 +1,501 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * In-memory record cache with dirty tracking and LRU eviction in front of
+ * the SQL connectivity layer
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+#include "GDatabase.h"
+#include "GDatabaseTable.h"
+
+template <typename KEY>
+struct GDatabaseRecordKeyHasher : public std::hash<KEY>
+{
+
+};
+
+template <>
+struct GDatabaseRecordKeyHasher<FString>
+{
+    std::size_t operator()(const FString& Key) const
+    {
+        return static_cast<std::size_t>(GetTypeHash(Key));
+    }
+};
+
+/// NOTE
+/// Write-back cache for one typed table (see GDatabaseTable.h), keyed by
+/// the table's primary key. Reads are served from memory when possible,
+/// writes only mark the cached record dirty, and Flush() persists the dirty
+/// rows and pending deletes in a single transaction, e.g. on autosave.
+///
+/// Clean records are evicted least recently used first once the estimated
+/// memory use goes over the cap. Dirty records are never evicted, so the
+/// cache may temporarily exceed the cap until the next flush.
+template <typename TABLE>
+class GDatabaseRecordCacheImpl
+{
+public:
+    typedef GDatabaseTableTraits<TABLE> Traits;
+    typedef typename TABLE::RecordType RecordType;
+    typedef typename Traits::KeyType KeyType;
+
+    struct Stats
+    {
+        uint64 Hits;
+        uint64 Misses;
+        uint64 Evictions;
+        uint64 Flushes;
+        uint64 RowsFlushed;
+        std::size_t Records;
+        std::size_t DirtyRecords;
+        std::size_t PendingDeletes;
+        std::size_t MemoryUsage;
+        std::size_t MemoryCap;
+    };
+
+private:
+    typedef std::list<KeyType> RecencyList;
+
+    struct Entry
+    {
+        RecordType Record;
+        std::size_t Size;
+        /// NOTE
+        /// Stamped from a cache-wide counter by every Put(), the record is
+        /// dirty until a flush persists its latest version
+        uint64 Version;
+        uint64 FlushedVersion;
+        typename RecencyList::iterator Recency;
+    };
+
+    typedef std::unordered_map<KeyType, Entry,
+        GDatabaseRecordKeyHasher<KeyType>> EntriesHashTable;
+    typedef std::unordered_set<KeyType,
+        GDatabaseRecordKeyHasher<KeyType>> KeysHashSet;
+
+private:
+    GDatabaseImpl& Database;
+
+    mutable std::mutex Lock;
+    EntriesHashTable Entries;
+    RecencyList Recency;
+    KeysHashSet PendingDeletes;
+    std::size_t DirtyCount;
+    uint64 LastVersion;
+
+    Stats CacheStats;
+
+public:
+    GDatabaseRecordCacheImpl(GDatabaseImpl& InDatabase,
+                             const std::size_t MemoryCap)
+        : Database(InDatabase),
+          DirtyCount(0),
+          LastVersion(0),
+          CacheStats()
+    {
+        CacheStats.MemoryCap = MemoryCap;
+    }
+
+    virtual ~GDatabaseRecordCacheImpl()
+    {
+
+    }
+
+public:
+    bool Find(const KeyType& Key, RecordType& Out_Record)
+    {
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            auto Iterator = Entries.find(Key);
+
+            if (Iterator != Entries.end())
+            {
+                ++CacheStats.Hits;
+                Touch(Iterator->second);
+                Out_Record = Iterator->second.Record;
+                return true;
+            }
+
+            ++CacheStats.Misses;
+
+            if (PendingDeletes.find(Key) != PendingDeletes.end())
+            {
+                return false;
+            }
+        }
+
+        RecordType Record;
+
+        if (!Load(Key, Record))
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        /// NOTE
+        /// Somebody may have written or erased the record while it was
+        /// loading, their version wins
+        auto Iterator = Entries.find(Key);
+
+        if (Iterator != Entries.end())
+        {
+            Out_Record = Iterator->second.Record;
+            return true;
+        }
+
+        if (PendingDeletes.find(Key) != PendingDeletes.end())
+        {
+            return false;
+        }
+
+        Emplace(Key, Record, false);
+        Out_Record = std::move(Record);
+        EvictLocked();
+
+        return true;
+    }
+
+    void Put(const RecordType& Record)
+    {
+        const KeyType& Key = Traits::GetKey(Record);
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        PendingDeletes.erase(Key);
+
+        auto Iterator = Entries.find(Key);
+
+        if (Iterator == Entries.end())
+        {
+            Emplace(Key, Record, true);
+        }
+        else
+        {
+            Entry& Existing = Iterator->second;
+
+            if (Existing.Version == Existing.FlushedVersion)
+            {
+                ++DirtyCount;
+            }
+
+            CacheStats.MemoryUsage -= Existing.Size;
+            Existing.Record = Record;
+            Existing.Size = Traits::GetRecordSize(Record);
+            CacheStats.MemoryUsage += Existing.Size;
+            Existing.Version = ++LastVersion;
+
+            Touch(Existing);
+        }
+
+        EvictLocked();
+    }
+
+    void Erase(const KeyType& Key)
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        auto Iterator = Entries.find(Key);
+
+        if (Iterator != Entries.end())
+        {
+            Remove(Iterator);
+        }
+
+        PendingDeletes.insert(Key);
+    }
+
+    /// NOTE
+    /// Persists every dirty record and pending delete in one transaction
+    /// and returns the number of rows written; records changed while the
+    /// flush runs stay dirty
+    std::size_t Flush()
+    {
+        std::vector<RecordType> Records;
+        std::vector<std::pair<KeyType, uint64>> Versions;
+        std::vector<KeyType> Deletes;
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            if (DirtyCount == 0 && PendingDeletes.empty())
+            {
+                return 0;
+            }
+
+            Records.reserve(DirtyCount);
+            Versions.reserve(DirtyCount);
+
+            for (const auto& Iterator : Entries)
+            {
+                if (Iterator.second.Version != Iterator.second.FlushedVersion)
+                {
+                    Records.push_back(Iterator.second.Record);
+                    Versions.emplace_back(Iterator.first,
+                                          Iterator.second.Version);
+                }
+            }
+
+            Deletes.assign(PendingDeletes.begin(), PendingDeletes.end());
+            PendingDeletes.clear();
+        }
+
+        const bool bCommitted = Store(Records, Deletes);
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        if (!bCommitted)
+        {
+            /// NOTE
+            /// Keep the deletes around for the next attempt unless the
+            /// record has been written again in the meantime
+            for (const KeyType& Key : Deletes)
+            {
+                if (Entries.find(Key) == Entries.end())
+                {
+                    PendingDeletes.insert(Key);
+                }
+            }
+
+            return 0;
+        }
+
+        for (const auto& Version : Versions)
+        {
+            auto Iterator = Entries.find(Version.first);
+
+            if (Iterator != Entries.end()
+                    && Iterator->second.FlushedVersion
+                    != Iterator->second.Version)
+            {
+                Iterator->second.FlushedVersion = Version.second;
+
+                if (Iterator->second.FlushedVersion
+                        == Iterator->second.Version)
+                {
+                    --DirtyCount;
+                }
+            }
+        }
+
+        ++CacheStats.Flushes;
+        CacheStats.RowsFlushed += Records.size() + Deletes.size();
+
+        EvictLocked();
+
+        return Records.size() + Deletes.size();
+    }
+
+    /// NOTE
+    /// Drops every clean record, e.g. when leaving a level
+    void Trim()
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        EvictLocked(0);
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        Stats Result(CacheStats);
+        Result.Records = Entries.size();
+        Result.DirtyRecords = DirtyCount;
+        Result.PendingDeletes = PendingDeletes.size();
+
+        return Result;
+    }
+
+private:
+    bool Load(const KeyType& Key, RecordType& Out_Record)
+    {
+        const bool bOpenedSession = !Database.IsSessionOpen()
+                && Database.OpenSession();
+
+        const bool bFound = Database.FindRecord<TABLE>(Key, Out_Record);
+
+        if (bOpenedSession)
+        {
+            Database.CloseSession();
+        }
+
+        return bFound;
+    }
+
+    bool Store(const std::vector<RecordType>& Records,
+               const std::vector<KeyType>& Deletes)
+    {
+        GDatabaseImpl::WriteGuard WriteGuard(Database);
+        (void)WriteGuard;
+
+        const bool bOpenedSession = !Database.IsSessionOpen()
+                && Database.OpenSession();
+        bool bCommitted = false;
+
+        try
+        {
+            /// NOTE
+            /// Have the failing statement thrown back at us, so that none
+            /// of the batch gets committed and marked as flushed
+            GDatabaseImpl::ErrorPropagationScope PropagationScope;
+            (void)PropagationScope;
+
+            cppdb::transaction Transaction(Database.Sql());
+
+            bool bSucceeded = Database.InsertRecords<TABLE>(
+                        Records, GDatabaseImpl::EConflictResolution::Upsert);
+
+            for (const KeyType& Key : Deletes)
+            {
+                if (!bSucceeded)
+                {
+                    break;
+                }
+
+                bSucceeded = Database.DeleteRecord<TABLE>(Key);
+            }
+
+            if (bSucceeded)
+            {
+                Transaction.commit();
+                bCommitted = true;
+            }
+        }
+
+        catch (...)
+        {
+            /// NOTE
+            /// The failing statement has been logged by GDatabaseImpl
+            /// already, the transaction rolls back on its way out
+        }
+
+        if (bOpenedSession)
+        {
+            Database.CloseSession();
+        }
+
+        return bCommitted;
+    }
+
+    void Emplace(const KeyType& Key, const RecordType& Record,
+                 const bool bDirty)
+    {
+        Recency.push_front(Key);
+
+        Entry& Inserted = Entries[Key];
+        Inserted.Record = Record;
+        Inserted.Size = Traits::GetRecordSize(Record);
+        Inserted.Version = bDirty ? ++LastVersion : 0;
+        Inserted.FlushedVersion = 0;
+        Inserted.Recency = Recency.begin();
+
+        CacheStats.MemoryUsage += Inserted.Size;
+
+        if (bDirty)
+        {
+            ++DirtyCount;
+        }
+    }
+
+    void Remove(typename EntriesHashTable::iterator Iterator)
+    {
+        if (Iterator->second.Version != Iterator->second.FlushedVersion)
+        {
+            --DirtyCount;
+        }
+
+        CacheStats.MemoryUsage -= Iterator->second.Size;
+        Recency.erase(Iterator->second.Recency);
+        Entries.erase(Iterator);
+    }
+
+    void Touch(Entry& Target)
+    {
+        Recency.splice(Recency.begin(), Recency, Target.Recency);
+    }
+
+    void EvictLocked()
+    {
+        EvictLocked(CacheStats.MemoryCap);
+    }
+
+    void EvictLocked(const std::size_t Cap)
+    {
+        auto Iterator = Recency.end();
+
+        while (CacheStats.MemoryUsage > Cap && Iterator != Recency.begin())
+        {
+            --Iterator;
+
+            auto Found = Entries.find(*Iterator);
+
+            if (Found->second.Version != Found->second.FlushedVersion)
+            {
+                continue;
+            }
+
+            /// NOTE
+            /// Remove() unlinks the node, hold on to its successor
+            auto Next = std::next(Iterator);
+            Remove(Found);
+            ++CacheStats.Evictions;
+            Iterator = Next;
+        }
+    }
+};
@@ -0,0 +1,496 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Compile-time typed table descriptors for the SQL connectivity layer
+ */
+
+
+#pragma once
+
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+#include "GDatabase.h"
+
+/// NOTE
+/// Maps a C++ column type to its SQLite type affinity
+template <typename TYPE, typename ENABLE = void>
+struct GDatabaseColumnAffinity
+{
+    static_assert(sizeof(TYPE) == 0,
+                  "Error: unsupported database column type!");
+};
+
+template <typename TYPE>
+struct GDatabaseColumnAffinity<TYPE, typename std::enable_if<
+        std::is_integral<TYPE>::value>::type>
+{
+    static FORCEINLINE const char* Get()
+    {
+        return "INTEGER";
+    }
+};
+
+template <typename TYPE>
+struct GDatabaseColumnAffinity<TYPE, typename std::enable_if<
+        std::is_floating_point<TYPE>::value>::type>
+{
+    static FORCEINLINE const char* Get()
+    {
+        return "REAL";
+    }
+};
+
+template <>
+struct GDatabaseColumnAffinity<std::string>
+{
+    static FORCEINLINE const char* Get()
+    {
+        return "TEXT";
+    }
+};
+
+template <>
+struct GDatabaseColumnAffinity<FString>
+{
+    static FORCEINLINE const char* Get()
+    {
+        return "TEXT";
+    }
+};
+
+/// NOTE
+/// Heap memory owned by a column value, used for cache accounting
+template <typename TYPE>
+FORCEINLINE std::size_t GDatabaseGetAllocatedSize(const TYPE& Value)
+{
+    (void)Value;
+    return 0;
+}
+
+FORCEINLINE std::size_t GDatabaseGetAllocatedSize(const std::string& Value)
+{
+    return Value.capacity();
+}
+
+FORCEINLINE std::size_t GDatabaseGetAllocatedSize(const FString& Value)
+{
+    return static_cast<std::size_t>(Value.GetAllocatedSize());
+}
+
+template <typename RECORD, typename TYPE>
+struct GDatabaseColumn
+{
+    typedef RECORD RecordType;
+    typedef TYPE ValueType;
+
+    const char* Name;
+    TYPE RECORD::* Member;
+    /// NOTE
+    /// Anything that follows the type in the column definition, e.g.
+    /// "NOT NULL DEFAULT 0"
+    const char* Constraints;
+};
+
+template <typename RECORD, typename TYPE>
+constexpr GDatabaseColumn<RECORD, TYPE> GDatabaseMakeColumn(
+        const char* Name, TYPE RECORD::* Member, const char* Constraints = "")
+{
+    return GDatabaseColumn<RECORD, TYPE> { Name, Member, Constraints };
+}
+
+/// NOTE
+/// A typed table descriptor names its record type, its table and its
+/// columns; the first column is the primary key, e.g.
+///
+/// struct GPlayerTable
+/// {
+///     typedef GPlayerRecord RecordType;
+///
+///     static const char* Name()
+///     {
+///         return "players";
+///     }
+///
+///     static constexpr auto Columns()
+///     {
+///         return std::make_tuple(
+///             GDatabaseMakeColumn("id", &GPlayerRecord::Id),
+///             GDatabaseMakeColumn("name", &GPlayerRecord::Name, "NOT NULL"),
+///             GDatabaseMakeColumn("level", &GPlayerRecord::Level));
+///     }
+/// };
+///
+/// GDatabaseTableTraits turns such a descriptor into SQL and binders.
+/// Column types, count and binding are resolved at compile time. The SQL
+/// text is generated once per table type on first use and every statement
+/// gets a fixed slot in the per-thread statement cache, so the typed
+/// methods on GDatabaseImpl never hash a table id or convert values to
+/// FString.
+template <typename TABLE>
+struct GDatabaseTableTraits
+{
+    typedef typename TABLE::RecordType RECORD;
+
+    typedef typename std::decay<decltype(std::get<0>(TABLE::Columns()))>::type
+        KeyColumnType;
+    typedef typename KeyColumnType::ValueType KeyType;
+
+    static constexpr std::size_t GetColumnsCount()
+    {
+        return std::tuple_size<decltype(TABLE::Columns())>::value;
+    }
+
+    static const std::string& CreateSql()
+    {
+        static const std::string Sql(BuildCreateSql());
+        return Sql;
+    }
+
+    static const std::string& InsertSql(
+            const GDatabaseImpl::EConflictResolution Resolution)
+    {
+        static const std::string Sql[] = {
+            BuildInsertSql(GDatabaseImpl::EConflictResolution::Abort),
+            BuildInsertSql(GDatabaseImpl::EConflictResolution::Ignore),
+            BuildInsertSql(GDatabaseImpl::EConflictResolution::Replace),
+            BuildInsertSql(GDatabaseImpl::EConflictResolution::Upsert)
+        };
+        return Sql[static_cast<std::size_t>(Resolution)];
+    }
+
+    static const std::string& UpdateSql()
+    {
+        static_assert(GetColumnsCount() > 1,
+                      "Error: a table with a key column only has nothing "
+                      "to update!");
+
+        static const std::string Sql(
+                    std::string("UPDATE [") + TABLE::Name() + "] SET "
+                    + JoinColumns(1, " = ?, ") + " = ? WHERE "
+                    + KeyName() + " = ?;");
+        return Sql;
+    }
+
+    static const std::string& DeleteSql()
+    {
+        static const std::string Sql(
+                    std::string("DELETE FROM [") + TABLE::Name()
+                    + "] WHERE " + KeyName() + " = ?;");
+        return Sql;
+    }
+
+    static const std::string& SelectSql()
+    {
+        static const std::string Sql(
+                    std::string("SELECT ") + JoinColumns(0, ", ") + " FROM ["
+                    + TABLE::Name() + "] WHERE " + KeyName() + " = ?;");
+        return Sql;
+    }
+
+    /// NOTE
+    /// Statement cache slots, one per statement shape of this table; inserts
+    /// take one slot per conflict resolution
+    enum EStatement : std::size_t
+    {
+        InsertStatement = 0,
+        UpdateStatement = 4,
+        DeleteStatement = 5,
+        SelectStatement = 6,
+        CreateStatement = 7
+    };
+
+    static std::size_t GetStatementSlot(const std::size_t Statement)
+    {
+        static const std::size_t Slots[] = {
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot(),
+            GDatabaseImpl::AllocateStatementSlot()
+        };
+        return Slots[Statement];
+    }
+
+    static void BindRecord(cppdb::statement& Statement, const RECORD& Record)
+    {
+        BindColumns(Statement, Record,
+                    std::make_index_sequence<GetColumnsCount()>());
+    }
+
+    /// NOTE
+    /// Binds the non-key columns followed by the key, in the order
+    /// UpdateSql() expects them
+    static void BindUpdate(cppdb::statement& Statement, const RECORD& Record)
+    {
+        BindNonKeyColumns(Statement, Record,
+                          std::make_index_sequence<GetColumnsCount() - 1>());
+        GDatabaseImpl::BindValue(Statement, Record.*(KeyColumn().Member));
+    }
+
+    static void FetchRecord(GDatabaseImpl::Cursor& Cursor, RECORD& Out_Record)
+    {
+        FetchColumns(Cursor, Out_Record,
+                     std::make_index_sequence<GetColumnsCount()>());
+    }
+
+    static const KeyType& GetKey(const RECORD& Record)
+    {
+        return Record.*(KeyColumn().Member);
+    }
+
+    /// NOTE
+    /// sizeof(RECORD) plus whatever its string columns hold on the heap
+    static std::size_t GetRecordSize(const RECORD& Record)
+    {
+        return sizeof(RECORD)
+                + GetAllocatedSize(Record,
+                                   std::make_index_sequence<
+                                   GetColumnsCount()>());
+    }
+
+private:
+    static constexpr KeyColumnType KeyColumn()
+    {
+        return std::get<0>(TABLE::Columns());
+    }
+
+    static std::string KeyName()
+    {
+        return KeyColumn().Name;
+    }
+
+    static std::string JoinColumns(const std::size_t First,
+                                   const char* Separator)
+    {
+        std::string Result;
+
+        ForEachColumn([&](const std::size_t Index, const char* Name,
+                      const char* Affinity, const char* Constraints) {
+            (void)Affinity;
+            (void)Constraints;
+
+            if (Index < First)
+            {
+                return;
+            }
+
+            if (!Result.empty())
+            {
+                Result += Separator;
+            }
+
+            Result += Name;
+        });
+
+        return Result;
+    }
+
+    static std::string BuildCreateSql()
+    {
+        std::string Definitions;
+
+        ForEachColumn([&](const std::size_t Index, const char* Name,
+                      const char* Affinity, const char* Constraints) {
+            if (!Definitions.empty())
+            {
+                Definitions += ", ";
+            }
+
+            Definitions += Name;
+            Definitions += " ";
+            Definitions += Affinity;
+
+            if (Index == 0)
+            {
+                Definitions += " PRIMARY KEY";
+            }
+
+            if (Constraints != nullptr && Constraints[0] != '\0')
+            {
+                Definitions += " ";
+                Definitions += Constraints;
+            }
+        });
+
+        return std::string("CREATE TABLE IF NOT EXISTS [") + TABLE::Name()
+                + "] ( " + Definitions + " );";
+    }
+
+    static std::string BuildInsertSql(
+            const GDatabaseImpl::EConflictResolution Resolution)
+    {
+        std::string Placeholders;
+        for (std::size_t i = 0; i < GetColumnsCount(); ++i)
+        {
+            Placeholders += (i == 0 ? "?" : ", ?");
+        }
+
+        const char* Verb = "INSERT";
+        std::string Clause;
+
+        switch (Resolution)
+        {
+        case GDatabaseImpl::EConflictResolution::Abort:
+            break;
+        case GDatabaseImpl::EConflictResolution::Ignore:
+            Verb = "INSERT OR IGNORE";
+            break;
+        case GDatabaseImpl::EConflictResolution::Replace:
+            Verb = "INSERT OR REPLACE";
+            break;
+        case GDatabaseImpl::EConflictResolution::Upsert:
+        {
+            std::string Assignments;
+
+            ForEachColumn([&](const std::size_t Index, const char* Name,
+                          const char* Affinity, const char* Constraints) {
+                (void)Affinity;
+                (void)Constraints;
+
+                if (Index == 0)
+                {
+                    return;
+                }
+
+                if (!Assignments.empty())
+                {
+                    Assignments += ", ";
+                }
+
+                Assignments += std::string(Name) + " = excluded." + Name;
+            });
+
+            Clause = " ON CONFLICT ( " + KeyName() + " ) "
+                    + (Assignments.empty()
+                       ? std::string("DO NOTHING")
+                       : "DO UPDATE SET " + Assignments);
+        } break;
+        }
+
+        return std::string(Verb) + " INTO [" + TABLE::Name() + "] ( "
+                + JoinColumns(0, ", ") + " ) VALUES ( " + Placeholders
+                + " )" + Clause + ";";
+    }
+
+    template <typename FUNCTOR>
+    static void ForEachColumn(FUNCTOR&& Functor)
+    {
+        ForEachColumn(std::forward<FUNCTOR>(Functor),
+                      std::make_index_sequence<GetColumnsCount()>());
+    }
+
+    template <typename FUNCTOR, std::size_t... INDICES>
+    static void ForEachColumn(FUNCTOR&& Functor,
+                              std::index_sequence<INDICES...>)
+    {
+        const auto Columns = TABLE::Columns();
+
+        int Expander[] = { 0, (Functor(
+                                   INDICES,
+                                   std::get<INDICES>(Columns).Name,
+                                   GDatabaseColumnAffinity<
+                                   typename std::decay<decltype(
+                                       std::get<INDICES>(Columns))>::type
+                                   ::ValueType>::Get(),
+                                   std::get<INDICES>(Columns).Constraints),
+                               0)... };
+        (void)Expander;
+    }
+
+    template <std::size_t... INDICES>
+    static FORCEINLINE void BindColumns(cppdb::statement& Statement,
+                                        const RECORD& Record,
+                                        std::index_sequence<INDICES...>)
+    {
+        const auto Columns = TABLE::Columns();
+
+        int Expander[] = { 0, (GDatabaseImpl::BindValue(
+                                   Statement,
+                                   Record.*(std::get<INDICES>(Columns)
+                                            .Member)), 0)... };
+        (void)Expander;
+    }
+
+    template <std::size_t... INDICES>
+    static FORCEINLINE void BindNonKeyColumns(cppdb::statement& Statement,
+                                              const RECORD& Record,
+                                              std::index_sequence<INDICES...>)
+    {
+        const auto Columns = TABLE::Columns();
+
+        int Expander[] = { 0, (GDatabaseImpl::BindValue(
+                                   Statement,
+                                   Record.*(std::get<INDICES + 1>(Columns)
+                                            .Member)), 0)... };
+        (void)Expander;
+        (void)Statement;
+    }
+
+    template <std::size_t... INDICES>
+    static FORCEINLINE std::size_t GetAllocatedSize(
+            const RECORD& Record, std::index_sequence<INDICES...>)
+    {
+        const auto Columns = TABLE::Columns();
+
+        std::size_t Size = 0;
+        int Expander[] = { 0, (Size += GDatabaseGetAllocatedSize(
+                                   Record.*(std::get<INDICES>(Columns)
+                                            .Member)), 0)... };
+        (void)Expander;
+
+        return Size;
+    }
+
+    template <std::size_t... INDICES>
+    static FORCEINLINE void FetchColumns(GDatabaseImpl::Cursor& Cursor,
+                                         RECORD& Out_Record,
+                                         std::index_sequence<INDICES...>)
+    {
+        const auto Columns = TABLE::Columns();
+
+        int Expander[] = { 0, (Cursor.Fetch(
+                                   static_cast<int32>(INDICES),
+                                   Out_Record.*(std::get<INDICES>(Columns)
+                                                .Member)), 0)... };
+        (void)Expander;
+    }
+};
@@ -0,0 +1,333 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Asynchronous write queue with group commit on top of the SQL connectivity
+ * layer
+ */
+
+
+#include "GDatabaseWriter.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <cppdb/frontend.h>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GHacks/GInclude_Windows.h>
+
+#include "GDatabase.h"
+
+#define  GDATABASE_WRITER_ERROR_DIALOG_TITLE    "Database Error"
+#define  GDATABASE_WRITER_UNKNOWN_ERROR         "GDatabaseWriter: unknown error!"
+
+struct GDatabaseWriterImpl::Impl
+{
+public:
+    struct Entry
+    {
+        Mutation Function;
+        std::promise<bool> Promise;
+    };
+
+public:
+    GDatabaseImpl& Database;
+    Settings WriterSettings;
+
+    mutable std::mutex Lock;
+    std::condition_variable QueueCondition;
+    std::condition_variable FlushCondition;
+
+    std::deque<Entry> Queue;
+    uint64 EnqueuedCount;
+    uint64 CommittedCount;
+    uint32 FlushWaiters;
+    bool bStopping;
+
+    std::thread Thread;
+
+public:
+    Impl(GDatabaseImpl& InDatabase, const Settings& InSettings);
+    ~Impl();
+
+public:
+    void Run();
+    void Commit(std::vector<Entry>& Batch);
+};
+
+GDatabaseWriterImpl::GDatabaseWriterImpl(GDatabaseImpl& Database,
+                                         const Settings& InSettings)
+    : Pimpl(std::make_unique<GDatabaseWriterImpl::Impl>(Database, InSettings))
+{
+
+}
+
+GDatabaseWriterImpl::~GDatabaseWriterImpl()
+{
+
+}
+
+std::future<bool> GDatabaseWriterImpl::Enqueue(Mutation InMutation)
+{
+    Impl::Entry Entry;
+    Entry.Function = std::move(InMutation);
+    std::future<bool> Future(Entry.Promise.get_future());
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        checkf(!Pimpl->bStopping,
+               TEXT("FATAL: cannot enqueue into a stopping database writer!"));
+
+        Pimpl->Queue.push_back(std::move(Entry));
+        ++Pimpl->EnqueuedCount;
+    }
+
+    Pimpl->QueueCondition.notify_one();
+
+    return Future;
+}
+
+void GDatabaseWriterImpl::Flush()
+{
+    std::unique_lock<std::mutex> UniqueLock(Pimpl->Lock);
+
+    const uint64 Target = Pimpl->EnqueuedCount;
+
+    ++Pimpl->FlushWaiters;
+    Pimpl->QueueCondition.notify_one();
+
+    Pimpl->FlushCondition.wait(UniqueLock, [this, Target]() {
+        return Pimpl->CommittedCount >= Target;
+    });
+
+    --Pimpl->FlushWaiters;
+}
+
+std::size_t GDatabaseWriterImpl::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return static_cast<std::size_t>(Pimpl->EnqueuedCount
+                                    - Pimpl->CommittedCount);
+}
+
+GDatabaseWriterImpl::Impl::Impl(GDatabaseImpl& InDatabase,
+                                const Settings& InSettings)
+    : Database(InDatabase),
+      WriterSettings(InSettings),
+      EnqueuedCount(0),
+      CommittedCount(0),
+      FlushWaiters(0),
+      bStopping(false)
+{
+    if (WriterSettings.MaxBatchSize == 0)
+    {
+        WriterSettings.MaxBatchSize = 1;
+    }
+
+    Thread = std::thread(&GDatabaseWriterImpl::Impl::Run, this);
+}
+
+GDatabaseWriterImpl::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        bStopping = true;
+    }
+
+    QueueCondition.notify_one();
+
+    if (Thread.joinable())
+    {
+        Thread.join();
+    }
+}
+
+void GDatabaseWriterImpl::Impl::Run()
+{
+    std::vector<Entry> Batch;
+    Batch.reserve(WriterSettings.MaxBatchSize);
+
+    /// NOTE
+    /// One session for the thread's whole lifetime, so that its connection
+    /// and prepared statements get reused by every batch
+    Database.OpenSession();
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> UniqueLock(Lock);
+
+            QueueCondition.wait(UniqueLock, [this]() {
+                return !Queue.empty() || bStopping;
+            });
+
+            if (Queue.empty() && bStopping)
+            {
+                break;
+            }
+
+            /// NOTE
+            /// Group commit: keep collecting until the batch is full, the
+            /// window closes, or somebody is waiting on a flush
+            const auto Deadline = std::chrono::steady_clock::now()
+                    + WriterSettings.MaxBatchDelay;
+
+            QueueCondition.wait_until(UniqueLock, Deadline, [this]() {
+                return Queue.size() >= WriterSettings.MaxBatchSize
+                        || FlushWaiters > 0
+                        || bStopping;
+            });
+
+            while (!Queue.empty() && Batch.size() < WriterSettings.MaxBatchSize)
+            {
+                Batch.push_back(std::move(Queue.front()));
+                Queue.pop_front();
+            }
+        }
+
+        Commit(Batch);
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            CommittedCount += Batch.size();
+        }
+
+        FlushCondition.notify_all();
+        Batch.clear();
+    }
+
+    if (Database.IsSessionOpen())
+    {
+        Database.CloseSession();
+    }
+
+    Database.ReleaseThreadSession();
+}
+
+void GDatabaseWriterImpl::Impl::Commit(std::vector<Entry>& Batch)
+{
+    std::vector<bool> Results(Batch.size(), false);
+    bool bCommitted = false;
+
+    try
+    {
+        if (!Database.IsSessionOpen())
+        {
+            Database.OpenSession();
+        }
+
+        {
+            GDatabaseImpl::WriteGuard WriteGuard(Database);
+            (void)WriteGuard;
+
+            cppdb::session& Session = Database.Sql();
+            cppdb::transaction TransactionGuard(Session);
+
+            for (std::size_t i = 0; i < Batch.size(); ++i)
+            {
+                /// NOTE
+                /// A failing mutation only rolls back its own savepoint, the
+                /// rest of the batch still gets committed
+                Session << "SAVEPOINT [GDatabaseWriter_Mutation];"
+                        << cppdb::exec;
+
+                try
+                {
+                    /// NOTE
+                    /// Without it GDatabaseImpl would report the failure
+                    /// itself and the savepoint would never be rolled back
+                    GDatabaseImpl::ErrorPropagationScope PropagationScope;
+                    (void)PropagationScope;
+
+                    Batch[i].Function(Database);
+                    Session << "RELEASE [GDatabaseWriter_Mutation];"
+                            << cppdb::exec;
+                    Results[i] = true;
+                }
+
+                catch (...)
+                {
+                    Session << "ROLLBACK TO [GDatabaseWriter_Mutation];"
+                            << cppdb::exec;
+                    Session << "RELEASE [GDatabaseWriter_Mutation];"
+                            << cppdb::exec;
+                }
+            }
+
+            TransactionGuard.commit();
+            bCommitted = true;
+        }
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GDATABASE_WRITER_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GDATABASE_WRITER_UNKNOWN_ERROR,
+                    GDATABASE_WRITER_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GDATABASE_WRITER_UNKNOWN_ERROR).Get());
+    }
+
+    for (std::size_t i = 0; i < Batch.size(); ++i)
+    {
+        Batch[i].Promise.set_value(bCommitted && Results[i]);
+    }
+}
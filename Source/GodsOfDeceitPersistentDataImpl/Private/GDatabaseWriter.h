@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Asynchronous write queue with group commit on top of the SQL connectivity
+ * layer
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <cstddef>
+
+#include <CoreTypes.h>
+
+class GDatabaseImpl;
+
+class GODSOFDECEITPERSISTENTDATAIMPL_API GDatabaseWriterImpl
+{
+public:
+    typedef std::function<void(GDatabaseImpl& Database)> Mutation;
+
+    struct Settings
+    {
+        /// NOTE
+        /// Upper bound on the number of mutations committed together
+        std::size_t MaxBatchSize;
+
+        /// NOTE
+        /// How long the writer keeps collecting mutations before it commits
+        /// a batch. Zero commits as soon as the queue runs dry; a longer
+        /// window means fewer journal syncs at the cost of losing up to that
+        /// much work on a crash.
+        std::chrono::milliseconds MaxBatchDelay;
+
+        Settings()
+            : MaxBatchSize(256),
+              MaxBatchDelay(50)
+        {
+
+        }
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    /// NOTE
+    /// Once a writer is attached to a database, mutations should only reach
+    /// it through Enqueue(); the writer thread commits them on its own
+    /// session. Destroying the writer flushes whatever is still queued.
+    explicit GDatabaseWriterImpl(GDatabaseImpl& Database,
+                                 const Settings& InSettings = Settings());
+    virtual ~GDatabaseWriterImpl();
+
+public:
+    /// NOTE
+    /// The future resolves to true once the mutation's batch has been
+    /// committed, or to false if the mutation or the commit failed. A
+    /// mutation fails by throwing; the GDatabaseImpl writes it makes throw
+    /// their failures at it.
+    std::future<bool> Enqueue(Mutation InMutation);
+
+    /// NOTE
+    /// Blocks until every mutation enqueued before the call is committed,
+    /// e.g. before quitting the game
+    void Flush();
+
+    std::size_t GetPendingCount() const;
+};
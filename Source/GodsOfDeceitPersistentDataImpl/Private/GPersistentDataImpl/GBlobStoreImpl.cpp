@@ -0,0 +1,520 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Content-addressed, deduplicating blob store for save attachments
+ */
+
+
+#include "GPersistentDataImpl/GBlobStoreImpl.h"
+
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+#include <Misc/Paths.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/operations.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GCompressionImpl/GCompressionImpl.h>
+#include <GCryptoImpl/GCryptoImpl.h>
+#include <GLog/GLog.h>
+#include <GPlatformImpl/GFileSystemImpl.h>
+#include <GTypes/GCompressionTypes.h>
+#include <GTypes/GCryptoTypes.h>
+
+#include "GPersistentDataImpl/GJournalStoreImpl.h"
+
+#define     GBLOB_STORE_OBJECTS_DIRECTORY       TEXT("objects")
+#define     GBLOB_STORE_JOURNAL_FILE            TEXT("references.journal")
+#define     GBLOB_STORE_BLOB_EXTENSION          TEXT(".blob")
+
+namespace
+{
+    /// NOTE
+    /// The blob is synced and renamed into place, and its directory synced,
+    /// before the caller records a reference to it
+    bool WriteBlobFile(const FString& Path, const GCompressionBuffer& Data)
+    {
+        return GFileSystemImpl::TryWrite(
+                    Path, {{Data.data(), Data.size()}},
+                    GFileSystemImpl::EWriteMode::Atomic);
+    }
+
+    /// NOTE
+    /// Unlike GCompressionImpl::Decompress(), corrupt data throws instead
+    /// of bringing the game down
+    void DecompressBlob(const std::string& Stored,
+                        GCompressionBuffer& Out_Raw)
+    {
+        GCompressionImpl::Stream Decompressor(
+                    GCompressionImpl::CreateDecompressor(
+                        [&Out_Raw](const GCompressionByte* Data,
+                        const uint64 Length)
+        {
+            Out_Raw.insert(Out_Raw.end(), Data, Data + Length);
+        }, EGCompressionAlgorithm::Zlib));
+
+        Decompressor.Write(Stored.data(), Stored.size());
+        Decompressor.Finish();
+    }
+
+    bool ReadBlobFile(const FString& Path, std::string& Out_Data)
+    {
+        std::ifstream InputFileStream(StringCast<ANSICHAR>(*Path).Get(),
+                                      std::ios::in | std::ios::binary
+                                      | std::ios::ate);
+        if (!InputFileStream.is_open())
+        {
+            return false;
+        }
+
+        const std::streamoff Size = InputFileStream.tellg();
+        InputFileStream.seekg(0, std::ios::beg);
+
+        Out_Data.resize(static_cast<std::size_t>(Size));
+        if (Size > 0)
+        {
+            InputFileStream.read(&Out_Data[0],
+                                 static_cast<std::streamsize>(Size));
+        }
+
+        return static_cast<bool>(InputFileStream);
+    }
+
+    struct BlobRecord
+    {
+        uint64 References;
+        uint64 RawSize;
+        uint64 StoredSize;
+
+        template <class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(References, RawSize, StoredSize);
+        }
+    };
+
+    FString ToHex(const GCryptoBuffer& Digest)
+    {
+        static const TCHAR Digits[] = TEXT("0123456789abcdef");
+
+        FString Hex;
+        Hex.Reserve(static_cast<int32>(Digest.size() * 2));
+
+        for (const GCryptoByte Byte : Digest)
+        {
+            Hex.AppendChar(Digits[Byte >> 4]);
+            Hex.AppendChar(Digits[Byte & 0x0f]);
+        }
+
+        return Hex;
+    }
+
+    bool IsBlobId(const FString& BlobId)
+    {
+        if (BlobId.Len() != static_cast<int32>(
+                    GCryptoImpl::GetHashSize() * 2))
+        {
+            return false;
+        }
+
+        for (const TCHAR Character : BlobId)
+        {
+            if (!((Character >= TEXT('0') && Character <= TEXT('9'))
+                  || (Character >= TEXT('a') && Character <= TEXT('f'))))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+struct GBlobStoreImpl::Impl
+{
+public:
+    const FString Directory;
+    const FString ObjectsDirectory;
+
+    mutable std::mutex Lock;
+    GJournalStoreImpl References;
+    GBlobStoreImpl::Stats Totals;
+
+public:
+    explicit Impl(const FString& InDirectory);
+
+public:
+    FString GetBlobPath(const FString& BlobId) const;
+    bool GetRecord(const FString& BlobId, BlobRecord& Out_Record) const;
+    bool AddReference(const FString& BlobId, BlobRecord& Record,
+                      const uint64 DeduplicatedSize);
+};
+
+GBlobStoreImpl::GBlobStoreImpl(const FString& Directory)
+    : Pimpl(std::make_unique<GBlobStoreImpl::Impl>(Directory))
+{
+
+}
+
+GBlobStoreImpl::~GBlobStoreImpl() = default;
+
+void GBlobStoreImpl::Open()
+{
+    if (!GFileSystemImpl::DirectoryExists(Pimpl->ObjectsDirectory))
+    {
+        GFileSystemImpl::CreateDirectory(Pimpl->ObjectsDirectory);
+    }
+
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    Pimpl->References.Open();
+
+    /// NOTE
+    /// Totals are kept up to date from here on, GetStats() never walks
+    /// the store
+    std::vector<FString> BlobIds;
+    Pimpl->References.GetKeys(BlobIds);
+
+    for (const FString& BlobId : BlobIds)
+    {
+        BlobRecord Record;
+        if (!Pimpl->GetRecord(BlobId, Record))
+        {
+            continue;
+        }
+
+        ++Pimpl->Totals.Blobs;
+        Pimpl->Totals.References += Record.References;
+        Pimpl->Totals.RawBytes += Record.RawSize;
+        Pimpl->Totals.StoredBytes += Record.StoredSize;
+    }
+}
+
+FString GBlobStoreImpl::Put(const char* Data, const uint64 Size)
+{
+    /// NOTE
+    /// Hashing and compressing happen before taking the lock, concurrent
+    /// puts of different blobs do not wait on each other
+    GCryptoBuffer Digest;
+    GCryptoImpl::Hash(reinterpret_cast<const GCryptoByte*>(Data), Size,
+                      Digest);
+    const FString BlobId(ToHex(Digest));
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        BlobRecord Record;
+        if (Pimpl->GetRecord(BlobId, Record))
+        {
+            return Pimpl->AddReference(BlobId, Record, Size)
+                    ? BlobId : FString();
+        }
+    }
+
+    GCompressionBuffer Compressed;
+    if (Size > 0)
+    {
+        GCompressionImpl::Compress(Data, Size, Compressed,
+                                   EGCompressionAlgorithm::Zlib);
+    }
+
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    /// NOTE
+    /// Another thread may have stored the same blob while this one was
+    /// compressing
+    BlobRecord Record;
+    if (Pimpl->GetRecord(BlobId, Record))
+    {
+        return Pimpl->AddReference(BlobId, Record, Size)
+                ? BlobId : FString();
+    }
+
+    const FString Path(Pimpl->GetBlobPath(BlobId));
+    const FString FanOut(FPaths::GetPath(Path));
+    if (!GFileSystemImpl::DirectoryExists(FanOut))
+    {
+        GFileSystemImpl::CreateDirectory(FanOut);
+    }
+
+    /// NOTE
+    /// The blob is durable before its reference is recorded, a crash in
+    /// between only leaves an unreferenced file that the next Put() of it
+    /// overwrites
+    if (!WriteBlobFile(Path, Compressed))
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to store blob, no reference taken: "),
+                     BlobId);
+        return FString();
+    }
+
+    Record.References = 1;
+    Record.RawSize = Size;
+    Record.StoredSize = static_cast<uint64>(Compressed.size());
+    if (!Pimpl->References.Put(BlobId, Record))
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to record blob reference: "), BlobId);
+        GFileSystemImpl::TryErase(Path, false);
+        return FString();
+    }
+
+    ++Pimpl->Totals.Blobs;
+    ++Pimpl->Totals.References;
+    Pimpl->Totals.RawBytes += Record.RawSize;
+    Pimpl->Totals.StoredBytes += Record.StoredSize;
+
+    return BlobId;
+}
+
+FString GBlobStoreImpl::Put(const std::string& Data)
+{
+    return Put(Data.data(), static_cast<uint64>(Data.size()));
+}
+
+bool GBlobStoreImpl::Get(const FString& BlobId, std::string& Out_Data) const
+{
+    BlobRecord Record;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        if (!Pimpl->GetRecord(BlobId, Record))
+        {
+            return false;
+        }
+    }
+
+    Out_Data.clear();
+
+    if (Record.RawSize > 0)
+    {
+        std::string Stored;
+        if (!ReadBlobFile(Pimpl->GetBlobPath(BlobId), Stored)
+                || Stored.size() != Record.StoredSize)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Blob size mismatch, rejected: "), BlobId);
+            return false;
+        }
+
+        GCompressionBuffer Raw;
+        Raw.reserve(static_cast<std::size_t>(Record.RawSize));
+
+        try
+        {
+            DecompressBlob(Stored, Raw);
+        }
+
+        catch (const std::exception& Exception)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Blob failed to decompress, rejected: "),
+                         BlobId, TEXT(", "), Exception.what());
+            return false;
+        }
+
+        Out_Data.assign(Raw.data(), Raw.size());
+    }
+
+    GCryptoBuffer Digest;
+    GCryptoImpl::Hash(reinterpret_cast<const GCryptoByte*>(Out_Data.data()),
+                      static_cast<uint64>(Out_Data.size()), Digest);
+
+    if (ToHex(Digest) != BlobId)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Blob content does not match its id, rejected: "),
+                     BlobId);
+        Out_Data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool GBlobStoreImpl::Contains(const FString& BlobId) const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    BlobRecord Record;
+    return Pimpl->GetRecord(BlobId, Record);
+}
+
+uint64 GBlobStoreImpl::GetReferenceCount(const FString& BlobId) const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    BlobRecord Record;
+    return Pimpl->GetRecord(BlobId, Record) ? Record.References : 0;
+}
+
+bool GBlobStoreImpl::AddReference(const FString& BlobId)
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    BlobRecord Record;
+    checkf(Pimpl->GetRecord(BlobId, Record),
+           TEXT("FATAL: reference to an unknown blob '%s'!"), *BlobId);
+
+    if (!Pimpl->AddReference(BlobId, Record, 0))
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to record blob reference: "), BlobId);
+        return false;
+    }
+
+    return true;
+}
+
+bool GBlobStoreImpl::Release(const FString& BlobId)
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    BlobRecord Record;
+    if (!Pimpl->GetRecord(BlobId, Record))
+    {
+        return false;
+    }
+
+    if (--Record.References > 0)
+    {
+        if (!Pimpl->References.Put(BlobId, Record))
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to record blob release: "), BlobId);
+            return false;
+        }
+
+        --Pimpl->Totals.References;
+        return false;
+    }
+
+    /// NOTE
+    /// The reference goes first and the file only once that is recorded;
+    /// a crash before the file is erased leaves an orphan, never a
+    /// reference to a missing blob
+    if (!Pimpl->References.Erase(BlobId))
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to record blob release: "), BlobId);
+        return false;
+    }
+
+    --Pimpl->Totals.References;
+    --Pimpl->Totals.Blobs;
+    Pimpl->Totals.RawBytes -= Record.RawSize;
+    Pimpl->Totals.StoredBytes -= Record.StoredSize;
+
+    const FString Path(Pimpl->GetBlobPath(BlobId));
+    if (!GFileSystemImpl::TryErase(Path, false))
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to erase released blob, left orphaned: "),
+                     BlobId);
+    }
+
+    return true;
+}
+
+GBlobStoreImpl::Stats GBlobStoreImpl::GetStats() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return Pimpl->Totals;
+}
+
+GBlobStoreImpl::Impl::Impl(const FString& InDirectory)
+    : Directory(InDirectory),
+      ObjectsDirectory(GFileSystemImpl::CombinePaths(
+                           {InDirectory, GBLOB_STORE_OBJECTS_DIRECTORY})),
+      References(GFileSystemImpl::CombinePaths(
+                     {InDirectory, GBLOB_STORE_JOURNAL_FILE}))
+{
+    Totals.Blobs = 0;
+    Totals.References = 0;
+    Totals.RawBytes = 0;
+    Totals.StoredBytes = 0;
+    Totals.DeduplicatedBytes = 0;
+
+    if (!GFileSystemImpl::DirectoryExists(Directory))
+    {
+        GFileSystemImpl::CreateDirectory(Directory);
+    }
+}
+
+FString GBlobStoreImpl::Impl::GetBlobPath(const FString& BlobId) const
+{
+    return GFileSystemImpl::CombinePaths({ObjectsDirectory,
+                                          BlobId.Left(2),
+                                          BlobId.Mid(2)
+                                          + GBLOB_STORE_BLOB_EXTENSION});
+}
+
+bool GBlobStoreImpl::Impl::GetRecord(const FString& BlobId,
+                                     BlobRecord& Out_Record) const
+{
+    return IsBlobId(BlobId) && References.Get(BlobId, Out_Record);
+}
+
+bool GBlobStoreImpl::Impl::AddReference(const FString& BlobId,
+                                        BlobRecord& Record,
+                                        const uint64 DeduplicatedSize)
+{
+    ++Record.References;
+    if (!References.Put(BlobId, Record))
+    {
+        return false;
+    }
+
+    ++Totals.References;
+    Totals.DeduplicatedBytes += DeduplicatedSize;
+
+    return true;
+}
@@ -0,0 +1,993 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Append-only journaled key-value store for high-frequency persistent state
+ */
+
+
+#include "GPersistentDataImpl/GJournalStoreImpl.h"
+
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#if defined ( __linux__ )
+#include <fcntl.h>
+#include <unistd.h>
+#endif  /* defined ( __linux__ ) */
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/crc.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GHacks/GInclude_Windows.h>
+#include <GLog/GLog.h>
+#include <GPlatformImpl/GFileSystemImpl.h>
+
+#define     GJOURNAL_STORE_ERROR_DIALOG_TITLE       "Journal Store Error"
+#define     GJOURNAL_STORE_UNKNOWN_ERROR_MESSAGE    "GJournalStore: unknown error!"
+
+#define     GJOURNAL_STORE_RECORD_HEADER_SIZE       8
+#define     GJOURNAL_STORE_PAYLOAD_HEADER_SIZE      5
+#define     GJOURNAL_STORE_COMPACT_SUFFIX           ".compact"
+
+namespace
+{
+    enum class ERecordType : uint8
+    {
+        Put,
+        Erase
+    };
+
+    struct Location
+    {
+        uint64 Offset;
+        uint64 Size;
+        uint64 ValueOffset;
+        uint64 ValueSize;
+    };
+
+    typedef std::unordered_map<std::string, Location> IndexMap;
+    typedef std::function<void(const ERecordType Type,
+                               const std::string& Key,
+                               const Location& RecordLocation,
+                               const std::string& Record)> ReplayCallback;
+
+    std::string ToKey(const FString& Key)
+    {
+        FTCHARToUTF8 Converter(*Key);
+        return std::string(Converter.Get(),
+                           static_cast<std::size_t>(Converter.Length()));
+    }
+
+    void AppendUInt32(const uint32 Value, std::string& Out_Bytes)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            Out_Bytes.push_back(static_cast<char>((Value >> (i * 8)) & 0xff));
+        }
+    }
+
+    uint32 DecodeUInt32(const char* Bytes)
+    {
+        uint32 Value = 0;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            Value |= static_cast<uint32>(static_cast<uint8>(Bytes[i]))
+                    << (i * 8);
+        }
+        return Value;
+    }
+
+    uint32 Checksum(const char* Data, const std::size_t Size)
+    {
+        boost::crc_32_type Crc;
+        Crc.process_bytes(Data, Size);
+        return static_cast<uint32>(Crc.checksum());
+    }
+
+    void EncodeRecord(const ERecordType Type, const std::string& Key,
+                      const std::string& Value, std::string& Out_Record)
+    {
+        std::string Payload;
+        Payload.reserve(GJOURNAL_STORE_PAYLOAD_HEADER_SIZE
+                        + Key.size() + Value.size());
+        Payload.push_back(static_cast<char>(Type));
+        AppendUInt32(static_cast<uint32>(Key.size()), Payload);
+        Payload += Key;
+        Payload += Value;
+
+        Out_Record.clear();
+        Out_Record.reserve(GJOURNAL_STORE_RECORD_HEADER_SIZE + Payload.size());
+        AppendUInt32(static_cast<uint32>(Payload.size()), Out_Record);
+        AppendUInt32(Checksum(Payload.data(), Payload.size()), Out_Record);
+        Out_Record += Payload;
+    }
+
+    /// NOTE
+    /// Walks the records in [Offset, End) and returns where the last valid
+    /// one ends; anything after that is a torn or corrupt tail
+    uint64 Replay(std::istream& Stream, uint64 Offset, const uint64 End,
+                  const ReplayCallback& Callback)
+    {
+        Stream.clear();
+        Stream.seekg(static_cast<std::streamoff>(Offset), std::ios::beg);
+
+        std::string Record;
+
+        while (End - Offset >= GJOURNAL_STORE_RECORD_HEADER_SIZE)
+        {
+            char Header[GJOURNAL_STORE_RECORD_HEADER_SIZE];
+            if (!Stream.read(Header, sizeof(Header)))
+            {
+                break;
+            }
+
+            const uint64 PayloadSize = DecodeUInt32(Header);
+            if (PayloadSize < GJOURNAL_STORE_PAYLOAD_HEADER_SIZE
+                    || PayloadSize > End - Offset
+                    - GJOURNAL_STORE_RECORD_HEADER_SIZE)
+            {
+                break;
+            }
+
+            Record.assign(Header, sizeof(Header));
+            Record.resize(static_cast<std::size_t>(
+                              GJOURNAL_STORE_RECORD_HEADER_SIZE
+                              + PayloadSize));
+            if (!Stream.read(&Record[GJOURNAL_STORE_RECORD_HEADER_SIZE],
+                             static_cast<std::streamsize>(PayloadSize)))
+            {
+                break;
+            }
+
+            const char* const Payload =
+                    Record.data() + GJOURNAL_STORE_RECORD_HEADER_SIZE;
+            if (Checksum(Payload, static_cast<std::size_t>(PayloadSize))
+                    != DecodeUInt32(Header + 4))
+            {
+                break;
+            }
+
+            const uint8 Type = static_cast<uint8>(Payload[0]);
+            const uint64 KeySize = DecodeUInt32(Payload + 1);
+            if (Type > static_cast<uint8>(ERecordType::Erase)
+                    || KeySize > PayloadSize
+                    - GJOURNAL_STORE_PAYLOAD_HEADER_SIZE)
+            {
+                break;
+            }
+
+            Location RecordLocation;
+            RecordLocation.Offset = Offset;
+            RecordLocation.Size = Record.size();
+            RecordLocation.ValueOffset = GJOURNAL_STORE_RECORD_HEADER_SIZE
+                    + GJOURNAL_STORE_PAYLOAD_HEADER_SIZE + KeySize;
+            RecordLocation.ValueSize = PayloadSize
+                    - GJOURNAL_STORE_PAYLOAD_HEADER_SIZE - KeySize;
+
+            Callback(static_cast<ERecordType>(Type),
+                     std::string(Payload + GJOURNAL_STORE_PAYLOAD_HEADER_SIZE,
+                                 static_cast<std::size_t>(KeySize)),
+                     RecordLocation, Record);
+
+            Offset += RecordLocation.Size;
+        }
+
+        return Offset;
+    }
+
+    /// NOTE
+    /// Forces a file down to the disk; for a directory it makes the
+    /// entries renamed into it durable, which only POSIX needs
+    bool SyncPath(const std::string& Path, const bool bDirectory)
+    {
+#if defined ( __linux__ )
+        const int Descriptor = open(Path.empty() ? "." : Path.c_str(),
+                                    (bDirectory ? O_RDONLY | O_DIRECTORY
+                                                : O_RDWR) | O_CLOEXEC);
+        if (Descriptor < 0)
+        {
+            return false;
+        }
+
+        const bool bSynced = fsync(Descriptor) == 0;
+        close(Descriptor);
+
+        return bSynced;
+#elif defined ( _WIN32 ) || defined ( _WIN64 )
+        if (bDirectory)
+        {
+            return true;
+        }
+
+        const HANDLE Handle = CreateFileA(Path.c_str(), GENERIC_WRITE,
+                                          FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                          NULL, OPEN_EXISTING,
+                                          FILE_ATTRIBUTE_NORMAL, NULL);
+        if (Handle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        const bool bSynced = FlushFileBuffers(Handle) != FALSE;
+        CloseHandle(Handle);
+
+        return bSynced;
+#else
+        (void)Path;
+        (void)bDirectory;
+
+        return true;
+#endif  /* defined ( __linux__ ) */
+    }
+}
+
+struct GJournalStoreImpl::Impl
+{
+public:
+    const FString FilePath;
+    const FString CompactPath;
+    const Settings StoreSettings;
+
+    mutable std::mutex Lock;
+    std::condition_variable Condition;
+
+    mutable std::fstream File;
+    IndexMap Index;
+    uint64 JournalSize;
+    uint64 DeadBytes;
+    uint64 Compactions;
+    uint64 DiscardedBytes;
+
+    bool bOpen;
+    bool bCompactionRequested;
+    bool bCompacting;
+    bool bStopping;
+    std::thread Thread;
+
+public:
+    Impl(const FString& InFilePath, const Settings& InSettings);
+    ~Impl();
+
+public:
+    void OpenFile();
+    bool ReopenFile();
+    void DiscardCompactFile() const;
+    void Apply(IndexMap& InOut_Index, uint64& InOut_DeadBytes,
+               const ERecordType Type, const std::string& Key,
+               const Location& RecordLocation) const;
+    bool Append(const ERecordType Type, const std::string& Key,
+                const std::string& Value);
+    bool ShouldCompact() const;
+
+    void Run();
+    void Compact();
+};
+
+GJournalStoreImpl::GJournalStoreImpl(const FString& FilePath,
+                                     const Settings& InSettings)
+    : Pimpl(std::make_unique<GJournalStoreImpl::Impl>(FilePath, InSettings))
+{
+
+}
+
+GJournalStoreImpl::~GJournalStoreImpl() = default;
+
+void GJournalStoreImpl::Open()
+{
+    try
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        checkf(!Pimpl->bOpen, TEXT("FATAL: journal store opened twice!"));
+
+        Pimpl->Index.clear();
+        Pimpl->JournalSize = 0;
+        Pimpl->DeadBytes = 0;
+        Pimpl->DiscardedBytes = 0;
+
+        if (GFileSystemImpl::FileExists(Pimpl->FilePath))
+        {
+            const uint64 FileSize = static_cast<uint64>(
+                        GFileSystemImpl::GetFileSize(Pimpl->FilePath));
+
+            std::ifstream Reader(StringCast<ANSICHAR>(
+                                     *Pimpl->FilePath).Get(),
+                                 std::ios::in | std::ios::binary);
+
+            const uint64 ValidSize = Replay(
+                        Reader, 0, FileSize,
+                        [this](const ERecordType Type, const std::string& Key,
+                        const Location& RecordLocation,
+                        const std::string& Record)
+            {
+                (void)Record;
+                Pimpl->Apply(Pimpl->Index, Pimpl->DeadBytes, Type, Key,
+                             RecordLocation);
+            });
+
+            Reader.close();
+
+            if (ValidSize < FileSize)
+            {
+                Pimpl->DiscardedBytes = FileSize - ValidSize;
+
+                GLOG_WARNING(GLOG_KEY_GENERIC,
+                             TEXT("Journal recovered, discarded a torn tail"
+                                  " of "), Pimpl->DiscardedBytes,
+                             TEXT(" bytes: "), Pimpl->FilePath);
+
+                boost::filesystem::resize_file(
+                            boost::filesystem::path(
+                                StringCast<ANSICHAR>(
+                                    *Pimpl->FilePath).Get()),
+                            ValidSize);
+            }
+
+            Pimpl->JournalSize = ValidSize;
+        }
+
+        Pimpl->OpenFile();
+        Pimpl->bOpen = true;
+
+        if (Pimpl->StoreSettings.bBackgroundCompaction)
+        {
+            Pimpl->Thread = std::thread(&GJournalStoreImpl::Impl::Run,
+                                        Pimpl.get());
+        }
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GJOURNAL_STORE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GJOURNAL_STORE_UNKNOWN_ERROR_MESSAGE,
+                    GJOURNAL_STORE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GJOURNAL_STORE_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+}
+
+bool GJournalStoreImpl::PutRaw(const FString& Key, const std::string& Value)
+{
+    return Pimpl->Append(ERecordType::Put, ToKey(Key), Value);
+}
+
+bool GJournalStoreImpl::GetRaw(const FString& Key,
+                               std::string& Out_Value) const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    const auto It = Pimpl->Index.find(ToKey(Key));
+    if (It == Pimpl->Index.end())
+    {
+        return false;
+    }
+
+    const Location& ValueLocation = It->second;
+
+    try
+    {
+        if (!Pimpl->File.is_open() && !Pimpl->ReopenFile())
+        {
+            return false;
+        }
+
+        Out_Value.resize(static_cast<std::size_t>(ValueLocation.ValueSize));
+
+        Pimpl->File.seekg(static_cast<std::streamoff>(
+                              ValueLocation.Offset
+                              + ValueLocation.ValueOffset),
+                          std::ios::beg);
+        Pimpl->File.read(&Out_Value[0],
+                         static_cast<std::streamsize>(
+                             ValueLocation.ValueSize));
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        Pimpl->File.clear();
+        Out_Value.clear();
+
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to read from journal: "),
+                     Pimpl->FilePath, TEXT(", "), Exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool GJournalStoreImpl::Contains(const FString& Key) const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return Pimpl->Index.find(ToKey(Key)) != Pimpl->Index.end();
+}
+
+void GJournalStoreImpl::GetKeys(std::vector<FString>& Out_Keys) const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    Out_Keys.clear();
+    Out_Keys.reserve(Pimpl->Index.size());
+
+    for (const auto& Entry : Pimpl->Index)
+    {
+        Out_Keys.emplace_back(UTF8_TO_TCHAR(Entry.first.c_str()));
+    }
+}
+
+bool GJournalStoreImpl::Erase(const FString& Key)
+{
+    const std::string RecordKey(ToKey(Key));
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        if (Pimpl->Index.find(RecordKey) == Pimpl->Index.end())
+        {
+            return true;
+        }
+    }
+
+    return Pimpl->Append(ERecordType::Erase, RecordKey, std::string());
+}
+
+bool GJournalStoreImpl::Flush()
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    try
+    {
+        if (Pimpl->File.is_open())
+        {
+            Pimpl->File.flush();
+        }
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        Pimpl->File.clear();
+
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to flush journal: "),
+                     Pimpl->FilePath, TEXT(", "), Exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+void GJournalStoreImpl::Compact()
+{
+    {
+        std::unique_lock<std::mutex> UniqueLock(Pimpl->Lock);
+
+        Pimpl->Condition.wait(UniqueLock, [this]() {
+            return !Pimpl->bCompacting;
+        });
+
+        Pimpl->bCompacting = true;
+    }
+
+    Pimpl->Compact();
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        Pimpl->bCompacting = false;
+    }
+
+    Pimpl->Condition.notify_all();
+}
+
+GJournalStoreImpl::Stats GJournalStoreImpl::GetStats() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    Stats Result;
+    Result.Keys = static_cast<uint64>(Pimpl->Index.size());
+    Result.JournalSize = Pimpl->JournalSize;
+    Result.DeadBytes = Pimpl->DeadBytes;
+    Result.Compactions = Pimpl->Compactions;
+    Result.DiscardedBytes = Pimpl->DiscardedBytes;
+
+    return Result;
+}
+
+GJournalStoreImpl::Impl::Impl(const FString& InFilePath,
+                              const Settings& InSettings)
+    : FilePath(InFilePath),
+      CompactPath(InFilePath + TEXT(GJOURNAL_STORE_COMPACT_SUFFIX)),
+      StoreSettings(InSettings),
+      JournalSize(0),
+      DeadBytes(0),
+      Compactions(0),
+      DiscardedBytes(0),
+      bOpen(false),
+      bCompactionRequested(false),
+      bCompacting(false),
+      bStopping(false)
+{
+
+}
+
+GJournalStoreImpl::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        bStopping = true;
+    }
+
+    Condition.notify_all();
+
+    if (Thread.joinable())
+    {
+        Thread.join();
+    }
+
+    if (File.is_open())
+    {
+        try
+        {
+            File.flush();
+            File.close();
+        }
+
+        catch (const std::ios_base::failure& Exception)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to close journal: "),
+                         FilePath, TEXT(", "), Exception.what());
+        }
+    }
+}
+
+void GJournalStoreImpl::Impl::OpenFile()
+{
+    if (!GFileSystemImpl::FileExists(FilePath))
+    {
+        std::ofstream Create(StringCast<ANSICHAR>(*FilePath).Get(),
+                             std::ios::out | std::ios::binary);
+    }
+
+    File.open(StringCast<ANSICHAR>(*FilePath).Get(),
+              std::ios::in | std::ios::out | std::ios::binary);
+    File.exceptions(std::fstream::failbit | std::fstream::badbit);
+}
+
+bool GJournalStoreImpl::Impl::ReopenFile()
+{
+    try
+    {
+        if (File.is_open())
+        {
+            File.close();
+        }
+
+        File.clear();
+        OpenFile();
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        File.clear();
+
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to reopen journal: "),
+                     FilePath, TEXT(", "), Exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+void GJournalStoreImpl::Impl::DiscardCompactFile() const
+{
+    boost::system::error_code ErrorCode;
+    boost::filesystem::remove(StringCast<ANSICHAR>(*CompactPath).Get(),
+                              ErrorCode);
+}
+
+void GJournalStoreImpl::Impl::Apply(IndexMap& InOut_Index,
+                                    uint64& InOut_DeadBytes,
+                                    const ERecordType Type,
+                                    const std::string& Key,
+                                    const Location& RecordLocation) const
+{
+    const auto It = InOut_Index.find(Key);
+
+    if (It != InOut_Index.end())
+    {
+        InOut_DeadBytes += It->second.Size;
+    }
+
+    if (Type == ERecordType::Put)
+    {
+        InOut_Index[Key] = RecordLocation;
+    }
+    else
+    {
+        /// NOTE
+        /// A tombstone is dead weight the moment it is written, compaction
+        /// drops it along with what it erased
+        InOut_DeadBytes += RecordLocation.Size;
+
+        if (It != InOut_Index.end())
+        {
+            InOut_Index.erase(It);
+        }
+    }
+}
+
+bool GJournalStoreImpl::Impl::Append(const ERecordType Type,
+                                     const std::string& Key,
+                                     const std::string& Value)
+{
+    std::string Record;
+    EncodeRecord(Type, Key, Value, Record);
+
+    bool bCompact = false;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        checkf(bOpen, TEXT("FATAL: journal store used before Open()!"));
+
+        Location RecordLocation;
+        RecordLocation.Offset = JournalSize;
+        RecordLocation.Size = Record.size();
+        RecordLocation.ValueOffset = GJOURNAL_STORE_RECORD_HEADER_SIZE
+                + GJOURNAL_STORE_PAYLOAD_HEADER_SIZE + Key.size();
+        RecordLocation.ValueSize = Value.size();
+
+        /// NOTE
+        /// A failed write leaves the index as it was; whatever part of the
+        /// record reached the file sits past JournalSize, where the next
+        /// append overwrites it and replay cuts it off
+        try
+        {
+            if (!File.is_open() && !ReopenFile())
+            {
+                return false;
+            }
+
+            File.seekp(static_cast<std::streamoff>(JournalSize),
+                       std::ios::beg);
+            File.write(Record.data(),
+                       static_cast<std::streamsize>(Record.size()));
+        }
+
+        catch (const std::ios_base::failure& Exception)
+        {
+            File.clear();
+
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to append to journal: "),
+                         FilePath, TEXT(", "), Exception.what());
+            return false;
+        }
+
+        JournalSize += Record.size();
+
+        Apply(Index, DeadBytes, Type, Key, RecordLocation);
+
+        if (StoreSettings.bBackgroundCompaction && !bCompacting
+                && !bCompactionRequested && ShouldCompact())
+        {
+            bCompactionRequested = true;
+            bCompact = true;
+        }
+    }
+
+    if (bCompact)
+    {
+        Condition.notify_all();
+    }
+
+    return true;
+}
+
+bool GJournalStoreImpl::Impl::ShouldCompact() const
+{
+    return DeadBytes >= StoreSettings.CompactionMinDeadBytes
+            && DeadBytes * 100
+            >= JournalSize * static_cast<uint64>(
+                StoreSettings.DeadRatioPercent);
+}
+
+void GJournalStoreImpl::Impl::Run()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> UniqueLock(Lock);
+
+            Condition.wait(UniqueLock, [this]() {
+                return bStopping || (bCompactionRequested && !bCompacting);
+            });
+
+            if (bStopping)
+            {
+                break;
+            }
+
+            bCompactionRequested = false;
+            bCompacting = true;
+        }
+
+        Compact();
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            bCompacting = false;
+        }
+
+        Condition.notify_all();
+    }
+}
+
+void GJournalStoreImpl::Impl::Compact()
+{
+    try
+    {
+        IndexMap Snapshot;
+        uint64 SnapshotEnd = 0;
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            if (!bOpen)
+            {
+                return;
+            }
+
+            File.flush();
+            Snapshot = Index;
+            SnapshotEnd = JournalSize;
+        }
+
+        /// NOTE
+        /// Everything before SnapshotEnd is immutable, so live records are
+        /// copied without holding the lock; writers keep appending
+        std::ifstream Reader(StringCast<ANSICHAR>(*FilePath).Get(),
+                             std::ios::in | std::ios::binary);
+        Reader.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+        std::ofstream Writer(StringCast<ANSICHAR>(*CompactPath).Get(),
+                             std::ios::out | std::ios::binary
+                             | std::ios::trunc);
+        Writer.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+        IndexMap Compacted;
+        Compacted.reserve(Snapshot.size());
+        uint64 CompactedSize = 0;
+        std::string Record;
+
+        for (const auto& Entry : Snapshot)
+        {
+            Record.resize(static_cast<std::size_t>(Entry.second.Size));
+            Reader.seekg(static_cast<std::streamoff>(Entry.second.Offset),
+                         std::ios::beg);
+            Reader.read(&Record[0],
+                        static_cast<std::streamsize>(Record.size()));
+            Writer.write(Record.data(),
+                         static_cast<std::streamsize>(Record.size()));
+
+            Location NewLocation(Entry.second);
+            NewLocation.Offset = CompactedSize;
+            Compacted.emplace(Entry.first, NewLocation);
+
+            CompactedSize += Record.size();
+        }
+
+        /// NOTE
+        /// The compacted journal has to be on the disk before it replaces
+        /// the original, otherwise a crash right after the rename could
+        /// leave an empty or partial journal behind. The bulk of it is
+        /// synced here, without the lock, so the sync under it only has
+        /// the tail left to write out.
+        Writer.flush();
+        if (!SyncPath(StringCast<ANSICHAR>(*CompactPath).Get(), false))
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to sync compacted journal, keeping"
+                              " the original: "), FilePath);
+            Writer.close();
+            DiscardCompactFile();
+            return;
+        }
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        File.flush();
+
+        /// NOTE
+        /// Records appended meanwhile are carried over as they are,
+        /// tombstones included since the compacted journal may still hold
+        /// what they erased
+        uint64 CompactedDeadBytes = 0;
+
+        Reader.exceptions(std::ifstream::goodbit);
+        const uint64 TailEnd = Replay(
+                    Reader, SnapshotEnd, JournalSize,
+                    [&](const ERecordType Type, const std::string& Key,
+                    const Location& RecordLocation,
+                    const std::string& TailRecord)
+        {
+            Location NewLocation(RecordLocation);
+            NewLocation.Offset = CompactedSize;
+
+            Writer.write(TailRecord.data(),
+                         static_cast<std::streamsize>(TailRecord.size()));
+            CompactedSize += TailRecord.size();
+
+            Apply(Compacted, CompactedDeadBytes, Type, Key, NewLocation);
+        });
+
+        Reader.close();
+        Writer.close();
+
+        /// NOTE
+        /// Every record appended since the snapshot was acknowledged to its
+        /// writer, dropping one that fails to read back would lose it
+        if (TailEnd != JournalSize)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to carry over the journal tail, keeping"
+                              " the original: "), FilePath);
+            DiscardCompactFile();
+            return;
+        }
+
+        if (!SyncPath(StringCast<ANSICHAR>(*CompactPath).Get(), false))
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to sync compacted journal, keeping"
+                              " the original: "), FilePath);
+            DiscardCompactFile();
+            return;
+        }
+
+        File.close();
+
+        const boost::filesystem::path Target(
+                    StringCast<ANSICHAR>(*FilePath).Get());
+
+        boost::system::error_code ErrorCode;
+        boost::filesystem::rename(StringCast<ANSICHAR>(*CompactPath).Get(),
+                                  Target, ErrorCode);
+        if (ErrorCode)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to move compacted journal into place,"
+                              " keeping the original: "),
+                         FilePath, TEXT(", "), ErrorCode.message().c_str());
+            DiscardCompactFile();
+            (void)ReopenFile();
+            return;
+        }
+
+        (void)SyncPath(Target.parent_path().string(), true);
+
+        Index.swap(Compacted);
+        JournalSize = CompactedSize;
+        DeadBytes = CompactedDeadBytes;
+        ++Compactions;
+
+        /// NOTE
+        /// Should this fail, the next access retries it
+        (void)ReopenFile();
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Journal compaction failed, keeping the"
+                          " original: "), FilePath, TEXT(", "),
+                     Exception.what());
+
+        DiscardCompactFile();
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        if (!File.is_open())
+        {
+            (void)ReopenFile();
+        }
+        else
+        {
+            File.clear();
+        }
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GJOURNAL_STORE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GJOURNAL_STORE_UNKNOWN_ERROR_MESSAGE,
+                    GJOURNAL_STORE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GJOURNAL_STORE_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+}
@@ -0,0 +1,718 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Single-pass, compressed and signed save files
+ */
+
+
+#include "GPersistentDataImpl/GSavePipelineImpl.h"
+
+#include <algorithm>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include <cstring>
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/operations.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GCompressionImpl/GCompressionImpl.h>
+#include <GCryptoImpl/GCryptoImpl.h>
+#include <GHacks/GInclude_Windows.h>
+#include <GLog/GLog.h>
+#include <GPlatformImpl/GFileSystemImpl.h>
+#include <GTypes/GCompressionTypes.h>
+#include <GTypes/GCryptoTypes.h>
+
+#define     GSAVE_PIPELINE_ERROR_DIALOG_TITLE       "Save Pipeline Error"
+#define     GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE    "GSavePipeline: unknown error!"
+
+#define     GSAVE_PIPELINE_CHUNK_SIZE               (64 * 1024)
+#define     GSAVE_PIPELINE_HEADER_SIZE              8
+#define     GSAVE_PIPELINE_SIZES_SIZE               16
+#define     GSAVE_PIPELINE_FRAME_HEADER_SIZE        4
+
+const uint16 GSavePipelineImpl::FormatVersion = 2;
+
+namespace
+{
+    const char Magic[4] = { 'G', 'S', 'A', 'V' };
+    const EGCompressionAlgorithm Algorithm = EGCompressionAlgorithm::Zlib;
+
+    void EncodeUInt64(const uint64 Value, GCryptoByte* Out_Bytes)
+    {
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            Out_Bytes[i] = static_cast<GCryptoByte>((Value >> (i * 8)) & 0xff);
+        }
+    }
+
+    uint64 DecodeUInt64(const GCryptoByte* Bytes)
+    {
+        uint64 Value = 0;
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            Value |= static_cast<uint64>(Bytes[i]) << (i * 8);
+        }
+        return Value;
+    }
+
+    void MakeHeader(GCryptoByte* Out_Header)
+    {
+        std::memcpy(Out_Header, Magic, sizeof(Magic));
+        Out_Header[4] = static_cast<GCryptoByte>(
+                    GSavePipelineImpl::FormatVersion & 0xff);
+        Out_Header[5] = static_cast<GCryptoByte>(
+                    (GSavePipelineImpl::FormatVersion >> 8) & 0xff);
+        Out_Header[6] = static_cast<GCryptoByte>(Algorithm);
+        Out_Header[7] = 0;
+    }
+
+    void EncodeUInt32(const uint32 Value, GCryptoByte* Out_Bytes)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            Out_Bytes[i] = static_cast<GCryptoByte>((Value >> (i * 8)) & 0xff);
+        }
+    }
+
+    uint32 DecodeUInt32(const GCryptoByte* Bytes)
+    {
+        uint32 Value = 0;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            Value |= static_cast<uint32>(Bytes[i]) << (i * 8);
+        }
+        return Value;
+    }
+
+    /// NOTE
+    /// Cuts the compressed payload into frames and signs each of them,
+    /// chained to the MAC before it, holding at most one frame in memory
+    class FrameWriter
+    {
+    private:
+        std::ofstream& File;
+        GCryptoImpl::Signer Signer;
+        GCryptoBuffer Chain;
+        std::vector<char> Frame;
+        uint64 PayloadSize;
+
+    public:
+        FrameWriter(std::ofstream& InFile, const GCryptoImpl& Crypto,
+                    const GCryptoByte* Header)
+            : File(InFile),
+              Signer(Crypto.CreateSigner()),
+              Chain(Header, Header + GSAVE_PIPELINE_HEADER_SIZE),
+              PayloadSize(0)
+        {
+            Frame.reserve(GSAVE_PIPELINE_CHUNK_SIZE);
+        }
+
+        void Write(const char* Data, uint64 Length)
+        {
+            while (Length > 0)
+            {
+                const std::size_t Count = static_cast<std::size_t>(
+                            std::min<uint64>(Length,
+                                             GSAVE_PIPELINE_CHUNK_SIZE
+                                             - Frame.size()));
+                Frame.insert(Frame.end(), Data, Data + Count);
+                Data += Count;
+                Length -= Count;
+
+                if (Frame.size() == GSAVE_PIPELINE_CHUNK_SIZE)
+                {
+                    FlushFrame();
+                }
+            }
+        }
+
+        void Finish(const uint64 ArchiveSize)
+        {
+            if (!Frame.empty())
+            {
+                FlushFrame();
+            }
+
+            GCryptoByte Sizes[GSAVE_PIPELINE_SIZES_SIZE];
+            EncodeUInt64(ArchiveSize, Sizes);
+            EncodeUInt64(PayloadSize, Sizes + 8);
+
+            Seal(reinterpret_cast<const char*>(Sizes), sizeof(Sizes), true);
+        }
+
+    private:
+        void FlushFrame()
+        {
+            PayloadSize += Frame.size();
+            Seal(Frame.data(), Frame.size(), false);
+            Frame.clear();
+        }
+
+        /// NOTE
+        /// An empty frame is the trailer, which carries the sizes in
+        /// place of data
+        void Seal(const char* Data, const std::size_t Length,
+                  const bool bTrailer)
+        {
+            GCryptoByte FrameHeader[GSAVE_PIPELINE_FRAME_HEADER_SIZE];
+            EncodeUInt32(bTrailer ? 0 : static_cast<uint32>(Length),
+                         FrameHeader);
+
+            Signer.Update(&Chain[0], Chain.size());
+            Signer.Update(FrameHeader, sizeof(FrameHeader));
+            Signer.Update(reinterpret_cast<const GCryptoByte*>(Data),
+                          Length);
+            Signer.Final(Chain);
+
+            File.write(reinterpret_cast<const char*>(FrameHeader),
+                       sizeof(FrameHeader));
+            File.write(Data, static_cast<std::streamsize>(Length));
+            File.write(reinterpret_cast<const char*>(&Chain[0]),
+                       static_cast<std::streamsize>(Chain.size()));
+        }
+    };
+
+    /// NOTE
+    /// Reads frames back one at a time and hands out only those whose MAC
+    /// checks out, so nothing unverified ever gets decompressed. Fails for
+    /// good at the first bad, reordered or missing frame.
+    class FrameReader
+    {
+    private:
+        std::ifstream& File;
+        GCryptoImpl::Signer Signer;
+        GCryptoBuffer Chain;
+        GCryptoBuffer MAC;
+        uint64 PayloadSize;
+        uint64 ArchiveSize;
+        bool bFailed;
+        bool bDone;
+
+    public:
+        FrameReader(std::ifstream& InFile, const GCryptoImpl& Crypto,
+                    const GCryptoByte* Header)
+            : File(InFile),
+              Signer(Crypto.CreateSigner()),
+              Chain(Header, Header + GSAVE_PIPELINE_HEADER_SIZE),
+              MAC(static_cast<std::size_t>(
+                      GCryptoImpl::Signer::GetMACSize())),
+              PayloadSize(0),
+              ArchiveSize(0),
+              bFailed(false),
+              bDone(false)
+        {
+
+        }
+
+        bool IsDone() const
+        {
+            return bDone;
+        }
+
+        bool IsFailed() const
+        {
+            return bFailed;
+        }
+
+        uint64 GetArchiveSize() const
+        {
+            return ArchiveSize;
+        }
+
+        /// NOTE
+        /// Fills Out_Frame with the next verified frame, leaves it empty
+        /// once the verified trailer was read, returns false on failure
+        bool Next(std::vector<char>& Out_Frame)
+        {
+            Out_Frame.clear();
+
+            if (bFailed || bDone)
+            {
+                return !bFailed;
+            }
+
+            bFailed = true;
+
+            GCryptoByte FrameHeader[GSAVE_PIPELINE_FRAME_HEADER_SIZE];
+            if (!File.read(reinterpret_cast<char*>(FrameHeader),
+                           sizeof(FrameHeader)))
+            {
+                return false;
+            }
+
+            const uint32 Length = DecodeUInt32(FrameHeader);
+            const bool bTrailer = Length == 0;
+            if (Length > GSAVE_PIPELINE_CHUNK_SIZE)
+            {
+                return false;
+            }
+
+            Out_Frame.resize(bTrailer ? GSAVE_PIPELINE_SIZES_SIZE : Length);
+            if (!File.read(Out_Frame.data(),
+                           static_cast<std::streamsize>(Out_Frame.size()))
+                    || !File.read(reinterpret_cast<char*>(&MAC[0]),
+                                  static_cast<std::streamsize>(MAC.size())))
+            {
+                Out_Frame.clear();
+                return false;
+            }
+
+            Signer.Update(&Chain[0], Chain.size());
+            Signer.Update(FrameHeader, sizeof(FrameHeader));
+            Signer.Update(reinterpret_cast<const GCryptoByte*>(
+                              Out_Frame.data()), Out_Frame.size());
+            if (!Signer.Verify(&MAC[0], MAC.size()))
+            {
+                Out_Frame.clear();
+                return false;
+            }
+
+            Chain = MAC;
+
+            if (bTrailer)
+            {
+                const GCryptoByte* const Sizes =
+                        reinterpret_cast<const GCryptoByte*>(
+                            Out_Frame.data());
+                ArchiveSize = DecodeUInt64(Sizes);
+                Out_Frame.clear();
+
+                /// NOTE
+                /// Nothing may follow the trailer
+                if (DecodeUInt64(Sizes + 8) != PayloadSize
+                        || File.peek() != std::ifstream::traits_type::eof())
+                {
+                    return false;
+                }
+
+                bDone = true;
+            }
+            else
+            {
+                PayloadSize += Length;
+            }
+
+            bFailed = false;
+            return true;
+        }
+    };
+
+    /// NOTE
+    /// Collects what the archive writes into fixed-size chunks and hands
+    /// every full chunk to the compressor
+    class CompressingBuffer : public std::streambuf
+    {
+    private:
+        GCompressionImpl::Stream& Compressor;
+        std::vector<char> Buffer;
+        uint64 BytesWritten;
+
+    public:
+        explicit CompressingBuffer(GCompressionImpl::Stream& InCompressor)
+            : Compressor(InCompressor),
+              Buffer(GSAVE_PIPELINE_CHUNK_SIZE),
+              BytesWritten(0)
+        {
+            setp(Buffer.data(), Buffer.data() + Buffer.size());
+        }
+
+        uint64 GetBytesWritten() const
+        {
+            return BytesWritten;
+        }
+
+    protected:
+        int_type overflow(int_type Character) override
+        {
+            FlushChunk();
+
+            if (!traits_type::eq_int_type(Character, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(Character);
+                pbump(1);
+            }
+
+            return traits_type::not_eof(Character);
+        }
+
+        int sync() override
+        {
+            FlushChunk();
+            return 0;
+        }
+
+    private:
+        void FlushChunk()
+        {
+            const std::ptrdiff_t Length = pptr() - pbase();
+            if (Length > 0)
+            {
+                Compressor.Write(pbase(), static_cast<uint64>(Length));
+                BytesWritten += static_cast<uint64>(Length);
+            }
+            setp(Buffer.data(), Buffer.data() + Buffer.size());
+        }
+    };
+
+    /// NOTE
+    /// Pulls verified frames and serves the archive whatever the
+    /// decompressor produced from them, one frame's worth at a time
+    class DecompressingBuffer : public std::streambuf
+    {
+    private:
+        FrameReader& Reader;
+        std::vector<char> Frame;
+        uint64 BytesProduced;
+        std::vector<char> Pending;
+        GCompressionImpl::Stream Decompressor;
+
+    public:
+        explicit DecompressingBuffer(FrameReader& InReader)
+            : Reader(InReader),
+              BytesProduced(0),
+              Decompressor(GCompressionImpl::CreateDecompressor(
+                               [this](const GCompressionByte* Data,
+                                      const uint64 Length)
+                               {
+                                   BytesProduced += Length;
+                                   Pending.insert(Pending.end(),
+                                                  Data, Data + Length);
+                               }, Algorithm))
+        {
+            setg(nullptr, nullptr, nullptr);
+        }
+
+        /// NOTE
+        /// Decodes the first frame ahead, so a file that fails right away
+        /// is rejected before the archive reads anything
+        bool Prime()
+        {
+            while (Pending.empty() && !Reader.IsDone() && !Reader.IsFailed())
+            {
+                DecompressFrame();
+            }
+
+            if (!Pending.empty())
+            {
+                setg(Pending.data(), Pending.data(),
+                     Pending.data() + Pending.size());
+            }
+
+            return !Reader.IsFailed();
+        }
+
+        /// NOTE
+        /// Verifies and decompresses whatever the archive left unread,
+        /// true if every frame checked out and the payload decodes to
+        /// exactly the archive size in the trailer
+        bool Finish()
+        {
+            while (!Reader.IsDone() && !Reader.IsFailed())
+            {
+                Pending.clear();
+                DecompressFrame();
+            }
+
+            Pending.clear();
+            setg(nullptr, nullptr, nullptr);
+
+            return Reader.IsDone() && !Reader.IsFailed()
+                    && BytesProduced == Reader.GetArchiveSize();
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            Pending.clear();
+
+            while (Pending.empty() && !Reader.IsDone() && !Reader.IsFailed())
+            {
+                DecompressFrame();
+            }
+
+            if (Pending.empty())
+            {
+                return traits_type::eof();
+            }
+
+            setg(Pending.data(), Pending.data(),
+                 Pending.data() + Pending.size());
+
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        void DecompressFrame()
+        {
+            if (!Reader.Next(Frame))
+            {
+                return;
+            }
+
+            if (Reader.IsDone())
+            {
+                Decompressor.Finish();
+                return;
+            }
+
+            Decompressor.Write(Frame.data(), Frame.size());
+        }
+    };
+}
+
+bool GSavePipelineImpl::SaveStream(const FString& FilePath,
+                                   const GCryptoImpl& Crypto,
+                                   const Serializer& Callback)
+{
+    const FString TemporaryPath(GFileSystemImpl::MakeTemporaryPath(FilePath));
+
+    try
+    {
+        {
+            std::ofstream File(StringCast<ANSICHAR>(*TemporaryPath).Get(),
+                               std::ios::out | std::ios::binary
+                               | std::ios::trunc);
+            File.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+            GCryptoByte Header[GSAVE_PIPELINE_HEADER_SIZE];
+            MakeHeader(Header);
+            File.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+
+            FrameWriter Writer(File, Crypto, Header);
+
+            GCompressionImpl::Stream Compressor(
+                        GCompressionImpl::CreateCompressor(
+                            [&](const GCompressionByte* Data,
+                            const uint64 Length)
+            {
+                Writer.Write(Data, Length);
+            }, Algorithm));
+
+            CompressingBuffer Buffer(Compressor);
+
+            {
+                /// NOTE
+                /// Hand a failing sink back to us instead of leaving the
+                /// stream quietly bad
+                std::ostream Stream(&Buffer);
+                Stream.exceptions(std::ios::badbit);
+                Callback(Stream);
+                Stream.flush();
+            }
+
+            Buffer.pubsync();
+            Compressor.Finish();
+
+            Writer.Finish(Buffer.GetBytesWritten());
+            File.close();
+        }
+
+        if (GFileSystemImpl::CommitTemporary(TemporaryPath, FilePath))
+        {
+            return true;
+        }
+
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to move save file into place: "),
+                     FilePath);
+        return false;
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to write save file: "),
+                     FilePath, TEXT(", "), Exception.what());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GSAVE_PIPELINE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE,
+                    GSAVE_PIPELINE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+
+    /// NOTE
+    /// Whatever got written is useless without its trailer
+    boost::system::error_code ErrorCode;
+    boost::filesystem::remove(StringCast<ANSICHAR>(*TemporaryPath).Get(),
+                              ErrorCode);
+
+    return false;
+}
+
+bool GSavePipelineImpl::LoadStream(const FString& FilePath,
+                                   const GCryptoImpl& Crypto,
+                                   const Deserializer& Callback)
+{
+    if (!GFileSystemImpl::FileExists(FilePath))
+    {
+        return false;
+    }
+
+    try
+    {
+        std::ifstream File(StringCast<ANSICHAR>(*FilePath).Get(),
+                           std::ios::in | std::ios::binary);
+        if (!File)
+        {
+            return false;
+        }
+
+        GCryptoByte Header[GSAVE_PIPELINE_HEADER_SIZE];
+        GCryptoByte Expected[GSAVE_PIPELINE_HEADER_SIZE];
+        MakeHeader(Expected);
+
+        FrameReader Reader(File, Crypto, Expected);
+        DecompressingBuffer Buffer(Reader);
+
+        if (!File.read(reinterpret_cast<char*>(Header), sizeof(Header))
+                || std::memcmp(Header, Expected, sizeof(Header)) != 0
+                || !Buffer.Prime())
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Rejected save file, verification failed: "),
+                         FilePath);
+            return false;
+        }
+
+        {
+            std::istream Stream(&Buffer);
+            Callback(Stream);
+        }
+
+        if (!Buffer.Finish())
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Rejected save file, verification failed: "),
+                         FilePath);
+            return false;
+        }
+
+        return true;
+    }
+
+    catch (const cereal::Exception& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to deserialize save file: "),
+                     FilePath, TEXT(", "), Exception.what());
+        return false;
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to read save file: "),
+                     FilePath, TEXT(", "), Exception.what());
+        return false;
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GSAVE_PIPELINE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE,
+                    GSAVE_PIPELINE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+
+    return false;
+}
+
+void GSavePipelineImpl::ExportJsonStream(const FString& FilePath,
+                                         const Serializer& Callback)
+{
+    try
+    {
+        std::ofstream File(StringCast<ANSICHAR>(*FilePath).Get(),
+                           std::ios::out | std::ios::trunc);
+        File.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+        Callback(File);
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GSAVE_PIPELINE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE,
+                    GSAVE_PIPELINE_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GSAVE_PIPELINE_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+}
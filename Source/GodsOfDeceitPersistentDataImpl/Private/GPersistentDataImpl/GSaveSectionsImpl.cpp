@@ -0,0 +1,831 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Sectioned save files with a table of contents, read through a memory map
+ */
+
+
+#include "GPersistentDataImpl/GSaveSectionsImpl.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <cstring>
+
+#include <Containers/StringConv.h>
+#include <Misc/AssertionMacros.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/stream.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+THIRD_PARTY_INCLUDES_START
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+THIRD_PARTY_INCLUDES_END
+
+#include <GCompressionImpl/GCompressionImpl.h>
+#include <GCryptoImpl/GCryptoImpl.h>
+#include <GHacks/GInclude_Windows.h>
+#include <GLog/GLog.h>
+#include <GPlatformImpl/GFileSystemImpl.h>
+#include <GTypes/GCompressionTypes.h>
+#include <GTypes/GCryptoTypes.h>
+
+#define     GSAVE_SECTIONS_ERROR_DIALOG_TITLE       "Save Sections Error"
+#define     GSAVE_SECTIONS_UNKNOWN_ERROR_MESSAGE    "GSaveSections: unknown error!"
+
+#define     GSAVE_SECTIONS_FORMAT_VERSION           1
+#define     GSAVE_SECTIONS_HEADER_SIZE              24
+#define     GSAVE_SECTIONS_MAX_PREFETCH_THREADS     8
+
+namespace
+{
+    const char Magic[4] = { 'G', 'S', 'E', 'C' };
+
+    struct TocEntry
+    {
+        std::string Name;
+        uint8 Codec;
+        uint64 Offset;
+        uint64 StoredSize;
+        uint64 RawSize;
+        GCryptoBuffer MAC;
+
+        template <class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(Name, Codec, Offset, StoredSize, RawSize, MAC);
+        }
+    };
+
+    std::string ToName(const FString& Name)
+    {
+        FTCHARToUTF8 Converter(*Name);
+        return std::string(Converter.Get(),
+                           static_cast<std::size_t>(Converter.Length()));
+    }
+
+    void EncodeUInt64(const uint64 Value, GCryptoByte* Out_Bytes)
+    {
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            Out_Bytes[i] = static_cast<GCryptoByte>((Value >> (i * 8)) & 0xff);
+        }
+    }
+
+    uint64 DecodeUInt64(const GCryptoByte* Bytes)
+    {
+        uint64 Value = 0;
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            Value |= static_cast<uint64>(Bytes[i]) << (i * 8);
+        }
+        return Value;
+    }
+
+    void MakeHeader(const uint64 TocOffset, const uint64 TocSize,
+                    GCryptoByte* Out_Header)
+    {
+        std::memcpy(Out_Header, Magic, sizeof(Magic));
+        Out_Header[4] = static_cast<GCryptoByte>(
+                    GSAVE_SECTIONS_FORMAT_VERSION & 0xff);
+        Out_Header[5] = static_cast<GCryptoByte>(
+                    (GSAVE_SECTIONS_FORMAT_VERSION >> 8) & 0xff);
+        Out_Header[6] = 0;
+        Out_Header[7] = 0;
+        EncodeUInt64(TocOffset, Out_Header + 8);
+        EncodeUInt64(TocSize, Out_Header + 16);
+    }
+}
+
+struct GSaveSectionWriterImpl::Impl
+{
+public:
+    const FString FilePath;
+    const FString TemporaryPath;
+    const GCryptoImpl& Crypto;
+
+    std::ofstream File;
+    uint64 Offset;
+    std::vector<TocEntry> Entries;
+    bool bFinished;
+    /// NOTE
+    /// Set by the first I/O failure, everything after it is a no-op and
+    /// Finish() reports it
+    bool bFailed;
+
+public:
+    Impl(const FString& InFilePath, const GCryptoImpl& InCrypto);
+
+public:
+    bool Abandon();
+};
+
+struct GSaveSectionReaderImpl::Impl
+{
+public:
+    struct Section
+    {
+        TocEntry Entry;
+        std::mutex Lock;
+        std::shared_ptr<const std::string> Data;
+        bool bFailed;
+    };
+
+public:
+    const FString FilePath;
+    const GCryptoImpl& Crypto;
+
+    boost::iostreams::mapped_file_source Map;
+    bool bOpen;
+    std::vector<std::unique_ptr<Section>> Sections;
+    std::unordered_map<std::string, std::size_t> Index;
+
+    /// NOTE
+    /// A fixed set of workers, started by the first Prefetch() and kept
+    /// until the reader goes away
+    std::mutex PrefetchLock;
+    std::condition_variable PrefetchCondition;
+    std::deque<std::string> PrefetchQueue;
+    std::size_t PrefetchActive;
+    bool bPrefetchStopping;
+    std::vector<std::thread> PrefetchThreads;
+
+public:
+    Impl(const FString& InFilePath, const GCryptoImpl& InCrypto);
+    ~Impl();
+
+public:
+    Section* FindSection(const std::string& Name) const;
+    std::shared_ptr<const std::string> Decode(Section& InSection);
+    std::shared_ptr<const std::string> Get(Section& InSection);
+    void Close();
+    void RunPrefetch();
+    void StopPrefetch();
+};
+
+GSaveSectionWriterImpl::GSaveSectionWriterImpl(const FString& FilePath,
+                                               const GCryptoImpl& Crypto)
+    : Pimpl(std::make_unique<GSaveSectionWriterImpl::Impl>(FilePath, Crypto))
+{
+
+}
+
+GSaveSectionWriterImpl::~GSaveSectionWriterImpl() = default;
+
+void GSaveSectionWriterImpl::AddSection(const FString& Name,
+                                        const std::string& Data,
+                                        const EGSaveSectionCodec Codec)
+{
+    checkf(!Pimpl->bFinished,
+           TEXT("FATAL: section added to a finished save file!"));
+
+    if (Pimpl->bFailed)
+    {
+        return;
+    }
+
+    try
+    {
+        TocEntry Entry;
+        Entry.Name = ToName(Name);
+        Entry.Codec = static_cast<uint8>(Codec);
+        Entry.Offset = Pimpl->Offset;
+        Entry.RawSize = static_cast<uint64>(Data.size());
+
+        GCompressionBuffer Compressed;
+        const char* Stored = Data.data();
+        std::size_t StoredSize = Data.size();
+
+        if (Codec == EGSaveSectionCodec::Zlib && !Data.empty())
+        {
+            GCompressionImpl::Compress(Data, Compressed,
+                                       EGCompressionAlgorithm::Zlib);
+            Stored = Compressed.data();
+            StoredSize = Compressed.size();
+        }
+        else
+        {
+            Entry.Codec = static_cast<uint8>(EGSaveSectionCodec::None);
+        }
+
+        Entry.StoredSize = static_cast<uint64>(StoredSize);
+
+        GCryptoImpl::Signer Signer(Pimpl->Crypto.CreateSigner());
+        Signer.Update(reinterpret_cast<const GCryptoByte*>(Stored),
+                      Entry.StoredSize);
+        Signer.Final(Entry.MAC);
+
+        Pimpl->File.write(Stored, static_cast<std::streamsize>(StoredSize));
+        Pimpl->Offset += Entry.StoredSize;
+        Pimpl->Entries.push_back(std::move(Entry));
+
+        return;
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to write section: "), Name, TEXT(" to "),
+                     Pimpl->TemporaryPath, TEXT(", "), Exception.what());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GSAVE_SECTIONS_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GSAVE_SECTIONS_UNKNOWN_ERROR_MESSAGE,
+                    GSAVE_SECTIONS_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GSAVE_SECTIONS_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+
+    Pimpl->bFailed = true;
+}
+
+bool GSaveSectionWriterImpl::Finish()
+{
+    if (Pimpl->bFinished)
+    {
+        return !Pimpl->bFailed;
+    }
+
+    Pimpl->bFinished = true;
+
+    if (Pimpl->bFailed)
+    {
+        return Pimpl->Abandon();
+    }
+
+    try
+    {
+        std::ostringstream Stream(std::ios::out | std::ios::binary);
+
+        {
+            cereal::PortableBinaryOutputArchive Archive(Stream);
+            Archive(Pimpl->Entries);
+        }
+
+        const std::string Toc(Stream.str());
+
+        GCryptoBuffer MAC;
+        GCryptoImpl::Signer Signer(Pimpl->Crypto.CreateSigner());
+        Signer.Update(reinterpret_cast<const GCryptoByte*>(Toc.data()),
+                      static_cast<uint64>(Toc.size()));
+        Signer.Final(MAC);
+
+        Pimpl->File.write(Toc.data(), static_cast<std::streamsize>(Toc.size()));
+        Pimpl->File.write(reinterpret_cast<const char*>(MAC.data()),
+                          static_cast<std::streamsize>(MAC.size()));
+
+        GCryptoByte Header[GSAVE_SECTIONS_HEADER_SIZE];
+        MakeHeader(Pimpl->Offset, static_cast<uint64>(Toc.size()), Header);
+
+        Pimpl->File.seekp(0, std::ios::beg);
+        Pimpl->File.write(reinterpret_cast<const char*>(Header),
+                          sizeof(Header));
+        Pimpl->File.close();
+
+        /// NOTE
+        /// Syncs the file before the rename and the directory after it, so
+        /// a crash never leaves a renamed but empty save behind
+        if (GFileSystemImpl::CommitTemporary(Pimpl->TemporaryPath,
+                                             Pimpl->FilePath))
+        {
+            return true;
+        }
+
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to move sectioned save file into place: "),
+                     Pimpl->FilePath);
+    }
+
+    catch (const std::ios_base::failure& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to write sectioned save file: "),
+                     Pimpl->FilePath, TEXT(", "), Exception.what());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(),
+                    GSAVE_SECTIONS_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GSAVE_SECTIONS_UNKNOWN_ERROR_MESSAGE,
+                    GSAVE_SECTIONS_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(
+                   GSAVE_SECTIONS_UNKNOWN_ERROR_MESSAGE).Get());
+    }
+
+    return Pimpl->Abandon();
+}
+
+GSaveSectionWriterImpl::Impl::Impl(const FString& InFilePath,
+                                   const GCryptoImpl& InCrypto)
+    : FilePath(InFilePath),
+      TemporaryPath(GFileSystemImpl::MakeTemporaryPath(InFilePath)),
+      Crypto(InCrypto),
+      Offset(GSAVE_SECTIONS_HEADER_SIZE),
+      bFinished(false),
+      bFailed(false)
+{
+    try
+    {
+        File.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        File.open(StringCast<ANSICHAR>(*TemporaryPath).Get(),
+                  std::ios::out | std::ios::binary | std::ios::trunc);
+
+        /// NOTE
+        /// Placeholder, Finish() fills the header in once the table of
+        /// contents' position is known
+        const char Header[GSAVE_SECTIONS_HEADER_SIZE] = { 0 };
+        File.write(Header, sizeof(Header));
+    }
+
+    catch (const std::exception& Exception)
+    {
+        bFailed = true;
+
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to create sectioned save file: "),
+                     TemporaryPath, TEXT(", "), Exception.what());
+    }
+}
+
+bool GSaveSectionWriterImpl::Impl::Abandon()
+{
+    bFailed = true;
+
+    /// NOTE
+    /// Leaves whatever save was there before in place
+    if (File.is_open())
+    {
+        File.exceptions(std::ofstream::goodbit);
+        File.close();
+    }
+
+    boost::system::error_code ErrorCode;
+    boost::filesystem::remove(StringCast<ANSICHAR>(*TemporaryPath).Get(),
+                              ErrorCode);
+
+    return false;
+}
+
+GSaveSectionReaderImpl::GSaveSectionReaderImpl(const FString& FilePath,
+                                               const GCryptoImpl& Crypto)
+    : Pimpl(std::make_unique<GSaveSectionReaderImpl::Impl>(FilePath, Crypto))
+{
+
+}
+
+GSaveSectionReaderImpl::~GSaveSectionReaderImpl() = default;
+
+bool GSaveSectionReaderImpl::Open()
+{
+    if (Pimpl->bOpen)
+    {
+        return true;
+    }
+
+    if (!GFileSystemImpl::FileExists(Pimpl->FilePath))
+    {
+        return false;
+    }
+
+    try
+    {
+        Pimpl->Map.open(StringCast<ANSICHAR>(*Pimpl->FilePath).Get());
+
+        const GCryptoByte* const Data =
+                reinterpret_cast<const GCryptoByte*>(Pimpl->Map.data());
+        const uint64 Size = static_cast<uint64>(Pimpl->Map.size());
+        const uint64 MACSize = GCryptoImpl::Signer::GetMACSize();
+
+        GCryptoByte Expected[GSAVE_SECTIONS_HEADER_SIZE];
+        MakeHeader(0, 0, Expected);
+
+        if (Size < GSAVE_SECTIONS_HEADER_SIZE
+                || std::memcmp(Data, Expected, 8) != 0)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Not a sectioned save file: "),
+                         Pimpl->FilePath);
+            Pimpl->Close();
+            return false;
+        }
+
+        const uint64 TocOffset = DecodeUInt64(Data + 8);
+        const uint64 TocSize = DecodeUInt64(Data + 16);
+
+        if (TocOffset < GSAVE_SECTIONS_HEADER_SIZE || TocOffset > Size
+                || TocSize > Size - TocOffset
+                || MACSize != Size - TocOffset - TocSize)
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Truncated sectioned save file: "),
+                         Pimpl->FilePath);
+            Pimpl->Close();
+            return false;
+        }
+
+        GCryptoImpl::Signer Signer(Pimpl->Crypto.CreateSigner());
+        Signer.Update(Data + TocOffset, TocSize);
+        if (!Signer.Verify(Data + TocOffset + TocSize, MACSize))
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Rejected sectioned save file, verification"
+                              " failed: "),
+                         Pimpl->FilePath);
+            Pimpl->Close();
+            return false;
+        }
+
+        std::vector<TocEntry> Entries;
+
+        {
+            boost::iostreams::stream<boost::iostreams::array_source> Stream(
+                        reinterpret_cast<const char*>(Data + TocOffset),
+                        static_cast<std::size_t>(TocSize));
+            cereal::PortableBinaryInputArchive Archive(Stream);
+            Archive(Entries);
+        }
+
+        for (TocEntry& Entry : Entries)
+        {
+            if (Entry.Offset < GSAVE_SECTIONS_HEADER_SIZE
+                    || Entry.Offset > TocOffset
+                    || Entry.StoredSize > TocOffset - Entry.Offset)
+            {
+                GLOG_WARNING(GLOG_KEY_GENERIC,
+                             TEXT("Corrupt section table in "),
+                             Pimpl->FilePath);
+                Pimpl->Close();
+                return false;
+            }
+
+            std::unique_ptr<Impl::Section> NewSection(
+                        std::make_unique<Impl::Section>());
+            NewSection->bFailed = false;
+            NewSection->Entry = std::move(Entry);
+
+            Pimpl->Index[NewSection->Entry.Name] = Pimpl->Sections.size();
+            Pimpl->Sections.push_back(std::move(NewSection));
+        }
+
+        Pimpl->bOpen = true;
+
+        return true;
+    }
+
+    catch (const std::exception& Exception)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to open sectioned save file: "),
+                     Pimpl->FilePath, TEXT(", "), Exception.what());
+    }
+
+    catch (...)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to open sectioned save file: "),
+                     Pimpl->FilePath);
+    }
+
+    Pimpl->Close();
+
+    return false;
+}
+
+std::vector<FString> GSaveSectionReaderImpl::GetSectionNames() const
+{
+    std::vector<FString> Names;
+    Names.reserve(Pimpl->Sections.size());
+
+    for (const auto& Section : Pimpl->Sections)
+    {
+        Names.emplace_back(UTF8_TO_TCHAR(Section->Entry.Name.c_str()));
+    }
+
+    return Names;
+}
+
+bool GSaveSectionReaderImpl::HasSection(const FString& Name) const
+{
+    return Pimpl->FindSection(ToName(Name)) != nullptr;
+}
+
+bool GSaveSectionReaderImpl::GetSection(const FString& Name,
+                                        std::string& Out_Data)
+{
+    const std::shared_ptr<const std::string> Data(GetSectionData(Name));
+    if (!Data)
+    {
+        return false;
+    }
+
+    Out_Data = *Data;
+    return true;
+}
+
+std::shared_ptr<const std::string> GSaveSectionReaderImpl::GetSectionData(
+        const FString& Name)
+{
+    Impl::Section* const Section = Pimpl->FindSection(ToName(Name));
+    if (!Section)
+    {
+        return nullptr;
+    }
+
+    return Pimpl->Get(*Section);
+}
+
+void GSaveSectionReaderImpl::Prefetch(const std::vector<FString>& Names)
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->PrefetchLock);
+        (void)LockGuard;
+
+        for (const FString& Name : Names)
+        {
+            Pimpl->PrefetchQueue.push_back(ToName(Name));
+        }
+
+        if (Pimpl->PrefetchThreads.empty())
+        {
+            const std::size_t Threads = std::min<std::size_t>(
+                        std::max(1u, std::thread::hardware_concurrency()),
+                        GSAVE_SECTIONS_MAX_PREFETCH_THREADS);
+
+            for (std::size_t i = 0; i < Threads; ++i)
+            {
+                Pimpl->PrefetchThreads.emplace_back(
+                            &GSaveSectionReaderImpl::Impl::RunPrefetch,
+                            Pimpl.get());
+            }
+        }
+    }
+
+    Pimpl->PrefetchCondition.notify_all();
+}
+
+void GSaveSectionReaderImpl::WaitForPrefetch()
+{
+    std::unique_lock<std::mutex> UniqueLock(Pimpl->PrefetchLock);
+
+    Pimpl->PrefetchCondition.wait(UniqueLock, [this]() {
+        return Pimpl->PrefetchQueue.empty() && Pimpl->PrefetchActive == 0;
+    });
+}
+
+void GSaveSectionReaderImpl::ReleaseSection(const FString& Name)
+{
+    Impl::Section* const Section = Pimpl->FindSection(ToName(Name));
+    if (!Section)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> LockGuard(Section->Lock);
+    (void)LockGuard;
+
+    Section->Data.reset();
+}
+
+GSaveSectionReaderImpl::Impl::Impl(const FString& InFilePath,
+                                   const GCryptoImpl& InCrypto)
+    : FilePath(InFilePath),
+      Crypto(InCrypto),
+      bOpen(false),
+      PrefetchActive(0),
+      bPrefetchStopping(false)
+{
+
+}
+
+GSaveSectionReaderImpl::Impl::~Impl()
+{
+    StopPrefetch();
+}
+
+void GSaveSectionReaderImpl::Impl::Close()
+{
+    bOpen = false;
+    Sections.clear();
+    Index.clear();
+
+    if (Map.is_open())
+    {
+        Map.close();
+    }
+}
+
+GSaveSectionReaderImpl::Impl::Section*
+GSaveSectionReaderImpl::Impl::FindSection(const std::string& Name) const
+{
+    const auto It = Index.find(Name);
+    return It != Index.end() ? Sections[It->second].get() : nullptr;
+}
+
+std::shared_ptr<const std::string> GSaveSectionReaderImpl::Impl::Decode(
+        Section& InSection)
+{
+    const TocEntry& Entry = InSection.Entry;
+    const char* const Stored = Map.data() + Entry.Offset;
+
+    GCryptoImpl::Signer Signer(Crypto.CreateSigner());
+    Signer.Update(reinterpret_cast<const GCryptoByte*>(Stored),
+                  Entry.StoredSize);
+    if (!Signer.Verify(Entry.MAC.data(),
+                       static_cast<uint64>(Entry.MAC.size())))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<std::string> Data;
+
+    switch (static_cast<EGSaveSectionCodec>(Entry.Codec))
+    {
+    case EGSaveSectionCodec::None:
+        Data = std::make_shared<std::string>(
+                    Stored, static_cast<std::size_t>(Entry.StoredSize));
+        break;
+    case EGSaveSectionCodec::Zlib:
+    {
+        GCompressionBuffer Buffer;
+        GCompressionImpl::Decompress(Stored, Entry.StoredSize, Buffer,
+                                     EGCompressionAlgorithm::Zlib);
+        Data = std::make_shared<std::string>(Buffer.data(), Buffer.size());
+        break;
+    }
+    default:
+        return nullptr;
+    }
+
+    if (Data->size() != Entry.RawSize)
+    {
+        return nullptr;
+    }
+
+    return Data;
+}
+
+std::shared_ptr<const std::string> GSaveSectionReaderImpl::Impl::Get(
+        Section& InSection)
+{
+    std::lock_guard<std::mutex> LockGuard(InSection.Lock);
+    (void)LockGuard;
+
+    if (!InSection.Data && !InSection.bFailed)
+    {
+        try
+        {
+            InSection.Data = Decode(InSection);
+        }
+
+        catch (...)
+        {
+            /// NOTE
+            /// Runs on the prefetch workers too, nothing may escape
+            InSection.Data.reset();
+        }
+
+        if (!InSection.Data)
+        {
+            InSection.bFailed = true;
+
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Section failed verification: "),
+                         InSection.Entry.Name, TEXT(" in "), FilePath);
+        }
+    }
+
+    return InSection.Data;
+}
+
+void GSaveSectionReaderImpl::Impl::RunPrefetch()
+{
+    for (;;)
+    {
+        std::string Name;
+
+        {
+            std::unique_lock<std::mutex> UniqueLock(PrefetchLock);
+
+            PrefetchCondition.wait(UniqueLock, [this]() {
+                return bPrefetchStopping || !PrefetchQueue.empty();
+            });
+
+            if (bPrefetchStopping)
+            {
+                return;
+            }
+
+            Name = std::move(PrefetchQueue.front());
+            PrefetchQueue.pop_front();
+            ++PrefetchActive;
+        }
+
+        Section* const FoundSection = FindSection(Name);
+        if (FoundSection)
+        {
+            Get(*FoundSection);
+        }
+
+        {
+            std::lock_guard<std::mutex> LockGuard(PrefetchLock);
+            (void)LockGuard;
+
+            --PrefetchActive;
+        }
+
+        PrefetchCondition.notify_all();
+    }
+}
+
+void GSaveSectionReaderImpl::Impl::StopPrefetch()
+{
+    std::vector<std::thread> Threads;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(PrefetchLock);
+        (void)LockGuard;
+
+        /// NOTE
+        /// Sections nobody waited for are not worth decoding anymore
+        bPrefetchStopping = true;
+        PrefetchQueue.clear();
+        Threads.swap(PrefetchThreads);
+    }
+
+    PrefetchCondition.notify_all();
+
+    for (std::thread& Thread : Threads)
+    {
+        if (Thread.joinable())
+        {
+            Thread.join();
+        }
+    }
+}
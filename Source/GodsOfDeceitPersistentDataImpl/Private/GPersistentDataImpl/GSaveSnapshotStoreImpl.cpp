@@ -0,0 +1,1221 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Incremental saves: a base snapshot plus a chain of delta segments
+ */
+
+
+#include "GPersistentDataImpl/GSaveSnapshotStoreImpl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <Containers/StringConv.h>
+
+THIRD_PARTY_INCLUDES_START
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+THIRD_PARTY_INCLUDES_END
+
+#include <GLog/GLog.h>
+#include <GPlatformImpl/GFileSystemImpl.h>
+
+#include "GPersistentDataImpl/GSavePipelineImpl.h"
+
+#define     GSAVE_SNAPSHOT_MANIFEST_FILE        TEXT("manifest.gsav")
+#define     GSAVE_SNAPSHOT_BASE_PREFIX          TEXT("base")
+#define     GSAVE_SNAPSHOT_DELTA_PREFIX         TEXT("delta")
+#define     GSAVE_SNAPSHOT_RECORD_SHARDS        64
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    /// NOTE
+    /// Values are immutable and shared, so copying a shard for a capture
+    /// or for copy-on-write never copies record bytes
+    typedef std::shared_ptr<const std::string> RecordValue;
+    typedef std::unordered_map<std::string, RecordValue> RecordsShard;
+
+    /// NOTE
+    /// The records are spread over a fixed number of shards, each shared
+    /// copy-on-write on its own. Copying the map for a capture copies the
+    /// shard pointers only, and the first mutation after a capture clones
+    /// just the shard it touches rather than every record.
+    class RecordsMap
+    {
+    private:
+        std::vector<std::shared_ptr<RecordsShard>> Shards;
+        /// NOTE
+        /// The capture each shard was created or last cloned after; any
+        /// shard from before the latest one may be shared with a capture
+        std::vector<uint64> ShardEpochs;
+        uint64 Epoch;
+        /// NOTE
+        /// Captures still alive, decremented with release semantics once a
+        /// capture is done reading, so seeing zero with acquire semantics
+        /// means every read of a shared shard has happened
+        std::shared_ptr<std::atomic<uint32>> LiveCaptures;
+
+    public:
+        RecordsMap()
+            : Shards(GSAVE_SNAPSHOT_RECORD_SHARDS),
+              ShardEpochs(GSAVE_SNAPSHOT_RECORD_SHARDS, 0),
+              Epoch(0),
+              LiveCaptures(std::make_shared<std::atomic<uint32>>(0))
+        {
+            for (std::shared_ptr<RecordsShard>& Shard : Shards)
+            {
+                Shard = std::make_shared<RecordsShard>();
+            }
+        }
+
+        /// NOTE
+        /// Hands out a read-only copy sharing every shard, for another
+        /// thread to read while this one keeps mutating the map
+        std::shared_ptr<const RecordsMap> Share()
+        {
+            ++Epoch;
+            LiveCaptures->fetch_add(1, std::memory_order_relaxed);
+
+            const std::shared_ptr<std::atomic<uint32>> Counter(LiveCaptures);
+            return std::shared_ptr<const RecordsMap>(
+                        new RecordsMap(*this),
+                        [Counter](const RecordsMap* Capture)
+            {
+                delete Capture;
+                Counter->fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        const RecordValue* Find(const std::string& Key) const
+        {
+            const RecordsShard& Shard = *Shards[GetShardIndex(Key)];
+
+            const auto It = Shard.find(Key);
+            return It != Shard.end() ? &It->second : nullptr;
+        }
+
+        std::size_t Size() const
+        {
+            std::size_t Count = 0;
+            for (const std::shared_ptr<RecordsShard>& Shard : Shards)
+            {
+                Count += Shard->size();
+            }
+            return Count;
+        }
+
+        template <typename CALLBACK>
+        void ForEach(const CALLBACK& Callback) const
+        {
+            for (const std::shared_ptr<RecordsShard>& Shard : Shards)
+            {
+                for (const auto& Record : *Shard)
+                {
+                    Callback(Record.first, *Record.second);
+                }
+            }
+        }
+
+        void Set(const std::string& Key, RecordValue Value)
+        {
+            GetMutableShard(Key)[Key] = std::move(Value);
+        }
+
+        void Erase(const std::string& Key)
+        {
+            GetMutableShard(Key).erase(Key);
+        }
+
+        void Clear(const std::size_t ExpectedCount = 0)
+        {
+            for (std::size_t i = 0; i < Shards.size(); ++i)
+            {
+                Shards[i] = std::make_shared<RecordsShard>();
+                Shards[i]->reserve(ExpectedCount / Shards.size());
+                ShardEpochs[i] = Epoch;
+            }
+        }
+
+    private:
+        static std::size_t GetShardIndex(const std::string& Key)
+        {
+            /// NOTE
+            /// Takes the top bits of a multiplicative hash, the shards' own
+            /// buckets are picked from the low bits of the plain one
+            const uint64 Hash = static_cast<uint64>(
+                        std::hash<std::string>()(Key));
+            return static_cast<std::size_t>(
+                        (Hash * 0x9E3779B97F4A7C15ull) >> 32)
+                    % GSAVE_SNAPSHOT_RECORD_SHARDS;
+        }
+
+        RecordsShard& GetMutableShard(const std::string& Key)
+        {
+            const std::size_t Index = GetShardIndex(Key);
+            std::shared_ptr<RecordsShard>& Shard = Shards[Index];
+
+            /// NOTE
+            /// A shard already cloned since the latest capture is ours
+            /// alone, any other one is too once no capture is left
+            if (ShardEpochs[Index] != Epoch)
+            {
+                if (LiveCaptures->load(std::memory_order_acquire) > 0)
+                {
+                    Shard = std::make_shared<RecordsShard>(*Shard);
+                }
+
+                ShardEpochs[Index] = Epoch;
+            }
+
+            return *Shard;
+        }
+    };
+
+    std::string ToKey(const FString& Key)
+    {
+        FTCHARToUTF8 Converter(*Key);
+        return std::string(Converter.Get(),
+                           static_cast<std::size_t>(Converter.Length()));
+    }
+
+    struct Manifest
+    {
+        bool bHasBase;
+        uint64 Base;
+        std::vector<uint64> Deltas;
+        uint64 LastSequence;
+
+        Manifest()
+            : bHasBase(false),
+              Base(0),
+              LastSequence(0)
+        {
+
+        }
+
+        template <class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(bHasBase, Base, Deltas, LastSequence);
+        }
+    };
+
+    /// NOTE
+    /// Everything a save needs, taken on the calling thread
+    struct Capture
+    {
+        uint64 Sequence;
+        bool bFull;
+        std::shared_ptr<const RecordsMap> Records;
+        std::unordered_set<std::string> Keys;
+        std::chrono::microseconds CaptureTime;
+        GSaveSnapshotStoreImpl::SaveCallback OnComplete;
+    };
+
+    /// NOTE
+    /// Segment layout inside the pipeline's archive: sequence, whether it
+    /// is a full snapshot, the written records as key/value pairs, then
+    /// the keys erased since the previous segment. A full snapshot writes
+    /// every record and ignores Keys. Returns false when the segment could
+    /// not be written.
+    bool WriteSegment(const FString& Path, const GCryptoImpl& Crypto,
+                      const uint64 Sequence, const bool bFull,
+                      const RecordsMap& Records,
+                      const std::unordered_set<std::string>& Keys,
+                      uint64& Out_RecordsWritten, uint64& Out_RecordsErased)
+    {
+        std::vector<const std::string*> Erased;
+
+        if (bFull)
+        {
+            Out_RecordsWritten = Records.Size();
+        }
+        else
+        {
+            Out_RecordsWritten = 0;
+
+            for (const std::string& Key : Keys)
+            {
+                if (Records.Find(Key) != nullptr)
+                {
+                    ++Out_RecordsWritten;
+                }
+                else
+                {
+                    Erased.push_back(&Key);
+                }
+            }
+        }
+
+        Out_RecordsErased = Erased.size();
+
+        const uint64 RecordsWritten = Out_RecordsWritten;
+
+        return GSavePipelineImpl::SaveStream(
+                    Path, Crypto, [&](std::ostream& Stream)
+        {
+            cereal::PortableBinaryOutputArchive Archive(Stream);
+
+            Archive(Sequence, bFull, RecordsWritten);
+
+            if (bFull)
+            {
+                Records.ForEach([&Archive](const std::string& Key,
+                                           const std::string& Value)
+                {
+                    Archive(Key, Value);
+                });
+            }
+            else
+            {
+                for (const std::string& Key : Keys)
+                {
+                    const RecordValue* Value = Records.Find(Key);
+                    if (Value != nullptr)
+                    {
+                        Archive(Key, **Value);
+                    }
+                }
+            }
+
+            Archive(static_cast<uint64>(Erased.size()));
+            for (const std::string* Key : Erased)
+            {
+                Archive(*Key);
+            }
+        });
+    }
+
+    bool ReadSegment(const FString& Path, const GCryptoImpl& Crypto,
+                     RecordsMap& InOut_Records)
+    {
+        return GSavePipelineImpl::LoadStream(
+                    Path, Crypto, [&](std::istream& Stream)
+        {
+            cereal::PortableBinaryInputArchive Archive(Stream);
+
+            uint64 Sequence = 0;
+            bool bFull = false;
+            uint64 Count = 0;
+            Archive(Sequence, bFull, Count);
+
+            if (bFull)
+            {
+                InOut_Records.Clear(static_cast<std::size_t>(Count));
+            }
+
+            for (uint64 i = 0; i < Count; ++i)
+            {
+                std::string Key;
+                std::string Value;
+                Archive(Key, Value);
+                InOut_Records.Set(Key, std::make_shared<const std::string>(
+                                      std::move(Value)));
+            }
+
+            Archive(Count);
+            for (uint64 i = 0; i < Count; ++i)
+            {
+                std::string Key;
+                Archive(Key);
+                InOut_Records.Erase(Key);
+            }
+        });
+    }
+}
+
+struct GSaveSnapshotStoreImpl::Impl
+{
+public:
+    const FString Directory;
+    const GCryptoImpl& Crypto;
+    const Settings StoreSettings;
+
+    /// NOTE
+    /// Owned by the calling thread: Put, Get, Erase, Save and SaveAsync are
+    /// expected to be called from the same thread. Captures share its
+    /// shards.
+    RecordsMap Records;
+    std::unordered_set<std::string> Dirty;
+
+    /// NOTE
+    /// Serializes manifest updates between the save and compaction
+    /// threads. Held across writing a manifest, which Lock never is, so
+    /// captures on the calling thread do not wait on the disk.
+    std::mutex ManifestLock;
+
+    /// NOTE
+    /// Guards everything below, shared with the worker threads
+    mutable std::mutex Lock;
+    std::condition_variable Condition;
+    Manifest Chain;
+    /// NOTE
+    /// Chain length once every queued save is written, what the full or
+    /// delta decision is based on
+    std::size_t PlannedChainLength;
+    bool bPlannedBase;
+    /// NOTE
+    /// Full saves captured but not written yet, whether queued, in flight
+    /// on the save thread or running synchronously
+    uint32 PendingFullSaves;
+    std::deque<Capture> Queue;
+    bool bWriting;
+    std::vector<std::pair<SaveCallback, SaveReport>> Completed;
+    std::vector<FString> Obsolete;
+    /// NOTE
+    /// Set once a save failed to hit the disk. Deltas queued behind it
+    /// would chain onto the missing segment, so they get dropped until a
+    /// full save lands; their keys end up in Unsaved, to be marked dirty
+    /// again by the calling thread.
+    bool bChainBroken;
+    std::unordered_set<std::string> Unsaved;
+    bool bCompactionRequested;
+    bool bCompacting;
+    bool bStopping;
+    std::thread SaveThread;
+    std::thread CompactionThread;
+
+public:
+    Impl(const FString& InDirectory, const GCryptoImpl& InCrypto,
+         const Settings& InSettings);
+    ~Impl();
+
+public:
+    FString GetManifestPath() const;
+    FString GetSegmentPath(const TCHAR* Prefix, const uint64 Sequence) const;
+    FString GetBasePath(const Manifest& InChain) const;
+
+    void ReclaimUnsaved();
+
+    bool WriteManifest(const Manifest& InChain);
+    void Publish(Manifest& InOut_Chain);
+    void TakeGarbage(std::vector<FString>& Out_Files);
+    void CollectGarbage(const std::vector<FString>& Files);
+
+    bool MakeCapture(const bool bForceFull, Capture& Out_Capture);
+    SaveReport Write(const Capture& InCapture);
+    void WaitForSaves(std::unique_lock<std::mutex>& UniqueLock);
+
+    void RunSaves();
+    void RunCompaction();
+    void Compact();
+};
+
+GSaveSnapshotStoreImpl::GSaveSnapshotStoreImpl(const FString& Directory,
+                                               const GCryptoImpl& Crypto,
+                                               const Settings& InSettings)
+    : Pimpl(std::make_unique<GSaveSnapshotStoreImpl::Impl>(
+                Directory, Crypto, InSettings))
+{
+
+}
+
+GSaveSnapshotStoreImpl::~GSaveSnapshotStoreImpl() = default;
+
+bool GSaveSnapshotStoreImpl::Load()
+{
+    std::unique_lock<std::mutex> UniqueLock(Pimpl->Lock);
+
+    Pimpl->WaitForSaves(UniqueLock);
+    Pimpl->Condition.wait(UniqueLock, [this]() {
+        return !Pimpl->bCompacting && !Pimpl->bCompactionRequested;
+    });
+
+    Pimpl->Records = RecordsMap();
+    Pimpl->Dirty.clear();
+    Pimpl->Chain = Manifest();
+    Pimpl->PlannedChainLength = 0;
+    Pimpl->bPlannedBase = false;
+    Pimpl->bChainBroken = false;
+    Pimpl->Unsaved.clear();
+
+    Manifest Chain;
+    if (!GSavePipelineImpl::LoadStream(
+                Pimpl->GetManifestPath(), Pimpl->Crypto,
+                [&](std::istream& Stream)
+    {
+        cereal::PortableBinaryInputArchive Archive(Stream);
+        Archive(Chain);
+    }) || !Chain.bHasBase)
+    {
+        return false;
+    }
+
+    RecordsMap Records;
+
+    bool bLoaded = ReadSegment(Pimpl->GetBasePath(Chain), Pimpl->Crypto,
+                               Records);
+    for (std::size_t i = 0; bLoaded && i < Chain.Deltas.size(); ++i)
+    {
+        bLoaded = ReadSegment(Pimpl->GetSegmentPath(
+                                  GSAVE_SNAPSHOT_DELTA_PREFIX,
+                                  Chain.Deltas[i]),
+                              Pimpl->Crypto, Records);
+    }
+
+    if (!bLoaded)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to replay the save chain in "),
+                     Pimpl->Directory);
+        return false;
+    }
+
+    Pimpl->Records = std::move(Records);
+    Pimpl->Chain = std::move(Chain);
+    Pimpl->PlannedChainLength = Pimpl->Chain.Deltas.size();
+    Pimpl->bPlannedBase = true;
+
+    return true;
+}
+
+GSaveSnapshotStoreImpl::SaveReport GSaveSnapshotStoreImpl::Save()
+{
+    /// NOTE
+    /// Segments must land in sequence order, queued saves go first
+    WaitForSaves();
+
+    Capture SaveCapture;
+    if (!Pimpl->MakeCapture(false, SaveCapture))
+    {
+        SaveReport Report;
+        Report.Kind = ESaveKind::None;
+        Report.Sequence = 0;
+        Report.RecordsWritten = 0;
+        Report.RecordsErased = 0;
+        Report.FileSize = 0;
+        Report.CaptureTime = SaveCapture.CaptureTime;
+        Report.bSucceeded = true;
+        return Report;
+    }
+
+    return Pimpl->Write(SaveCapture);
+}
+
+GSaveSnapshotStoreImpl::SaveReport GSaveSnapshotStoreImpl::SaveFull()
+{
+    WaitForSaves();
+
+    Capture SaveCapture;
+    Pimpl->MakeCapture(true, SaveCapture);
+
+    return Pimpl->Write(SaveCapture);
+}
+
+void GSaveSnapshotStoreImpl::SaveAsync(const SaveCallback& OnComplete,
+                                       const bool bForceFull)
+{
+    Capture SaveCapture;
+    SaveCapture.OnComplete = OnComplete;
+
+    if (!Pimpl->MakeCapture(bForceFull, SaveCapture))
+    {
+        SaveReport Report;
+        Report.Kind = ESaveKind::None;
+        Report.Sequence = 0;
+        Report.RecordsWritten = 0;
+        Report.RecordsErased = 0;
+        Report.FileSize = 0;
+        Report.CaptureTime = SaveCapture.CaptureTime;
+        Report.bSucceeded = true;
+
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        if (OnComplete)
+        {
+            Pimpl->Completed.emplace_back(OnComplete, Report);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        Pimpl->Queue.push_back(std::move(SaveCapture));
+    }
+
+    Pimpl->Condition.notify_all();
+}
+
+uint32 GSaveSnapshotStoreImpl::DispatchCompletions()
+{
+    std::vector<std::pair<SaveCallback, SaveReport>> Completed;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        Completed.swap(Pimpl->Completed);
+    }
+
+    for (const auto& Completion : Completed)
+    {
+        Completion.first(Completion.second);
+    }
+
+    return static_cast<uint32>(Completed.size());
+}
+
+void GSaveSnapshotStoreImpl::WaitForSaves()
+{
+    std::unique_lock<std::mutex> UniqueLock(Pimpl->Lock);
+    Pimpl->WaitForSaves(UniqueLock);
+}
+
+void GSaveSnapshotStoreImpl::WaitForCompaction()
+{
+    std::unique_lock<std::mutex> UniqueLock(Pimpl->Lock);
+
+    Pimpl->Condition.wait(UniqueLock, [this]() {
+        return !Pimpl->bCompacting && !Pimpl->bCompactionRequested;
+    });
+}
+
+uint32 GSaveSnapshotStoreImpl::GetChainLength() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return static_cast<uint32>(Pimpl->Chain.Deltas.size());
+}
+
+uint64 GSaveSnapshotStoreImpl::GetDirtyCount() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    Pimpl->ReclaimUnsaved();
+
+    return static_cast<uint64>(Pimpl->Dirty.size());
+}
+
+bool GSaveSnapshotStoreImpl::Contains(const FString& Key) const
+{
+    return Pimpl->Records.Find(ToKey(Key)) != nullptr;
+}
+
+void GSaveSnapshotStoreImpl::Erase(const FString& Key)
+{
+    std::string RecordKey(ToKey(Key));
+
+    if (Pimpl->Records.Find(RecordKey) == nullptr)
+    {
+        return;
+    }
+
+    Pimpl->Records.Erase(RecordKey);
+    Pimpl->Dirty.insert(std::move(RecordKey));
+}
+
+void GSaveSnapshotStoreImpl::PutRaw(const FString& Key,
+                                    const std::string& Data)
+{
+    std::string RecordKey(ToKey(Key));
+
+    const RecordValue* Value = Pimpl->Records.Find(RecordKey);
+    if (Value != nullptr && **Value == Data)
+    {
+        return;
+    }
+
+    Pimpl->Records.Set(RecordKey, std::make_shared<const std::string>(Data));
+    Pimpl->Dirty.insert(std::move(RecordKey));
+}
+
+bool GSaveSnapshotStoreImpl::GetRaw(const FString& Key,
+                                    std::string& Out_Data) const
+{
+    const RecordValue* Value = Pimpl->Records.Find(ToKey(Key));
+    if (Value == nullptr)
+    {
+        return false;
+    }
+
+    Out_Data = **Value;
+    return true;
+}
+
+GSaveSnapshotStoreImpl::Impl::Impl(const FString& InDirectory,
+                                   const GCryptoImpl& InCrypto,
+                                   const Settings& InSettings)
+    : Directory(InDirectory),
+      Crypto(InCrypto),
+      StoreSettings(InSettings),
+      PlannedChainLength(0),
+      bPlannedBase(false),
+      PendingFullSaves(0),
+      bWriting(false),
+      bChainBroken(false),
+      bCompactionRequested(false),
+      bCompacting(false),
+      bStopping(false)
+{
+    if (!GFileSystemImpl::DirectoryExists(Directory))
+    {
+        GFileSystemImpl::CreateDirectory(Directory);
+    }
+
+    SaveThread = std::thread(&GSaveSnapshotStoreImpl::Impl::RunSaves, this);
+
+    if (StoreSettings.CompactionThreshold > 0)
+    {
+        CompactionThread = std::thread(
+                    &GSaveSnapshotStoreImpl::Impl::RunCompaction, this);
+    }
+}
+
+GSaveSnapshotStoreImpl::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        bStopping = true;
+    }
+
+    Condition.notify_all();
+
+    /// NOTE
+    /// The save thread drains its queue before it quits, requested saves
+    /// are never dropped
+    if (SaveThread.joinable())
+    {
+        SaveThread.join();
+    }
+
+    if (CompactionThread.joinable())
+    {
+        CompactionThread.join();
+    }
+}
+
+FString GSaveSnapshotStoreImpl::Impl::GetManifestPath() const
+{
+    return GFileSystemImpl::CombinePaths({Directory,
+                                          GSAVE_SNAPSHOT_MANIFEST_FILE});
+}
+
+FString GSaveSnapshotStoreImpl::Impl::GetSegmentPath(
+        const TCHAR* Prefix, const uint64 Sequence) const
+{
+    return GFileSystemImpl::CombinePaths({
+                                             Directory,
+                                             FString::Printf(
+                                             TEXT("%s-%020llu.gsav"),
+                                             Prefix, Sequence)
+                                         });
+}
+
+FString GSaveSnapshotStoreImpl::Impl::GetBasePath(
+        const Manifest& InChain) const
+{
+    return GetSegmentPath(GSAVE_SNAPSHOT_BASE_PREFIX, InChain.Base);
+}
+
+void GSaveSnapshotStoreImpl::Impl::ReclaimUnsaved()
+{
+    Dirty.insert(Unsaved.begin(), Unsaved.end());
+    Unsaved.clear();
+}
+
+bool GSaveSnapshotStoreImpl::Impl::WriteManifest(const Manifest& InChain)
+{
+    return GSavePipelineImpl::SaveStream(GetManifestPath(), Crypto,
+                                         [&](std::ostream& Stream)
+    {
+        cereal::PortableBinaryOutputArchive Archive(Stream);
+        Archive(InChain);
+    });
+}
+
+void GSaveSnapshotStoreImpl::Impl::Publish(Manifest& InOut_Chain)
+{
+    /// NOTE
+    /// Captures keep handing out sequences while a manifest is written
+    InOut_Chain.LastSequence = std::max(InOut_Chain.LastSequence,
+                                        Chain.LastSequence);
+    Chain = std::move(InOut_Chain);
+}
+
+void GSaveSnapshotStoreImpl::Impl::TakeGarbage(std::vector<FString>& Out_Files)
+{
+    /// NOTE
+    /// Files may still be read by a running compaction. One starting after
+    /// this reads the published chain, which lists none of them.
+    if (bCompacting)
+    {
+        return;
+    }
+
+    Out_Files.insert(Out_Files.end(), Obsolete.begin(), Obsolete.end());
+    Obsolete.clear();
+}
+
+void GSaveSnapshotStoreImpl::Impl::CollectGarbage(
+        const std::vector<FString>& Files)
+{
+    /// NOTE
+    /// Everything in here was replaced by a manifest that SaveStream()
+    /// synced to disk, together with the segments it lists, before it got
+    /// renamed into place; a crash past this point can no longer bring the
+    /// old chain back as the one to load. A file that fails to go away is
+    /// only wasted space.
+    for (const FString& Path : Files)
+    {
+        if (!GFileSystemImpl::TryErase(Path, false))
+        {
+            GLOG_WARNING(GLOG_KEY_GENERIC,
+                         TEXT("Failed to erase obsolete save file: "), Path);
+        }
+    }
+}
+
+bool GSaveSnapshotStoreImpl::Impl::MakeCapture(const bool bForceFull,
+                                               Capture& Out_Capture)
+{
+    const Clock::time_point Start = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        ReclaimUnsaved();
+
+        Out_Capture.bFull = bForceFull || !bPlannedBase
+                || PlannedChainLength + 1 >= StoreSettings.MaxDeltaChain;
+
+        if (!Out_Capture.bFull && Dirty.empty())
+        {
+            Out_Capture.Sequence = 0;
+            Out_Capture.CaptureTime =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - Start);
+            return false;
+        }
+
+        Out_Capture.Sequence = ++Chain.LastSequence;
+
+        if (Out_Capture.bFull)
+        {
+            bPlannedBase = true;
+            PlannedChainLength = 0;
+            ++PendingFullSaves;
+        }
+        else
+        {
+            ++PlannedChainLength;
+        }
+    }
+
+    Out_Capture.Records = Records.Share();
+    Out_Capture.Keys.swap(Dirty);
+
+    if (Out_Capture.bFull)
+    {
+        Out_Capture.Keys.clear();
+    }
+
+    Out_Capture.CaptureTime =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - Start);
+
+    return true;
+}
+
+GSaveSnapshotStoreImpl::SaveReport GSaveSnapshotStoreImpl::Impl::Write(
+        const Capture& InCapture)
+{
+    SaveReport Report;
+    Report.Kind = InCapture.bFull ? ESaveKind::Full : ESaveKind::Delta;
+    Report.Sequence = InCapture.Sequence;
+    Report.RecordsWritten = 0;
+    Report.RecordsErased = 0;
+    Report.FileSize = 0;
+    Report.CaptureTime = InCapture.CaptureTime;
+    Report.bSucceeded = false;
+
+    const FString Path(GetSegmentPath(InCapture.bFull
+                                      ? GSAVE_SNAPSHOT_BASE_PREFIX
+                                      : GSAVE_SNAPSHOT_DELTA_PREFIX,
+                                      InCapture.Sequence));
+
+    bool bSkipped = false;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        bSkipped = !InCapture.bFull && bChainBroken;
+    }
+
+    bool bSaved = !bSkipped
+            && WriteSegment(Path, Crypto, InCapture.Sequence,
+                            InCapture.bFull, *InCapture.Records,
+                            InCapture.Keys, Report.RecordsWritten,
+                            Report.RecordsErased);
+
+    if (bSaved)
+    {
+        Report.FileSize =
+                static_cast<uint64>(GFileSystemImpl::GetFileSize(Path));
+
+        std::lock_guard<std::mutex> ManifestLockGuard(ManifestLock);
+        (void)ManifestLockGuard;
+
+        Manifest NewChain;
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            NewChain = Chain;
+        }
+
+        std::vector<FString> Replaced;
+
+        if (InCapture.bFull)
+        {
+            if (NewChain.bHasBase)
+            {
+                Replaced.push_back(GetBasePath(NewChain));
+            }
+
+            for (const uint64 Delta : NewChain.Deltas)
+            {
+                Replaced.push_back(GetSegmentPath(GSAVE_SNAPSHOT_DELTA_PREFIX,
+                                                  Delta));
+            }
+
+            NewChain.bHasBase = true;
+            NewChain.Base = InCapture.Sequence;
+            NewChain.Deltas.clear();
+        }
+        else
+        {
+            NewChain.Deltas.push_back(InCapture.Sequence);
+        }
+
+        /// NOTE
+        /// Until the manifest lists the new segment, the previous chain is
+        /// what a Load() replays, so none of it may go away. Both the
+        /// segment and the manifest are synced, file and directory, by the
+        /// time SaveStream() returns true, and the replaced files are only
+        /// queued for removal after that. Written without Lock held, only
+        /// ManifestLock keeps the compaction thread from racing it.
+        bSaved = WriteManifest(NewChain);
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        if (bSaved)
+        {
+            Publish(NewChain);
+            Obsolete.insert(Obsolete.end(), Replaced.begin(),
+                            Replaced.end());
+            bChainBroken = false;
+        }
+        else
+        {
+            Obsolete.push_back(Path);
+        }
+    }
+
+    std::vector<FString> Garbage;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        if (InCapture.bFull)
+        {
+            --PendingFullSaves;
+        }
+
+        if (!bSaved)
+        {
+            bChainBroken = true;
+            bPlannedBase = false;
+            Unsaved.insert(InCapture.Keys.begin(), InCapture.Keys.end());
+
+            Report.RecordsWritten = 0;
+            Report.RecordsErased = 0;
+            Report.FileSize = 0;
+        }
+
+        Report.bSucceeded = bSaved;
+
+        if (StoreSettings.CompactionThreshold > 0
+                && Chain.Deltas.size() >= StoreSettings.CompactionThreshold
+                && !bCompacting)
+        {
+            bCompactionRequested = true;
+        }
+
+        TakeGarbage(Garbage);
+    }
+
+    CollectGarbage(Garbage);
+
+    if (!bSaved)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Failed to write save "), InCapture.Sequence,
+                     TEXT(" to "), Directory,
+                     TEXT(", the next save will be a full one"));
+    }
+
+    Condition.notify_all();
+
+    return Report;
+}
+
+void GSaveSnapshotStoreImpl::Impl::WaitForSaves(
+        std::unique_lock<std::mutex>& UniqueLock)
+{
+    Condition.wait(UniqueLock, [this]() {
+        return Queue.empty() && !bWriting;
+    });
+}
+
+void GSaveSnapshotStoreImpl::Impl::RunSaves()
+{
+    for (;;)
+    {
+        Capture SaveCapture;
+
+        {
+            std::unique_lock<std::mutex> UniqueLock(Lock);
+
+            Condition.wait(UniqueLock, [this]() {
+                return bStopping || !Queue.empty();
+            });
+
+            if (Queue.empty())
+            {
+                break;
+            }
+
+            SaveCapture = std::move(Queue.front());
+            Queue.pop_front();
+            bWriting = true;
+        }
+
+        const SaveReport Report(Write(SaveCapture));
+
+        /// NOTE
+        /// Drop the shared records before the next capture, so the calling
+        /// thread does not clone shards for nothing
+        SaveCapture.Records.reset();
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            bWriting = false;
+
+            if (SaveCapture.OnComplete)
+            {
+                Completed.emplace_back(SaveCapture.OnComplete, Report);
+            }
+        }
+
+        Condition.notify_all();
+    }
+}
+
+void GSaveSnapshotStoreImpl::Impl::RunCompaction()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> UniqueLock(Lock);
+
+            Condition.wait(UniqueLock, [this]() {
+                return bStopping || bCompactionRequested;
+            });
+
+            if (bStopping)
+            {
+                break;
+            }
+
+            bCompactionRequested = false;
+            bCompacting = true;
+        }
+
+        Compact();
+
+        std::vector<FString> Garbage;
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            bCompacting = false;
+            TakeGarbage(Garbage);
+        }
+
+        Condition.notify_all();
+
+        CollectGarbage(Garbage);
+    }
+}
+
+void GSaveSnapshotStoreImpl::Impl::Compact()
+{
+    Manifest Snapshot;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        Snapshot = Chain;
+    }
+
+    if (!Snapshot.bHasBase || Snapshot.Deltas.empty())
+    {
+        return;
+    }
+
+    RecordsMap Merged;
+
+    bool bLoaded = ReadSegment(GetBasePath(Snapshot), Crypto, Merged);
+    for (std::size_t i = 0; bLoaded && i < Snapshot.Deltas.size(); ++i)
+    {
+        bLoaded = ReadSegment(GetSegmentPath(GSAVE_SNAPSHOT_DELTA_PREFIX,
+                                             Snapshot.Deltas[i]),
+                              Crypto, Merged);
+    }
+
+    if (!bLoaded)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Save compaction skipped, the chain in "),
+                     Directory, TEXT(" could not be replayed"));
+        return;
+    }
+
+    /// NOTE
+    /// The merged base takes the sequence of the last delta it absorbed,
+    /// base and delta files live under different prefixes
+    const uint64 Sequence = Snapshot.Deltas.back();
+    const FString Path(GetSegmentPath(GSAVE_SNAPSHOT_BASE_PREFIX, Sequence));
+
+    uint64 RecordsWritten = 0;
+    uint64 RecordsErased = 0;
+    if (!WriteSegment(Path, Crypto, Sequence, true, Merged,
+                      std::unordered_set<std::string>(),
+                      RecordsWritten, RecordsErased))
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Save compaction failed to write "), Path);
+        return;
+    }
+
+    std::lock_guard<std::mutex> ManifestLockGuard(ManifestLock);
+    (void)ManifestLockGuard;
+
+    Manifest NewChain;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        /// NOTE
+        /// A full save that landed meanwhile made this base redundant
+        const bool bStillValid = Chain.bHasBase
+                && Chain.Base == Snapshot.Base
+                && Chain.Deltas.size() >= Snapshot.Deltas.size()
+                && std::equal(Snapshot.Deltas.begin(), Snapshot.Deltas.end(),
+                              Chain.Deltas.begin());
+
+        if (!bStillValid)
+        {
+            Obsolete.push_back(Path);
+            return;
+        }
+
+        NewChain = Chain;
+    }
+
+    NewChain.Base = Sequence;
+    NewChain.Deltas.erase(NewChain.Deltas.begin(),
+                          NewChain.Deltas.begin()
+                          + static_cast<std::ptrdiff_t>(
+                              Snapshot.Deltas.size()));
+
+    /// NOTE
+    /// ManifestLock keeps the chain from changing under this write
+    const bool bWritten = WriteManifest(NewChain);
+
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    (void)LockGuard;
+
+    if (!bWritten)
+    {
+        GLOG_WARNING(GLOG_KEY_GENERIC,
+                     TEXT("Save compaction failed to update the manifest in "),
+                     Directory);
+        Obsolete.push_back(Path);
+        return;
+    }
+
+    Obsolete.push_back(GetBasePath(Snapshot));
+    for (const uint64 Delta : Snapshot.Deltas)
+    {
+        Obsolete.push_back(GetSegmentPath(GSAVE_SNAPSHOT_DELTA_PREFIX, Delta));
+    }
+
+    Publish(NewChain);
+
+    /// NOTE
+    /// Unless a full save has been captured and not written yet, in which
+    /// case the plan already starts over from it
+    if (PlannedChainLength >= Snapshot.Deltas.size()
+            && PendingFullSaves == 0)
+    {
+        PlannedChainLength -= Snapshot.Deltas.size();
+    }
+}
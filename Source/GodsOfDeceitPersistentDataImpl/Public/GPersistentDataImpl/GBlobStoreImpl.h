@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Content-addressed, deduplicating blob store for save attachments
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+/// NOTE
+/// Blobs such as thumbnails, replays or serialized level state are keyed
+/// by the hex BLAKE2b-256 digest of their content, so a blob that several
+/// save slots carry is stored once. Each blob is zlib-compressed into its
+/// own file under Directory/objects, fanned out by the first digest byte.
+/// Reference counts live in a GJournalStoreImpl next to them; saves keep
+/// the returned id and Release() it when they are deleted, the blob goes
+/// away with its last reference.
+class GODSOFDECEITPERSISTENTDATAIMPL_API GBlobStoreImpl
+{
+public:
+    struct Stats
+    {
+        uint64 Blobs;
+        uint64 References;
+        /// NOTE
+        /// Uncompressed bytes of the unique blobs, and what they take on
+        /// disk
+        uint64 RawBytes;
+        uint64 StoredBytes;
+        /// NOTE
+        /// Uncompressed bytes that Put() did not have to write because the
+        /// blob was already there, since Open()
+        uint64 DeduplicatedBytes;
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    explicit GBlobStoreImpl(const FString& Directory);
+    virtual ~GBlobStoreImpl();
+
+public:
+    void Open();
+
+    /// NOTE
+    /// Stores the blob unless it is already there, takes a reference on it
+    /// either way and returns its id. Returns an empty id, with no
+    /// reference taken, when the blob could not be written.
+    FString Put(const char* Data, const uint64 Size);
+    FString Put(const std::string& Data);
+
+    /// NOTE
+    /// Returns false for an unknown id or a blob whose content no longer
+    /// matches its digest
+    bool Get(const FString& BlobId, std::string& Out_Data) const;
+
+    bool Contains(const FString& BlobId) const;
+    uint64 GetReferenceCount(const FString& BlobId) const;
+
+    /// NOTE
+    /// Returns false, with no reference taken, when it could not be
+    /// recorded
+    bool AddReference(const FString& BlobId);
+    /// NOTE
+    /// Returns true when that was the last reference and the blob is gone.
+    /// Also returns false, with the reference still held, when the release
+    /// could not be recorded.
+    bool Release(const FString& BlobId);
+
+    Stats GetStats() const;
+};
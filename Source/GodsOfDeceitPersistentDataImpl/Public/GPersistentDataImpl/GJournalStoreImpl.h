@@ -0,0 +1,158 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Append-only journaled key-value store for high-frequency persistent state
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+THIRD_PARTY_INCLUDES_START
+#include <cereal/archives/portable_binary.hpp>
+THIRD_PARTY_INCLUDES_END
+
+/// NOTE
+/// Every Put or Erase appends one record to the journal, no existing byte
+/// is ever rewritten. Records are laid out as uint32 payload size, uint32
+/// CRC-32 of the payload, then the payload: uint8 type, uint32 key size,
+/// key, value. Only the key index lives in memory, values are read back
+/// from the journal.
+///
+/// Opening replays the journal and cuts it at the first record that is
+/// incomplete or fails its checksum, which is where a crash would have
+/// left it. A background thread rewrites the journal with live records
+/// only once enough of it is dead.
+class GODSOFDECEITPERSISTENTDATAIMPL_API GJournalStoreImpl
+{
+public:
+    struct Settings
+    {
+        /// NOTE
+        /// Compaction starts once at least this many bytes are dead and
+        /// they make up DeadRatioPercent of the journal
+        uint64 CompactionMinDeadBytes;
+        uint32 DeadRatioPercent;
+
+        bool bBackgroundCompaction;
+
+        Settings()
+            : CompactionMinDeadBytes(1024 * 1024),
+              DeadRatioPercent(50),
+              bBackgroundCompaction(true)
+        {
+
+        }
+    };
+
+    struct Stats
+    {
+        uint64 Keys;
+        uint64 JournalSize;
+        uint64 DeadBytes;
+        uint64 Compactions;
+        /// NOTE
+        /// Bytes cut off the journal's tail by the last recovery
+        uint64 DiscardedBytes;
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    GJournalStoreImpl(const FString& FilePath,
+                      const Settings& InSettings = Settings());
+    virtual ~GJournalStoreImpl();
+
+public:
+    /// NOTE
+    /// Creates the journal when missing, otherwise replays it
+    void Open();
+
+    /// NOTE
+    /// I/O failures are logged and reported as false, the index only
+    /// changes once a record is written; GetRaw() cannot tell a failed
+    /// read from a missing key
+    bool PutRaw(const FString& Key, const std::string& Value);
+    bool GetRaw(const FString& Key, std::string& Out_Value) const;
+    bool Contains(const FString& Key) const;
+    bool Erase(const FString& Key);
+    void GetKeys(std::vector<FString>& Out_Keys) const;
+
+    /// NOTE
+    /// Pushes buffered records to the operating system
+    bool Flush();
+
+    /// NOTE
+    /// Compacts right away on the calling thread; on failure the original
+    /// journal stays in use
+    void Compact();
+
+    Stats GetStats() const;
+
+    template <typename TYPE>
+    bool Put(const FString& Key, const TYPE& Value)
+    {
+        std::ostringstream Stream(std::ios::out | std::ios::binary);
+
+        {
+            cereal::PortableBinaryOutputArchive Archive(Stream);
+            Archive(Value);
+        }
+
+        return PutRaw(Key, Stream.str());
+    }
+
+    template <typename TYPE>
+    bool Get(const FString& Key, TYPE& Out_Value) const
+    {
+        std::string Data;
+        if (!GetRaw(Key, Data))
+        {
+            return false;
+        }
+
+        std::istringstream Stream(Data, std::ios::in | std::ios::binary);
+        cereal::PortableBinaryInputArchive Archive(Stream);
+        Archive(Out_Value);
+
+        return true;
+    }
+};
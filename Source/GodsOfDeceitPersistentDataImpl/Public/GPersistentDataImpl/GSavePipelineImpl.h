@@ -0,0 +1,142 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Single-pass, compressed and signed save files
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <istream>
+#include <ostream>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+THIRD_PARTY_INCLUDES_START
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+THIRD_PARTY_INCLUDES_END
+
+class GCryptoImpl;
+
+/// NOTE
+/// Saves are serialized with cereal's portable binary archive straight into
+/// a streaming compressor, and the compressed bytes are signed frame by
+/// frame on their way to disk. Neither the archive nor the compressed
+/// payload is ever held in memory as a whole, neither saving nor loading.
+///
+/// On-disk layout, integers are little-endian:
+///   header:  "GSAV", uint16 format version, uint8 compression algorithm,
+///            uint8 reserved
+///   frames:  uint32 length (up to 64 KiB), that many bytes of the
+///            compressed archive, HMAC-SHA512
+///   trailer: uint32 zero, uint64 archive size, uint64 payload size,
+///            HMAC-SHA512
+///
+/// Every MAC covers the previous MAC (the header for the first frame), the
+/// length and the bytes, so frames cannot be altered, reordered, dropped or
+/// spliced in from another save without breaking the chain.
+///
+/// Loading verifies each frame before decompressing it, so tampered bytes
+/// never reach cereal. Files with a bad header or first frame are rejected
+/// up front; damage further in surfaces while Callback reads.
+class GODSOFDECEITPERSISTENTDATAIMPL_API GSavePipelineImpl
+{
+public:
+    typedef std::function<void(std::ostream& Stream)> Serializer;
+    typedef std::function<void(std::istream& Stream)> Deserializer;
+
+public:
+    static const uint16 FormatVersion;
+
+public:
+    /// NOTE
+    /// The file is written next to FilePath first, flushed to disk and
+    /// moved into place once complete, so an interrupted save or a crash
+    /// leaves the previous one intact. Returns false, leaving the previous
+    /// file in place, when it could not be written.
+    static bool SaveStream(const FString& FilePath,
+                           const GCryptoImpl& Crypto,
+                           const Serializer& Callback);
+
+    /// NOTE
+    /// Returns false, without invoking Callback, when the file is missing,
+    /// from another format version or its first frame fails verification.
+    /// Also returns false, after invoking Callback, when a later frame
+    /// fails verification, the file is truncated or the archive turns out
+    /// to be shorter or longer than recorded; whatever Callback read from
+    /// it must then be discarded.
+    static bool LoadStream(const FString& FilePath,
+                           const GCryptoImpl& Crypto,
+                           const Deserializer& Callback);
+
+    /// NOTE
+    /// Plain, uncompressed and unsigned; meant for inspecting saves only
+    static void ExportJsonStream(const FString& FilePath,
+                                 const Serializer& Callback);
+
+    template <typename... TYPES>
+    static bool Save(const FString& FilePath,
+                     const GCryptoImpl& Crypto,
+                     const TYPES&... Objects)
+    {
+        return SaveStream(FilePath, Crypto, [&](std::ostream& Stream)
+        {
+            cereal::PortableBinaryOutputArchive Archive(Stream);
+            Archive(Objects...);
+        });
+    }
+
+    template <typename... TYPES>
+    static bool Load(const FString& FilePath,
+                     const GCryptoImpl& Crypto,
+                     TYPES&... Out_Objects)
+    {
+        return LoadStream(FilePath, Crypto, [&](std::istream& Stream)
+        {
+            cereal::PortableBinaryInputArchive Archive(Stream);
+            Archive(Out_Objects...);
+        });
+    }
+
+    template <typename... TYPES>
+    static void ExportJson(const FString& FilePath, const TYPES&... Objects)
+    {
+        ExportJsonStream(FilePath, [&](std::ostream& Stream)
+        {
+            cereal::JSONOutputArchive Archive(Stream);
+            Archive(Objects...);
+        });
+    }
+};
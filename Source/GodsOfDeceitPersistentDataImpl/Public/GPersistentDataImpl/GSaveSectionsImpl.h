@@ -0,0 +1,173 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Sectioned save files with a table of contents, read through a memory map
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+THIRD_PARTY_INCLUDES_START
+#include <cereal/archives/portable_binary.hpp>
+THIRD_PARTY_INCLUDES_END
+
+class GCryptoImpl;
+
+/// NOTE
+/// File layout, integers are little-endian:
+///   header:   "GSEC", uint16 format version, uint16 reserved,
+///             uint64 table of contents offset, uint64 its size
+///   sections: stored back to back, each one compressed on its own
+///   toc:      portable binary list of name, codec, offset, stored size,
+///             raw size and HMAC-SHA512 of the stored bytes, followed by
+///             an HMAC-SHA512 of the list itself
+///
+/// Only the table of contents is verified up front; a section is verified
+/// and decoded the first time it is asked for.
+enum class EGSaveSectionCodec : uint8
+{
+    None,
+    Zlib
+};
+
+class GODSOFDECEITPERSISTENTDATAIMPL_API GSaveSectionWriterImpl
+{
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    /// NOTE
+    /// Sections are written as they get added, to a temporary file next to
+    /// FilePath that Finish() syncs and moves into place
+    GSaveSectionWriterImpl(const FString& FilePath, const GCryptoImpl& Crypto);
+    virtual ~GSaveSectionWriterImpl();
+
+public:
+    void AddSection(const FString& Name, const std::string& Data,
+                    const EGSaveSectionCodec Codec = EGSaveSectionCodec::Zlib);
+
+    template <typename... TYPES>
+    void AddObjects(const FString& Name, const EGSaveSectionCodec Codec,
+                    const TYPES&... Objects)
+    {
+        std::ostringstream Stream(std::ios::out | std::ios::binary);
+
+        {
+            cereal::PortableBinaryOutputArchive Archive(Stream);
+            Archive(Objects...);
+        }
+
+        AddSection(Name, Stream.str(), Codec);
+    }
+
+    /// NOTE
+    /// Returns false, removing the partial file and leaving any previous
+    /// save in place, when the file or any of its sections could not be
+    /// written
+    bool Finish();
+};
+
+class GODSOFDECEITPERSISTENTDATAIMPL_API GSaveSectionReaderImpl
+{
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    GSaveSectionReaderImpl(const FString& FilePath, const GCryptoImpl& Crypto);
+    virtual ~GSaveSectionReaderImpl();
+
+public:
+    /// NOTE
+    /// Maps the file and verifies its table of contents, returns false for
+    /// a missing, truncated or tampered file. Opening an open reader again
+    /// is a no-op.
+    bool Open();
+
+    std::vector<FString> GetSectionNames() const;
+    bool HasSection(const FString& Name) const;
+
+    /// NOTE
+    /// Decodes the section on first access and keeps the result; safe to
+    /// call from several threads, each section is decoded once. Returns
+    /// false for an unknown section or one that fails verification.
+    bool GetSection(const FString& Name, std::string& Out_Data);
+    /// NOTE
+    /// Same as GetSection() without the copy: the decoded buffer is shared
+    /// with the reader and stays valid for as long as it is held, even past
+    /// ReleaseSection(). Null where GetSection() would return false.
+    std::shared_ptr<const std::string> GetSectionData(const FString& Name);
+
+    template <typename... TYPES>
+    bool ReadObjects(const FString& Name, TYPES&... Out_Objects)
+    {
+        const std::shared_ptr<const std::string> Data(GetSectionData(Name));
+        if (!Data)
+        {
+            return false;
+        }
+
+        boost::iostreams::stream<boost::iostreams::array_source> Stream(
+                    Data->data(), Data->size());
+        cereal::PortableBinaryInputArchive Archive(Stream);
+        Archive(Out_Objects...);
+
+        return true;
+    }
+
+    /// NOTE
+    /// Decodes the given sections on a fixed set of worker threads,
+    /// independent sections in parallel; GetSection() on one of them blocks
+    /// until it is ready
+    void Prefetch(const std::vector<FString>& Names);
+    void WaitForPrefetch();
+
+    /// NOTE
+    /// Drops the decoded copy, the next access decodes it again
+    void ReleaseSection(const FString& Name);
+};
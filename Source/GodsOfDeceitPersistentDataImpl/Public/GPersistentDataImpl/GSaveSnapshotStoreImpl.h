@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Incremental saves: a base snapshot plus a chain of delta segments
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+THIRD_PARTY_INCLUDES_START
+#include <cereal/archives/portable_binary.hpp>
+THIRD_PARTY_INCLUDES_END
+
+class GCryptoImpl;
+
+/// NOTE
+/// Keeps the persistent records in memory, each one as its portable binary
+/// form, and remembers which of them changed since the last save. A save
+/// writes only those as a delta segment chained onto the current base
+/// snapshot, or a full snapshot once the chain grows too long. A background
+/// thread folds long chains back into a new base. Every segment and the
+/// manifest that lists the chain go through GSavePipelineImpl, so they are
+/// compressed, signed and replaced atomically.
+///
+/// SaveAsync() only captures the records on the calling thread. Records are
+/// sharded and every shard is shared copy-on-write with the capture, so this
+/// costs copying the shard pointers plus handing over the dirty keys, and
+/// the first change to a shard afterwards clones that shard alone;
+/// serialization, compression, signing and the file write then run on a
+/// worker thread.
+class GODSOFDECEITPERSISTENTDATAIMPL_API GSaveSnapshotStoreImpl
+{
+public:
+    struct Settings
+    {
+        /// NOTE
+        /// A save that would make the chain this long writes a full
+        /// snapshot instead
+        uint32 MaxDeltaChain;
+
+        /// NOTE
+        /// Chain length at which the background compaction kicks in, zero
+        /// disables it
+        uint32 CompactionThreshold;
+
+        Settings()
+            : MaxDeltaChain(16),
+              CompactionThreshold(4)
+        {
+
+        }
+    };
+
+    enum class ESaveKind : uint8
+    {
+        /// Nothing changed since the last save, nothing got written
+        None,
+        Delta,
+        Full
+    };
+
+    struct SaveReport
+    {
+        ESaveKind Kind;
+        uint64 Sequence;
+        uint64 RecordsWritten;
+        uint64 RecordsErased;
+        uint64 FileSize;
+        /// NOTE
+        /// False when the save could not be written. The chain on disk is
+        /// left as it was, the records stay dirty and the next save is a
+        /// full one.
+        bool bSucceeded;
+        /// NOTE
+        /// Time the calling thread spent capturing the records, which is
+        /// all a SaveAsync() stalls it for
+        std::chrono::microseconds CaptureTime;
+    };
+
+    typedef std::function<void(const SaveReport& Report)> SaveCallback;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    GSaveSnapshotStoreImpl(const FString& Directory,
+                           const GCryptoImpl& Crypto,
+                           const Settings& InSettings = Settings());
+    virtual ~GSaveSnapshotStoreImpl();
+
+public:
+    /// NOTE
+    /// Replays the base snapshot and its deltas from Directory, after any
+    /// pending saves are written. Returns
+    /// false, leaving the store empty, when there is no save yet or any
+    /// segment of the chain fails verification.
+    bool Load();
+
+    SaveReport Save();
+    SaveReport SaveFull();
+
+    /// NOTE
+    /// Captures the records and returns right away. Saves are written in
+    /// the order they were requested; OnComplete runs on the thread that
+    /// calls DispatchCompletions() after the save hit the disk.
+    void SaveAsync(const SaveCallback& OnComplete,
+                   const bool bForceFull = false);
+
+    /// NOTE
+    /// Meant to be called once per frame from the game thread; returns the
+    /// number of callbacks run
+    uint32 DispatchCompletions();
+
+    /// NOTE
+    /// Blocks until every requested save is on disk, completion callbacks
+    /// still need a DispatchCompletions()
+    void WaitForSaves();
+
+    /// NOTE
+    /// Blocks until a running compaction, if any, is done
+    void WaitForCompaction();
+
+    uint32 GetChainLength() const;
+    uint64 GetDirtyCount() const;
+
+    bool Contains(const FString& Key) const;
+    void Erase(const FString& Key);
+
+    /// NOTE
+    /// A record whose bytes did not change is not marked dirty
+    void PutRaw(const FString& Key, const std::string& Data);
+    bool GetRaw(const FString& Key, std::string& Out_Data) const;
+
+    template <typename TYPE>
+    void Put(const FString& Key, const TYPE& Record)
+    {
+        std::ostringstream Stream(std::ios::out | std::ios::binary);
+
+        {
+            cereal::PortableBinaryOutputArchive Archive(Stream);
+            Archive(Record);
+        }
+
+        PutRaw(Key, Stream.str());
+    }
+
+    template <typename TYPE>
+    bool Get(const FString& Key, TYPE& Out_Record) const
+    {
+        std::string Data;
+        if (!GetRaw(Key, Data))
+        {
+            return false;
+        }
+
+        std::istringstream Stream(Data, std::ios::in | std::ios::binary);
+        cereal::PortableBinaryInputArchive Archive(Stream);
+        Archive(Out_Record);
+
+        return true;
+    }
+};
@@ -0,0 +1,482 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Asynchronous, prioritized file I/O service
+ */
+
+
+#include "GPlatformImpl/GAsyncFileSystemImpl.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Misc/AssertionMacros.h>
+
+#define     GASYNC_FILESYSTEM_PRIORITIES        3
+
+namespace
+{
+    enum class ERequestKind : uint8
+    {
+        Read,
+        Write,
+        CopyFile,
+        Erase,
+        CreateDirectory
+    };
+
+    /// NOTE
+    /// Only requests that finish in a single metadata operation get
+    /// batched; a worker stuck on a large read or copy must not be holding
+    /// queued requests that an idle worker could run
+    bool IsBatchable(const ERequestKind Kind)
+    {
+        return Kind == ERequestKind::Erase
+                || Kind == ERequestKind::CreateDirectory;
+    }
+
+    struct Request
+    {
+        GAsyncFileSystemImpl::RequestId Id;
+        GAsyncFileSystemImpl::EResult Result;
+        ERequestKind Kind;
+
+        /// NOTE
+        /// Runs on a worker
+        std::function<GAsyncFileSystemImpl::EResult(Request&)> Operation;
+        /// NOTE
+        /// Runs from DispatchCompletions()
+        std::function<void(Request&)> Complete;
+
+        GFileSystemImpl::ReadView View;
+    };
+
+    typedef std::shared_ptr<Request> RequestPtr;
+}
+
+struct GAsyncFileSystemImpl::Impl
+{
+public:
+    const GAsyncFileSystemImpl::Settings Settings;
+
+    mutable std::mutex Lock;
+    std::condition_variable Condition;
+    std::condition_variable IdleCondition;
+
+    std::array<std::deque<RequestPtr>, GASYNC_FILESYSTEM_PRIORITIES> Queues;
+    std::unordered_map<GAsyncFileSystemImpl::RequestId, RequestPtr> Queued;
+    std::deque<RequestPtr> Completed;
+
+    GAsyncFileSystemImpl::RequestId NextId;
+    uint32 Running;
+    bool bStopping;
+
+    std::vector<std::thread> Workers;
+
+public:
+    explicit Impl(const GAsyncFileSystemImpl::Settings& InSettings);
+
+public:
+    GAsyncFileSystemImpl::RequestId Submit(
+            const GAsyncFileSystemImpl::EPriority Priority,
+            const ERequestKind Kind,
+            std::function<GAsyncFileSystemImpl::EResult(Request&)> Operation,
+            std::function<void(Request&)> Complete);
+    void Run();
+    bool TakeBatch(std::vector<RequestPtr>& Out_Batch);
+};
+
+GAsyncFileSystemImpl::GAsyncFileSystemImpl(const Settings& InSettings)
+    : Pimpl(std::make_unique<GAsyncFileSystemImpl::Impl>(InSettings))
+{
+    const uint32 Threads = std::max<uint32>(1, Pimpl->Settings.Threads);
+
+    for (uint32 i = 0; i < Threads; ++i)
+    {
+        Pimpl->Workers.emplace_back(&GAsyncFileSystemImpl::Impl::Run,
+                                    Pimpl.get());
+    }
+}
+
+GAsyncFileSystemImpl::~GAsyncFileSystemImpl()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        Pimpl->bStopping = true;
+    }
+
+    Pimpl->Condition.notify_all();
+
+    for (std::thread& Worker : Pimpl->Workers)
+    {
+        if (Worker.joinable())
+        {
+            Worker.join();
+        }
+    }
+}
+
+GAsyncFileSystemImpl::RequestId GAsyncFileSystemImpl::Read(
+        const FString& File, const ReadCallback& OnComplete,
+        const EPriority Priority)
+{
+    return Pimpl->Submit(
+                Priority,
+                ERequestKind::Read,
+                [File](Request& Current)
+    {
+        Current.View = GFileSystemImpl::TryOpenReadView(File);
+        return Current.View.IsValid() ? EResult::Succeeded : EResult::Failed;
+    },
+    [OnComplete](Request& Current)
+    {
+        if (OnComplete)
+        {
+            OnComplete(Current.Result, Current.View);
+        }
+    });
+}
+
+GAsyncFileSystemImpl::RequestId GAsyncFileSystemImpl::Write(
+        const FString& File, std::string Data,
+        const GFileSystemImpl::EWriteMode Mode,
+        const CompletionCallback& OnComplete, const EPriority Priority)
+{
+    std::shared_ptr<std::string> Buffer(
+                std::make_shared<std::string>(std::move(Data)));
+
+    return Pimpl->Submit(
+                Priority,
+                ERequestKind::Write,
+                [File, Buffer, Mode](Request& Current)
+    {
+        (void)Current;
+
+        return GFileSystemImpl::TryWrite(
+                    File, {GFileSystemImpl::WriteBuffer{Buffer->data(),
+                                                        Buffer->size()}},
+                    Mode) ? EResult::Succeeded : EResult::Failed;
+    },
+    [OnComplete](Request& Current)
+    {
+        if (OnComplete)
+        {
+            OnComplete(Current.Result);
+        }
+    });
+}
+
+GAsyncFileSystemImpl::RequestId GAsyncFileSystemImpl::CopyFile(
+        const FString& From, const FString& To,
+        const CompletionCallback& OnComplete, const EPriority Priority,
+        const GFileSystemImpl::CopyProgressCallback& OnProgress)
+{
+    return Pimpl->Submit(
+                Priority,
+                ERequestKind::CopyFile,
+                [From, To, OnProgress](Request& Current)
+    {
+        (void)Current;
+
+        if (!GFileSystemImpl::FileExists(From))
+        {
+            return EResult::Failed;
+        }
+
+        switch (GFileSystemImpl::CopyFile(From, To, true, OnProgress))
+        {
+
+        case GFileSystemImpl::ECopyResult::Succeeded:
+            return EResult::Succeeded;
+
+        case GFileSystemImpl::ECopyResult::Cancelled:
+            return EResult::Cancelled;
+
+        case GFileSystemImpl::ECopyResult::Failed:
+        default:
+            return EResult::Failed;
+
+        }
+    },
+    [OnComplete](Request& Current)
+    {
+        if (OnComplete)
+        {
+            OnComplete(Current.Result);
+        }
+    });
+}
+
+GAsyncFileSystemImpl::RequestId GAsyncFileSystemImpl::Erase(
+        const FString& Path, const CompletionCallback& OnComplete,
+        const EPriority Priority)
+{
+    return Pimpl->Submit(
+                Priority,
+                ERequestKind::Erase,
+                [Path](Request& Current)
+    {
+        (void)Current;
+
+        return GFileSystemImpl::TryErase(Path)
+                ? EResult::Succeeded : EResult::Failed;
+    },
+    [OnComplete](Request& Current)
+    {
+        if (OnComplete)
+        {
+            OnComplete(Current.Result);
+        }
+    });
+}
+
+GAsyncFileSystemImpl::RequestId GAsyncFileSystemImpl::CreateDirectory(
+        const FString& Directory, const CompletionCallback& OnComplete,
+        const EPriority Priority)
+{
+    return Pimpl->Submit(
+                Priority,
+                ERequestKind::CreateDirectory,
+                [Directory](Request& Current)
+    {
+        (void)Current;
+
+        return GFileSystemImpl::TryCreateDirectory(Directory)
+                ? EResult::Succeeded : EResult::Failed;
+    },
+    [OnComplete](Request& Current)
+    {
+        if (OnComplete)
+        {
+            OnComplete(Current.Result);
+        }
+    });
+}
+
+bool GAsyncFileSystemImpl::Cancel(const RequestId Id)
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        const auto It = Pimpl->Queued.find(Id);
+        if (It == Pimpl->Queued.end())
+        {
+            return false;
+        }
+
+        /// NOTE
+        /// The entry stays in its priority queue, workers skip requests
+        /// that are no longer in Queued
+        It->second->Result = EResult::Cancelled;
+        Pimpl->Completed.push_back(std::move(It->second));
+        Pimpl->Queued.erase(It);
+    }
+
+    Pimpl->IdleCondition.notify_all();
+
+    return true;
+}
+
+uint32 GAsyncFileSystemImpl::DispatchCompletions()
+{
+    std::deque<RequestPtr> Completed;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+        (void)LockGuard;
+
+        Completed.swap(Pimpl->Completed);
+    }
+
+    for (const RequestPtr& Current : Completed)
+    {
+        Current->Complete(*Current);
+    }
+
+    return static_cast<uint32>(Completed.size());
+}
+
+void GAsyncFileSystemImpl::WaitForAll()
+{
+    std::unique_lock<std::mutex> UniqueLock(Pimpl->Lock);
+
+    Pimpl->IdleCondition.wait(UniqueLock, [this]
+    {
+        return Pimpl->Queued.empty() && Pimpl->Running == 0;
+    });
+}
+
+uint32 GAsyncFileSystemImpl::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    return static_cast<uint32>(Pimpl->Queued.size()) + Pimpl->Running;
+}
+
+GAsyncFileSystemImpl::Impl::Impl(
+        const GAsyncFileSystemImpl::Settings& InSettings)
+    : Settings(InSettings),
+      NextId(0),
+      Running(0),
+      bStopping(false)
+{
+
+}
+
+GAsyncFileSystemImpl::RequestId GAsyncFileSystemImpl::Impl::Submit(
+        const GAsyncFileSystemImpl::EPriority Priority,
+        const ERequestKind Kind,
+        std::function<GAsyncFileSystemImpl::EResult(Request&)> Operation,
+        std::function<void(Request&)> Complete)
+{
+    RequestPtr Current(std::make_shared<Request>());
+    Current->Result = GAsyncFileSystemImpl::EResult::Failed;
+    Current->Kind = Kind;
+    Current->Operation = std::move(Operation);
+    Current->Complete = std::move(Complete);
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        checkf(!bStopping,
+               TEXT("FATAL: I/O request submitted during shutdown!"));
+
+        Current->Id = ++NextId;
+        Queued.emplace(Current->Id, Current);
+        Queues[static_cast<std::size_t>(Priority)].push_back(Current);
+    }
+
+    Condition.notify_one();
+
+    return Current->Id;
+}
+
+void GAsyncFileSystemImpl::Impl::Run()
+{
+    std::vector<RequestPtr> Batch;
+
+    while (TakeBatch(Batch))
+    {
+        for (const RequestPtr& Current : Batch)
+        {
+            Current->Result = Current->Operation(*Current);
+        }
+
+        {
+            std::lock_guard<std::mutex> LockGuard(Lock);
+            (void)LockGuard;
+
+            for (RequestPtr& Current : Batch)
+            {
+                Completed.push_back(std::move(Current));
+            }
+
+            Running -= static_cast<uint32>(Batch.size());
+        }
+
+        Batch.clear();
+        IdleCondition.notify_all();
+    }
+}
+
+bool GAsyncFileSystemImpl::Impl::TakeBatch(std::vector<RequestPtr>& Out_Batch)
+{
+    std::unique_lock<std::mutex> UniqueLock(Lock);
+
+    Condition.wait(UniqueLock, [this]
+    {
+        return bStopping || !Queued.empty();
+    });
+
+    if (Queued.empty())
+    {
+        /// NOTE
+        /// Only reached when stopping, queued work is always drained first
+        return false;
+    }
+
+    const std::size_t BatchSize = std::max<uint32>(1, Settings.BatchSize);
+
+    for (std::size_t Priority = GASYNC_FILESYSTEM_PRIORITIES; Priority > 0
+         && Out_Batch.empty(); --Priority)
+    {
+        std::deque<RequestPtr>& Queue = Queues[Priority - 1];
+
+        while (!Queue.empty() && Out_Batch.size() < BatchSize)
+        {
+            /// NOTE
+            /// Cancelled requests are dropped on the way; after the first
+            /// one the batch only grows by requests of the same batchable
+            /// kind, anything else stays queued for the next worker
+            if (Queued.find(Queue.front()->Id) == Queued.end())
+            {
+                Queue.pop_front();
+                continue;
+            }
+
+            if (!Out_Batch.empty()
+                    && (!IsBatchable(Out_Batch.front()->Kind)
+                        || Queue.front()->Kind != Out_Batch.front()->Kind))
+            {
+                break;
+            }
+
+            RequestPtr Current(std::move(Queue.front()));
+            Queue.pop_front();
+            Queued.erase(Current->Id);
+            Out_Batch.push_back(std::move(Current));
+        }
+    }
+
+    Running += static_cast<uint32>(Out_Batch.size());
+
+    /// NOTE
+    /// Leave the rest of the queue to the other workers
+    if (!Queued.empty())
+    {
+        Condition.notify_one();
+    }
+
+    return true;
+}
@@ -0,0 +1,475 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Parallel recursive directory scanner with filters
+ */
+
+
+#include "GPlatformImpl/GDirectoryScannerImpl.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <Containers/StringConv.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+namespace
+{
+    char ToLower(const char Character)
+    {
+        return static_cast<char>(
+                    std::tolower(static_cast<unsigned char>(Character)));
+    }
+
+    std::string ToLower(std::string Value)
+    {
+        std::transform(Value.begin(), Value.end(), Value.begin(),
+                       [](const char Character)
+        {
+            return ToLower(Character);
+        });
+
+        return Value;
+    }
+
+    /// NOTE
+    /// Case-insensitive, like the extension filter
+    bool MatchesGlob(const char* Pattern, const char* Name)
+    {
+        const char* Star = nullptr;
+        const char* Resume = nullptr;
+
+        while (*Name != '\0')
+        {
+            if (*Pattern == '*')
+            {
+                Star = Pattern++;
+                Resume = Name;
+            }
+            else if (*Pattern == '?' || ToLower(*Pattern) == ToLower(*Name))
+            {
+                ++Pattern;
+                ++Name;
+            }
+            else if (Star != nullptr)
+            {
+                /// NOTE
+                /// Let the last '*' swallow one more character
+                Pattern = Star + 1;
+                Name = ++Resume;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (*Pattern == '*')
+        {
+            ++Pattern;
+        }
+
+        return *Pattern == '\0';
+    }
+
+    /// NOTE
+    /// With bCollectStats a single lstat() yields the entry's type, size
+    /// and modification time. Windows takes the type from the directory
+    /// listing and the rest from one stat().
+    bool StatEntry(const boost::filesystem::directory_entry& Entry,
+                   const bool bCollectStats,
+                   boost::filesystem::file_status& Out_Status,
+                   GDirectoryScannerImpl::Entry& Out_Entry)
+    {
+        Out_Entry.Size = 0;
+        Out_Entry.LastWriteTime = 0;
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        boost::system::error_code ErrorCode;
+        Out_Status = Entry.symlink_status(ErrorCode);
+        if (ErrorCode)
+        {
+            return false;
+        }
+
+        struct _stat64 Info;
+        if (bCollectStats && _wstat64(Entry.path().c_str(), &Info) == 0)
+        {
+            Out_Entry.Size = boost::filesystem::is_regular_file(Out_Status)
+                    ? static_cast<uint64>(Info.st_size) : 0;
+            Out_Entry.LastWriteTime = static_cast<std::time_t>(Info.st_mtime);
+        }
+#else
+        if (!bCollectStats)
+        {
+            boost::system::error_code ErrorCode;
+            Out_Status = Entry.symlink_status(ErrorCode);
+            return !ErrorCode;
+        }
+
+        struct stat Info;
+        if (lstat(Entry.path().c_str(), &Info) != 0)
+        {
+            return false;
+        }
+
+        boost::filesystem::file_type Type = boost::filesystem::type_unknown;
+        if (S_ISREG(Info.st_mode))
+        {
+            Type = boost::filesystem::regular_file;
+            Out_Entry.Size = static_cast<uint64>(Info.st_size);
+        }
+        else if (S_ISDIR(Info.st_mode))
+        {
+            Type = boost::filesystem::directory_file;
+        }
+        else if (S_ISLNK(Info.st_mode))
+        {
+            Type = boost::filesystem::symlink_file;
+        }
+
+        Out_Status = boost::filesystem::file_status(Type);
+        Out_Entry.LastWriteTime = static_cast<std::time_t>(Info.st_mtime);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+
+        return true;
+    }
+
+    struct Scanner
+    {
+    public:
+        const GDirectoryScannerImpl::Settings& Settings;
+        const GDirectoryScannerImpl::ScanCallback& OnEntries;
+
+        std::string Pattern;
+        std::vector<std::string> Extensions;
+
+        std::mutex Lock;
+        std::condition_variable Condition;
+        std::deque<boost::filesystem::path> Pending;
+        uint32 Active;
+        uint64 Errors;
+        std::exception_ptr Error;
+        bool bStopping;
+
+        std::mutex CallbackLock;
+        uint64 Reported;
+
+    public:
+        Scanner(const GDirectoryScannerImpl::Settings& InSettings,
+                const GDirectoryScannerImpl::ScanCallback& InOnEntries)
+            : Settings(InSettings),
+              OnEntries(InOnEntries),
+              Pattern(StringCast<ANSICHAR>(*InSettings.Pattern).Get()),
+              Active(0),
+              Errors(0),
+              bStopping(false),
+              Reported(0)
+        {
+            for (const FString& Extension : InSettings.Extensions)
+            {
+                Extensions.push_back(
+                            ToLower(StringCast<ANSICHAR>(*Extension).Get()));
+            }
+        }
+
+    public:
+        void Run()
+        {
+            boost::filesystem::path Directory;
+
+            while (Take(Directory))
+            {
+                /// NOTE
+                /// Nothing may escape a worker; the first error stops the
+                /// scan and Scan() rethrows it once every worker is done
+                try
+                {
+                    ScanDirectory(Directory);
+                }
+
+                catch (...)
+                {
+                    Stop(std::current_exception());
+                }
+
+                {
+                    std::lock_guard<std::mutex> LockGuard(Lock);
+                    (void)LockGuard;
+
+                    --Active;
+                }
+
+                Condition.notify_all();
+            }
+        }
+
+        void Stop(const std::exception_ptr& Exception)
+        {
+            {
+                std::lock_guard<std::mutex> LockGuard(Lock);
+                (void)LockGuard;
+
+                if (!Error)
+                {
+                    Error = Exception;
+                }
+
+                bStopping = true;
+                Pending.clear();
+            }
+
+            Condition.notify_all();
+        }
+
+    private:
+        bool Take(boost::filesystem::path& Out_Directory)
+        {
+            std::unique_lock<std::mutex> UniqueLock(Lock);
+
+            /// NOTE
+            /// An empty queue only means done once no worker can add to it
+            Condition.wait(UniqueLock, [this]
+            {
+                return bStopping || !Pending.empty() || Active == 0;
+            });
+
+            if (bStopping || Pending.empty())
+            {
+                return false;
+            }
+
+            Out_Directory = std::move(Pending.front());
+            Pending.pop_front();
+            ++Active;
+
+            return true;
+        }
+
+        bool Matches(const boost::filesystem::path& Path,
+                     const bool bDirectory) const
+        {
+            if (!Pattern.empty()
+                    && !MatchesGlob(Pattern.c_str(),
+                                    Path.filename().string().c_str()))
+            {
+                return false;
+            }
+
+            if (bDirectory || Extensions.empty())
+            {
+                return true;
+            }
+
+            const std::string Extension(ToLower(Path.extension().string()));
+            return std::find(Extensions.begin(), Extensions.end(), Extension)
+                    != Extensions.end();
+        }
+
+        void ScanDirectory(const boost::filesystem::path& Directory)
+        {
+            std::vector<GDirectoryScannerImpl::Entry> Entries;
+            std::vector<boost::filesystem::path> Subdirectories;
+
+            uint64 DirectoryErrors = 0;
+
+            boost::system::error_code ErrorCode;
+            boost::filesystem::directory_iterator It(Directory, ErrorCode);
+
+            for (; !ErrorCode && It != boost::filesystem::directory_iterator();
+                 It.increment(ErrorCode))
+            {
+                const boost::filesystem::path& Path = It->path();
+                boost::filesystem::file_status Status;
+                GDirectoryScannerImpl::Entry Result;
+                if (!StatEntry(*It, Settings.bCollectStats, Status, Result))
+                {
+                    ++DirectoryErrors;
+                    continue;
+                }
+
+                const bool bDirectory =
+                        boost::filesystem::is_directory(Status);
+
+                if (bDirectory && Settings.bRecursive)
+                {
+                    Subdirectories.push_back(Path);
+                }
+
+                if ((bDirectory && !Settings.bIncludeDirectories)
+                        || !Matches(Path, bDirectory))
+                {
+                    continue;
+                }
+
+                Result.Path = StringCast<WIDECHAR>(Path.string().c_str()).Get();
+                Result.bDirectory = bDirectory;
+
+                Entries.push_back(std::move(Result));
+            }
+
+            /// NOTE
+            /// Covers a directory that could not be opened as well as a
+            /// listing cut short by a failed increment
+            if (ErrorCode)
+            {
+                ++DirectoryErrors;
+            }
+
+            if (!Subdirectories.empty() || DirectoryErrors > 0)
+            {
+                {
+                    std::lock_guard<std::mutex> LockGuard(Lock);
+                    (void)LockGuard;
+
+                    Errors += DirectoryErrors;
+
+                    if (!bStopping)
+                    {
+                        for (boost::filesystem::path& Subdirectory
+                             : Subdirectories)
+                        {
+                            Pending.push_back(std::move(Subdirectory));
+                        }
+                    }
+                }
+
+                Condition.notify_all();
+            }
+
+            if (!Entries.empty())
+            {
+                std::lock_guard<std::mutex> LockGuard(CallbackLock);
+                (void)LockGuard;
+
+                Reported += Entries.size();
+
+                if (OnEntries)
+                {
+                    OnEntries(Entries);
+                }
+            }
+        }
+    };
+}
+
+uint64 GDirectoryScannerImpl::Scan(const FString& Root,
+                                   const Settings& InSettings,
+                                   const ScanCallback& OnEntries)
+{
+    uint64 Errors = 0;
+    return Scan(Root, InSettings, OnEntries, Errors);
+}
+
+uint64 GDirectoryScannerImpl::Scan(const FString& Root,
+                                   const Settings& InSettings,
+                                   const ScanCallback& OnEntries,
+                                   uint64& Out_Errors)
+{
+    Out_Errors = 0;
+
+    boost::filesystem::path RootPath(StringCast<ANSICHAR>(*Root).Get());
+
+    boost::system::error_code ErrorCode;
+    if (!boost::filesystem::is_directory(RootPath, ErrorCode))
+    {
+        return 0;
+    }
+
+    Scanner Context(InSettings, OnEntries);
+    Context.Pending.push_back(RootPath);
+
+    uint32 Threads = InSettings.Threads;
+    if (Threads == 0)
+    {
+        Threads = std::max<uint32>(1, std::thread::hardware_concurrency());
+    }
+
+    /// NOTE
+    /// A flat scan has a single directory, extra threads would only idle
+    if (!InSettings.bRecursive)
+    {
+        Threads = 1;
+    }
+
+    std::vector<std::thread> Workers;
+    Workers.reserve(Threads - 1);
+
+    /// NOTE
+    /// Running out of threads only makes the scan narrower
+    try
+    {
+        for (uint32 i = 1; i < Threads; ++i)
+        {
+            Workers.emplace_back(&Scanner::Run, &Context);
+        }
+    }
+
+    catch (const std::system_error&)
+    {
+
+    }
+
+    /// NOTE
+    /// The calling thread works too
+    Context.Run();
+
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    Out_Errors = Context.Errors;
+
+    if (Context.Error)
+    {
+        std::rethrow_exception(Context.Error);
+    }
+
+    return Context.Reported;
+}
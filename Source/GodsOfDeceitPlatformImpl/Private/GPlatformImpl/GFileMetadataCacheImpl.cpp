@@ -0,0 +1,539 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Filesystem metadata cache invalidated through inotify
+ */
+
+
+#include "GPlatformImpl/GFileMetadataCacheImpl.h"
+
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#if defined ( __linux__ )
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  /* defined ( __linux__ ) */
+
+#include <Containers/StringConv.h>
+
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include "GPlatformImpl/GFileSystemImpl.h"
+
+#define     GFILE_METADATA_CACHE_EVENT_BUFFER_SIZE      (16 * 1024)
+
+#if defined ( __linux__ )
+#define     GFILE_METADATA_CACHE_WATCH_MASK             \
+    (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB     \
+    | IN_MODIFY | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF         \
+    | IN_ONLYDIR)
+#endif  /* defined ( __linux__ ) */
+
+namespace
+{
+    struct Entry
+    {
+        bool bExists;
+        bool bDirectory;
+        bool bRegularFile;
+        std::size_t Size;
+    };
+
+    std::string ToKey(const FString& Path)
+    {
+        std::string Key(StringCast<ANSICHAR>(*Path).Get());
+
+        while (Key.size() > 1 && (Key.back() == '/' || Key.back() == '\\'))
+        {
+            Key.pop_back();
+        }
+
+        return Key;
+    }
+
+    std::string GetParentKey(const std::string& Key)
+    {
+        return boost::filesystem::path(Key).parent_path().string();
+    }
+
+    std::string GetChildKey(const std::string& Directory,
+                            const char* const Name)
+    {
+        return (!Directory.empty() && Directory.back() == '/')
+                ? Directory + Name : Directory + "/" + Name;
+    }
+
+    /// NOTE
+    /// One stat() answers all three questions about an entry
+    Entry StatPath(const std::string& Key)
+    {
+        Entry Result;
+
+#if defined ( __linux__ )
+        struct stat Status;
+        Result.bExists = (stat(Key.c_str(), &Status) == 0);
+        Result.bDirectory = Result.bExists && S_ISDIR(Status.st_mode);
+        Result.bRegularFile = Result.bExists && S_ISREG(Status.st_mode);
+        Result.Size = Result.bRegularFile
+                ? static_cast<std::size_t>(Status.st_size) : 0;
+#else
+        boost::system::error_code ErrorCode;
+        const boost::filesystem::file_status Status(
+                    boost::filesystem::status(Key, ErrorCode));
+        Result.bExists = boost::filesystem::exists(Status);
+        Result.bDirectory = boost::filesystem::is_directory(Status);
+        Result.bRegularFile = boost::filesystem::is_regular_file(Status);
+        Result.Size = Result.bRegularFile
+                ? static_cast<std::size_t>(
+                      boost::filesystem::file_size(Key, ErrorCode))
+                : 0;
+        if (ErrorCode)
+        {
+            Result.Size = 0;
+        }
+#endif  /* defined ( __linux__ ) */
+
+        return Result;
+    }
+}
+
+struct GFileMetadataCacheImpl::Impl
+{
+public:
+    mutable std::mutex Lock;
+
+    std::unordered_map<std::string, Entry> Entries;
+    std::unordered_map<std::string, int> Watches;
+    std::unordered_map<int, std::string> WatchedDirectories;
+
+    /// NOTE
+    /// Bumped by every invalidation, a lookup only caches what it stat'ed
+    /// if nothing was invalidated in the meantime
+    uint64 Generation;
+    GFileMetadataCacheImpl::Stats Counters;
+
+#if defined ( __linux__ )
+    int Notify;
+    int Wakeup;
+    std::thread EventThread;
+
+    /// NOTE
+    /// Set once the event thread gave up, no directory is watched after it
+    bool bEventsFailed;
+#endif  /* defined ( __linux__ ) */
+
+public:
+    Impl();
+
+public:
+    /// NOTE
+    /// Returns false for paths outside every watched directory
+    bool Lookup(const FString& Path, Entry& Out_Entry);
+    void EraseChildren(const std::string& Directory);
+
+#if defined ( __linux__ )
+    void RunEvents();
+    void HandleEvent(const inotify_event& Event);
+    void DropWatches();
+#endif  /* defined ( __linux__ ) */
+};
+
+GFileMetadataCacheImpl::GFileMetadataCacheImpl()
+    : Pimpl(std::make_unique<GFileMetadataCacheImpl::Impl>())
+{
+#if defined ( __linux__ )
+    if (Pimpl->Notify >= 0 && Pimpl->Wakeup >= 0)
+    {
+        Pimpl->EventThread = std::thread(
+                    &GFileMetadataCacheImpl::Impl::RunEvents, Pimpl.get());
+    }
+#endif  /* defined ( __linux__ ) */
+}
+
+GFileMetadataCacheImpl::~GFileMetadataCacheImpl()
+{
+#if defined ( __linux__ )
+    if (Pimpl->EventThread.joinable())
+    {
+        const uint64_t Signal = 1;
+        (void)write(Pimpl->Wakeup, &Signal, sizeof(Signal));
+        Pimpl->EventThread.join();
+    }
+
+    if (Pimpl->Notify >= 0)
+    {
+        close(Pimpl->Notify);
+    }
+
+    if (Pimpl->Wakeup >= 0)
+    {
+        close(Pimpl->Wakeup);
+    }
+#endif  /* defined ( __linux__ ) */
+}
+
+bool GFileMetadataCacheImpl::Watch(const FString& Directory)
+{
+#if defined ( __linux__ )
+    const std::string Key(ToKey(Directory));
+
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    if (Pimpl->Watches.find(Key) != Pimpl->Watches.end())
+    {
+        return true;
+    }
+
+    if (!Pimpl->EventThread.joinable() || Pimpl->bEventsFailed)
+    {
+        return false;
+    }
+
+    const int Descriptor = inotify_add_watch(Pimpl->Notify, Key.c_str(),
+                                             GFILE_METADATA_CACHE_WATCH_MASK);
+    if (Descriptor < 0)
+    {
+        return false;
+    }
+
+    Pimpl->Watches[Key] = Descriptor;
+    Pimpl->WatchedDirectories[Descriptor] = Key;
+    Pimpl->Counters.WatchedDirectories = Pimpl->Watches.size();
+
+    return true;
+#else
+    (void)Directory;
+    return false;
+#endif  /* defined ( __linux__ ) */
+}
+
+void GFileMetadataCacheImpl::Unwatch(const FString& Directory)
+{
+#if defined ( __linux__ )
+    const std::string Key(ToKey(Directory));
+
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    const auto It = Pimpl->Watches.find(Key);
+    if (It == Pimpl->Watches.end())
+    {
+        return;
+    }
+
+    (void)inotify_rm_watch(Pimpl->Notify, It->second);
+    Pimpl->WatchedDirectories.erase(It->second);
+    Pimpl->Watches.erase(It);
+    Pimpl->Counters.WatchedDirectories = Pimpl->Watches.size();
+
+    Pimpl->EraseChildren(Key);
+    Pimpl->Entries.erase(Key);
+    ++Pimpl->Generation;
+#else
+    (void)Directory;
+#endif  /* defined ( __linux__ ) */
+}
+
+bool GFileMetadataCacheImpl::DirectoryExists(const FString& Directory)
+{
+    Entry Cached;
+    if (!Pimpl->Lookup(Directory, Cached))
+    {
+        return GFileSystemImpl::DirectoryExists(Directory);
+    }
+
+    return Cached.bDirectory;
+}
+
+bool GFileMetadataCacheImpl::FileExists(const FString& File)
+{
+    Entry Cached;
+    if (!Pimpl->Lookup(File, Cached))
+    {
+        return GFileSystemImpl::FileExists(File);
+    }
+
+    return Cached.bRegularFile;
+}
+
+std::size_t GFileMetadataCacheImpl::GetFileSize(const FString& File)
+{
+    Entry Cached;
+    if (!Pimpl->Lookup(File, Cached) || !Cached.bRegularFile)
+    {
+        /// NOTE
+        /// Missing files take the uncached path and its error reporting
+        return GFileSystemImpl::GetFileSize(File);
+    }
+
+    return Cached.Size;
+}
+
+void GFileMetadataCacheImpl::Invalidate()
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    Pimpl->Entries.clear();
+    ++Pimpl->Generation;
+    ++Pimpl->Counters.Invalidations;
+}
+
+GFileMetadataCacheImpl::Stats GFileMetadataCacheImpl::GetStats() const
+{
+    std::lock_guard<std::mutex> LockGuard(Pimpl->Lock);
+    (void)LockGuard;
+
+    Stats Result(Pimpl->Counters);
+    Result.Entries = Pimpl->Entries.size();
+
+    return Result;
+}
+
+GFileMetadataCacheImpl::Impl::Impl()
+    : Generation(0)
+{
+    Counters.Hits = 0;
+    Counters.Misses = 0;
+    Counters.Bypasses = 0;
+    Counters.Invalidations = 0;
+    Counters.Entries = 0;
+    Counters.WatchedDirectories = 0;
+
+#if defined ( __linux__ )
+    Notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    Wakeup = eventfd(0, EFD_CLOEXEC);
+    bEventsFailed = false;
+#endif  /* defined ( __linux__ ) */
+}
+
+bool GFileMetadataCacheImpl::Impl::Lookup(const FString& Path,
+                                          Entry& Out_Entry)
+{
+    const std::string Key(ToKey(Path));
+    uint64 LookupGeneration = 0;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        if (Watches.find(GetParentKey(Key)) == Watches.end()
+                && Watches.find(Key) == Watches.end())
+        {
+            ++Counters.Bypasses;
+            return false;
+        }
+
+        const auto It = Entries.find(Key);
+        if (It != Entries.end())
+        {
+            ++Counters.Hits;
+            Out_Entry = It->second;
+            return true;
+        }
+
+        ++Counters.Misses;
+        LookupGeneration = Generation;
+    }
+
+    Out_Entry = StatPath(Key);
+
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    (void)LockGuard;
+
+    if (LookupGeneration == Generation)
+    {
+        Entries[Key] = Out_Entry;
+    }
+
+    return true;
+}
+
+void GFileMetadataCacheImpl::Impl::EraseChildren(const std::string& Directory)
+{
+    for (auto It = Entries.begin(); It != Entries.end();)
+    {
+        if (GetParentKey(It->first) == Directory)
+        {
+            It = Entries.erase(It);
+        }
+        else
+        {
+            ++It;
+        }
+    }
+}
+
+#if defined ( __linux__ )
+void GFileMetadataCacheImpl::Impl::RunEvents()
+{
+    alignas(inotify_event) char Buffer[GFILE_METADATA_CACHE_EVENT_BUFFER_SIZE];
+
+    pollfd Descriptors[2];
+    Descriptors[0].fd = Notify;
+    Descriptors[0].events = POLLIN;
+    Descriptors[1].fd = Wakeup;
+    Descriptors[1].events = POLLIN;
+
+    for (;;)
+    {
+        Descriptors[0].revents = 0;
+        Descriptors[1].revents = 0;
+
+        if (poll(Descriptors, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            /// NOTE
+            /// Without events nothing cached can be trusted; every lookup
+            /// bypasses the cache from now on
+            DropWatches();
+            return;
+        }
+
+        if (Descriptors[1].revents != 0)
+        {
+            return;
+        }
+
+        const ssize_t Count = read(Notify, Buffer, sizeof(Buffer));
+        if (Count < 0 && errno != EINTR && errno != EAGAIN)
+        {
+            DropWatches();
+            return;
+        }
+
+        if (Count <= 0)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> LockGuard(Lock);
+        (void)LockGuard;
+
+        for (ssize_t Offset = 0; Offset < Count;)
+        {
+            const inotify_event& Event =
+                    *reinterpret_cast<const inotify_event*>(Buffer + Offset);
+            HandleEvent(Event);
+            Offset += static_cast<ssize_t>(sizeof(inotify_event) + Event.len);
+        }
+    }
+}
+
+void GFileMetadataCacheImpl::Impl::HandleEvent(const inotify_event& Event)
+{
+    ++Generation;
+    ++Counters.Invalidations;
+
+    if ((Event.mask & IN_Q_OVERFLOW) != 0)
+    {
+        /// NOTE
+        /// Events were lost, nothing cached can be trusted anymore
+        Entries.clear();
+        return;
+    }
+
+    const auto It = WatchedDirectories.find(Event.wd);
+    if (It == WatchedDirectories.end())
+    {
+        return;
+    }
+
+    const std::string Directory(It->second);
+
+    if (Event.len > 0)
+    {
+        Entries.erase(GetChildKey(Directory, Event.name));
+    }
+
+    if ((Event.mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0)
+    {
+        EraseChildren(Directory);
+        Entries.erase(Directory);
+    }
+
+    if ((Event.mask & IN_MOVE_SELF) != 0)
+    {
+        /// NOTE
+        /// The watch follows the inode to wherever it moved, so it no
+        /// longer stands for this path; lookups under it bypass the cache
+        /// from now on. The IN_IGNORED that follows finds no directory.
+        (void)inotify_rm_watch(Notify, Event.wd);
+    }
+
+    if ((Event.mask & (IN_MOVE_SELF | IN_IGNORED)) != 0)
+    {
+        /// NOTE
+        /// Either the watch was removed above or the kernel dropped it
+        /// because the directory is gone
+        Watches.erase(Directory);
+        WatchedDirectories.erase(It);
+        Counters.WatchedDirectories = Watches.size();
+    }
+}
+
+void GFileMetadataCacheImpl::Impl::DropWatches()
+{
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    (void)LockGuard;
+
+    for (const auto& Watch : Watches)
+    {
+        (void)inotify_rm_watch(Notify, Watch.second);
+    }
+
+    Watches.clear();
+    WatchedDirectories.clear();
+    Entries.clear();
+    bEventsFailed = true;
+    ++Generation;
+    ++Counters.Invalidations;
+    Counters.WatchedDirectories = 0;
+}
+#endif  /* defined ( __linux__ ) */
@@ -35,38 +35,814 @@
 
 #include "GPlatformImpl/GFileSystemImpl.h"
 
+#include <algorithm>
 #include <fstream>
-#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#if defined ( __linux__ )
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/falloc.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif  /* defined ( __linux__ ) */
 
 #include <Containers/StringConv.h>
 #include <Misc/AssertionMacros.h>
 
-#include <GHacks/GUndef_check.h>
-THIRD_PARTY_INCLUDES_START
-#include <boost/filesystem/exception.hpp>
-#include <boost/filesystem/operations.hpp>
-#include <boost/filesystem/path.hpp>
-THIRD_PARTY_INCLUDES_END
-#include <GHacks/GRestore_check.h>
+#include <GHacks/GUndef_check.h>
+THIRD_PARTY_INCLUDES_START
+#include <boost/filesystem/exception.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+THIRD_PARTY_INCLUDES_END
+#include <GHacks/GRestore_check.h>
+
+#include <GHacks/GInclude_Windows.h>
+
+#include "GPlatformImpl/GPathBuilderImpl.h"
+
+#define  GFILESYSTEM_ERROR_DIALOG_TITLE "IO Error"
+#define  GFILESYSTEM_UNKNOWN_ERROR      "GFileSystem: unknown error!"
+#define  GFILESYSTEM_WRITE_ERROR        "GFileSystem: failed to write file!"
+#define  GFILESYSTEM_READ_ERROR         "GFileSystem: failed to read file!"
+#define  GFILESYSTEM_DECODE_ERROR       "GFileSystem: file too large to decode!"
+#define  GFILESYSTEM_PARTIAL_SUFFIX     ".partial"
+#define  GFILESYSTEM_PARTIAL_PATTERN    ".%%%%%%%%%%%%"
+#define  GFILESYSTEM_MAX_IO_VECTORS     1024
+#define  GFILESYSTEM_COPY_CHUNK_SIZE    (8 * 1024 * 1024)
+#define  GFILESYSTEM_COPY_BUFFER_SIZE   (1024 * 1024)
+
+namespace
+{
+    /// NOTE
+    /// Reads the whole file with a single sized buffer instead of growing
+    /// a string one character at a time
+    bool ReadWhole(const FString& File, std::string& Out_Data)
+    {
+        Out_Data.clear();
+
+#if defined ( __linux__ )
+        const int Descriptor = open(StringCast<ANSICHAR>(*File).Get(),
+                                    O_RDONLY | O_CLOEXEC);
+        if (Descriptor < 0)
+        {
+            return false;
+        }
+
+        struct stat Status;
+        if (fstat(Descriptor, &Status) != 0)
+        {
+            close(Descriptor);
+            return false;
+        }
+
+        Out_Data.resize(static_cast<std::size_t>(Status.st_size));
+
+        std::size_t Offset = 0;
+        while (Offset < Out_Data.size())
+        {
+            const ssize_t Count = pread(Descriptor, &Out_Data[Offset],
+                                        Out_Data.size() - Offset,
+                                        static_cast<off_t>(Offset));
+            if (Count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (Count <= 0)
+            {
+                break;
+            }
+
+            Offset += static_cast<std::size_t>(Count);
+        }
+
+        close(Descriptor);
+        Out_Data.resize(Offset);
+#else
+        std::ifstream InputFileStream(StringCast<ANSICHAR>(*File).Get(),
+                                      std::ios::in | std::ios::binary
+                                      | std::ios::ate);
+        if (!InputFileStream.is_open())
+        {
+            return false;
+        }
+
+        const std::streamoff Size = InputFileStream.tellg();
+        InputFileStream.seekg(0, std::ios::beg);
+
+        if (Size > 0)
+        {
+            Out_Data.resize(static_cast<std::size_t>(Size));
+            InputFileStream.read(&Out_Data[0],
+                                 static_cast<std::streamsize>(Size));
+            Out_Data.resize(
+                        static_cast<std::size_t>(InputFileStream.gcount()));
+        }
+#endif  /* defined ( __linux__ ) */
+
+        return true;
+    }
+
+#if defined ( __linux__ )
+    void ThrowLastError(const int Descriptor)
+    {
+        const int Error = errno;
+
+        if (Descriptor >= 0)
+        {
+            close(Descriptor);
+        }
+
+        throw std::system_error(Error, std::generic_category(),
+                                GFILESYSTEM_WRITE_ERROR);
+    }
+#endif  /* defined ( __linux__ ) */
+
+    /// NOTE
+    /// Forces a file that is already written and closed down to the disk.
+    /// FlushFileBuffers() flushes the file no matter which handle it is
+    /// called on, so the one it was written through needs not be kept.
+    void SyncFile(const FString& File)
+    {
+#if defined ( __linux__ )
+        const int Descriptor = open(StringCast<ANSICHAR>(*File).Get(),
+                                    O_RDONLY | O_CLOEXEC);
+        if (Descriptor < 0 || fsync(Descriptor) != 0)
+        {
+            ThrowLastError(Descriptor);
+        }
+
+        close(Descriptor);
+#elif defined ( _WIN32 ) || defined ( _WIN64 )
+        const HANDLE Handle = CreateFileA(
+                    StringCast<ANSICHAR>(*File).Get(), GENERIC_WRITE,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (Handle == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+
+        const BOOL bFlushed = FlushFileBuffers(Handle);
+        CloseHandle(Handle);
+
+        if (!bFlushed)
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+#else
+        /// NOTE
+        /// Elsewhere the data is only handed to the operating system
+        (void)File;
+#endif  /* defined ( __linux__ ) */
+    }
+
+    void WriteBuffers(const FString& File,
+                      const std::vector<GFileSystemImpl::WriteBuffer>& Buffers,
+                      const bool bSync)
+    {
+#if defined ( __linux__ )
+        const int Descriptor = open(StringCast<ANSICHAR>(*File).Get(),
+                                    O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                    0644);
+        if (Descriptor < 0)
+        {
+            ThrowLastError(Descriptor);
+        }
+
+        std::vector<iovec> Vectors;
+        Vectors.reserve(Buffers.size());
+
+        off_t TotalSize = 0;
+        for (const GFileSystemImpl::WriteBuffer& Buffer : Buffers)
+        {
+            if (Buffer.Size > 0)
+            {
+                Vectors.push_back({const_cast<void*>(Buffer.Data),
+                                   Buffer.Size});
+                TotalSize += static_cast<off_t>(Buffer.Size);
+            }
+        }
+
+        /// NOTE
+        /// Reserving the extent up front keeps the file contiguous, a
+        /// filesystem without support only loses that
+        if (TotalSize > 0)
+        {
+            (void)fallocate(Descriptor, 0, 0, TotalSize);
+        }
+
+        std::size_t First = 0;
+        while (First < Vectors.size())
+        {
+            const int Count = static_cast<int>(
+                        std::min<std::size_t>(Vectors.size() - First,
+                                              GFILESYSTEM_MAX_IO_VECTORS));
+            const ssize_t Written = writev(Descriptor, &Vectors[First],
+                                           Count);
+            if (Written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                ThrowLastError(Descriptor);
+            }
+
+            /// NOTE
+            /// Nothing written for a non-empty request would only repeat
+            /// forever
+            if (Written == 0)
+            {
+                errno = EIO;
+                ThrowLastError(Descriptor);
+            }
+
+            /// NOTE
+            /// Resumes a short write in the middle of a buffer
+            std::size_t Remaining = static_cast<std::size_t>(Written);
+            while (Remaining > 0 && Remaining >= Vectors[First].iov_len)
+            {
+                Remaining -= Vectors[First].iov_len;
+                ++First;
+            }
+
+            if (Remaining > 0)
+            {
+                Vectors[First].iov_base =
+                        static_cast<char*>(Vectors[First].iov_base)
+                        + Remaining;
+                Vectors[First].iov_len -= Remaining;
+            }
+        }
+
+        if (bSync && fsync(Descriptor) != 0)
+        {
+            ThrowLastError(Descriptor);
+        }
+
+        if (close(Descriptor) != 0)
+        {
+            ThrowLastError(-1);
+        }
+#else
+        std::ofstream OutputFileStream(StringCast<ANSICHAR>(*File).Get(),
+                                       std::ios::out | std::ios::binary
+                                       | std::ios::trunc);
+        if (!OutputFileStream.is_open())
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+
+        for (const GFileSystemImpl::WriteBuffer& Buffer : Buffers)
+        {
+            OutputFileStream.write(static_cast<const char*>(Buffer.Data),
+                                   static_cast<std::streamsize>(Buffer.Size));
+        }
+
+        OutputFileStream.flush();
+        if (!OutputFileStream)
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+
+        OutputFileStream.close();
+
+        if (bSync)
+        {
+            SyncFile(File);
+        }
+#endif  /* defined ( __linux__ ) */
+    }
+
+    enum class ECopyStatus : uint8
+    {
+        Done,
+        Unsupported,
+        Aborted
+    };
+
+    bool ReportProgress(const GFileSystemImpl::CopyProgressCallback& OnProgress,
+                        const uint64 Copied, const uint64 Total)
+    {
+        return !OnProgress || OnProgress(Copied, Total);
+    }
+
+#if defined ( __linux__ )
+    struct FileDescriptor
+    {
+        int Value;
+
+        explicit FileDescriptor(const int InValue)
+            : Value(InValue)
+        {
+
+        }
+
+        ~FileDescriptor()
+        {
+            if (Value >= 0)
+            {
+                close(Value);
+            }
+        }
+    };
+
+    bool IsCopyUnsupported(const int Error)
+    {
+        return Error == ENOSYS || Error == EXDEV || Error == EINVAL
+                || Error == EOPNOTSUPP;
+    }
+
+    /// NOTE
+    /// Both kernel paths copy in chunks so progress can be reported, and
+    /// give up only before the first byte, when the descriptors are still
+    /// at offset zero
+    ECopyStatus CopyInKernel(
+            const int Source, const int Destination, const uint64 Total,
+            const GFileSystemImpl::CopyProgressCallback& OnProgress,
+            const bool bSendFile)
+    {
+        uint64 Copied = 0;
+
+        while (Copied < Total)
+        {
+            const std::size_t Chunk = static_cast<std::size_t>(
+                        std::min<uint64>(Total - Copied,
+                                         GFILESYSTEM_COPY_CHUNK_SIZE));
+
+            ssize_t Count = -1;
+            errno = ENOSYS;
+
+            if (bSendFile)
+            {
+                Count = sendfile(Destination, Source, nullptr, Chunk);
+            }
+#if defined ( __NR_copy_file_range )
+            else
+            {
+                /// NOTE
+                /// Through syscall(), the engine's sysroot predates the
+                /// glibc wrapper
+                Count = syscall(__NR_copy_file_range, Source, nullptr,
+                                Destination, nullptr, Chunk, 0u);
+            }
+#endif  /* defined ( __NR_copy_file_range ) */
+
+            if (Count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (Copied == 0 && IsCopyUnsupported(errno))
+                {
+                    return ECopyStatus::Unsupported;
+                }
+
+                ThrowLastError(-1);
+            }
+
+            if (Count == 0)
+            {
+                break;
+            }
+
+            Copied += static_cast<uint64>(Count);
+
+            if (!ReportProgress(OnProgress, Copied, Total))
+            {
+                return ECopyStatus::Aborted;
+            }
+        }
+
+        return ECopyStatus::Done;
+    }
+
+    ECopyStatus CopyBuffered(
+            const int Source, const int Destination, const uint64 Total,
+            const GFileSystemImpl::CopyProgressCallback& OnProgress)
+    {
+        std::vector<char> Buffer(GFILESYSTEM_COPY_BUFFER_SIZE);
+        uint64 Copied = 0;
+
+        for (;;)
+        {
+            const ssize_t Count = read(Source, Buffer.data(), Buffer.size());
+            if (Count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                ThrowLastError(-1);
+            }
+
+            if (Count == 0)
+            {
+                return ECopyStatus::Done;
+            }
+
+            ssize_t Offset = 0;
+            while (Offset < Count)
+            {
+                const ssize_t Written = write(Destination,
+                                              Buffer.data() + Offset,
+                                              static_cast<std::size_t>(
+                                                  Count - Offset));
+                if (Written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    ThrowLastError(-1);
+                }
+
+                Offset += Written;
+            }
+
+            Copied += static_cast<uint64>(Count);
+
+            if (!ReportProgress(OnProgress, Copied, Total))
+            {
+                return ECopyStatus::Aborted;
+            }
+        }
+    }
+
+    ECopyStatus CopyContents(
+            const FString& From, const FString& To, const bool bOverwrite,
+            const GFileSystemImpl::CopyProgressCallback& OnProgress,
+            bool& Out_bDestinationOpened)
+    {
+        const FileDescriptor Source(open(StringCast<ANSICHAR>(*From).Get(),
+                                         O_RDONLY | O_CLOEXEC));
+        if (Source.Value < 0)
+        {
+            ThrowLastError(-1);
+        }
+
+        struct stat Status;
+        if (fstat(Source.Value, &Status) != 0)
+        {
+            ThrowLastError(-1);
+        }
+
+        const FileDescriptor Destination(
+                    open(StringCast<ANSICHAR>(*To).Get(),
+                         O_WRONLY | O_CREAT | O_CLOEXEC
+                         | (bOverwrite ? O_TRUNC : O_EXCL),
+                         Status.st_mode & 07777));
+        if (Destination.Value < 0)
+        {
+            ThrowLastError(-1);
+        }
+
+        Out_bDestinationOpened = true;
+
+        const uint64 Total = static_cast<uint64>(Status.st_size);
+
+#if defined ( FICLONE )
+        /// NOTE
+        /// A reflink shares the extents on copy-on-write filesystems, the
+        /// copy costs no data I/O at all
+        if (ioctl(Destination.Value, FICLONE, Source.Value) == 0)
+        {
+            return ReportProgress(OnProgress, Total, Total)
+                    ? ECopyStatus::Done : ECopyStatus::Aborted;
+        }
+#endif  /* defined ( FICLONE ) */
+
+        ECopyStatus Result = CopyInKernel(Source.Value, Destination.Value,
+                                          Total, OnProgress, false);
+
+        if (Result == ECopyStatus::Unsupported)
+        {
+            Result = CopyInKernel(Source.Value, Destination.Value, Total,
+                                  OnProgress, true);
+        }
+
+        if (Result == ECopyStatus::Unsupported)
+        {
+            Result = CopyBuffered(Source.Value, Destination.Value, Total,
+                                  OnProgress);
+        }
+
+        return Result;
+    }
+#else
+    ECopyStatus CopyContents(
+            const FString& From, const FString& To, const bool bOverwrite,
+            const GFileSystemImpl::CopyProgressCallback& OnProgress,
+            bool& Out_bDestinationOpened)
+    {
+        if (!bOverwrite
+                && boost::filesystem::exists(StringCast<ANSICHAR>(*To).Get()))
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+
+        Out_bDestinationOpened = true;
+
+        if (!OnProgress)
+        {
+            boost::filesystem::copy_file(
+                        StringCast<ANSICHAR>(*From).Get(),
+                        StringCast<ANSICHAR>(*To).Get(),
+                        bOverwrite
+                        ? boost::filesystem::copy_option::overwrite_if_exists
+                        : boost::filesystem::copy_option::fail_if_exists);
+            return ECopyStatus::Done;
+        }
+
+        std::ifstream InputFileStream(StringCast<ANSICHAR>(*From).Get(),
+                                      std::ios::in | std::ios::binary);
+        std::ofstream OutputFileStream(StringCast<ANSICHAR>(*To).Get(),
+                                       std::ios::out | std::ios::binary
+                                       | std::ios::trunc);
+        if (!InputFileStream.is_open() || !OutputFileStream.is_open())
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+
+        const uint64 Total = static_cast<uint64>(
+                    boost::filesystem::file_size(
+                        StringCast<ANSICHAR>(*From).Get()));
+        std::vector<char> Buffer(GFILESYSTEM_COPY_BUFFER_SIZE);
+        uint64 Copied = 0;
+
+        while (InputFileStream)
+        {
+            InputFileStream.read(Buffer.data(),
+                                 static_cast<std::streamsize>(Buffer.size()));
+            const std::streamsize Count = InputFileStream.gcount();
+            if (Count <= 0)
+            {
+                break;
+            }
+
+            OutputFileStream.write(Buffer.data(), Count);
+            Copied += static_cast<uint64>(Count);
+
+            if (!ReportProgress(OnProgress, Copied, Total))
+            {
+                return ECopyStatus::Aborted;
+            }
+        }
+
+        /// NOTE
+        /// The loop also ends on a failed read; only a clean end of file
+        /// counts as a complete copy
+        if (InputFileStream.bad() || !InputFileStream.eof())
+        {
+            throw std::runtime_error(GFILESYSTEM_READ_ERROR);
+        }
+
+        OutputFileStream.flush();
+        if (!OutputFileStream)
+        {
+            throw std::runtime_error(GFILESYSTEM_WRITE_ERROR);
+        }
+
+        return ECopyStatus::Done;
+    }
+#endif  /* defined ( __linux__ ) */
+
+    /// NOTE
+    /// Whatever was written of the destination is removed when the copy
+    /// does not complete, one that could not be opened is left alone
+    GFileSystemImpl::ECopyResult CopyFileContents(
+            const FString& From, const FString& To, const bool bOverwrite,
+            const GFileSystemImpl::CopyProgressCallback& OnProgress)
+    {
+        bool bDestinationOpened = false;
+        boost::system::error_code ErrorCode;
+
+        try
+        {
+            if (CopyContents(From, To, bOverwrite, OnProgress,
+                             bDestinationOpened) == ECopyStatus::Done)
+            {
+                return GFileSystemImpl::ECopyResult::Succeeded;
+            }
+        }
+
+        catch (...)
+        {
+            if (bDestinationOpened)
+            {
+                boost::filesystem::remove(StringCast<ANSICHAR>(*To).Get(),
+                                          ErrorCode);
+            }
+
+            throw;
+        }
+
+        boost::filesystem::remove(StringCast<ANSICHAR>(*To).Get(),
+                                  ErrorCode);
+
+        return GFileSystemImpl::ECopyResult::Cancelled;
+    }
+
+#if defined ( __linux__ )
+    /// NOTE
+    /// Makes a rename inside the directory durable
+    void SyncDirectory(const boost::filesystem::path& Directory)
+    {
+        const int Descriptor = open(Directory.empty()
+                                    ? "." : Directory.string().c_str(),
+                                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (Descriptor >= 0)
+        {
+            (void)fsync(Descriptor);
+            close(Descriptor);
+        }
+    }
+#endif  /* defined ( __linux__ ) */
+
+    void WriteFile(const FString& File,
+                   const std::vector<GFileSystemImpl::WriteBuffer>& Buffers,
+                   const GFileSystemImpl::EWriteMode Mode)
+    {
+        if (Mode == GFileSystemImpl::EWriteMode::Truncate)
+        {
+            WriteBuffers(File, Buffers, false);
+            return;
+        }
+
+        const FString PartialFile(GFileSystemImpl::MakeTemporaryPath(File));
+        const boost::filesystem::path Target(
+                    StringCast<ANSICHAR>(*File).Get());
+
+        try
+        {
+            WriteBuffers(PartialFile, Buffers, true);
+            boost::filesystem::rename(
+                        StringCast<ANSICHAR>(*PartialFile).Get(), Target);
+        }
+
+        catch (...)
+        {
+            boost::system::error_code ErrorCode;
+            boost::filesystem::remove(
+                        StringCast<ANSICHAR>(*PartialFile).Get(), ErrorCode);
+            throw;
+        }
+
+#if defined ( __linux__ )
+        SyncDirectory(Target.parent_path());
+#endif  /* defined ( __linux__ ) */
+    }
+
+    /// NOTE
+    /// Throws on errors, OpenReadView() and TryOpenReadView() each report
+    /// those their own way
+    bool LoadView(const FString& File, const std::size_t MapThreshold,
+                  boost::iostreams::mapped_file_source& Out_Mapping,
+                  std::string& Out_Buffer, bool& Out_bMapped)
+    {
+        boost::system::error_code ErrorCode;
+        const boost::uintmax_t Size = boost::filesystem::file_size(
+                    StringCast<ANSICHAR>(*File).Get(), ErrorCode);
+
+        if (ErrorCode)
+        {
+            return false;
+        }
+
+        /// NOTE
+        /// Empty files cannot be mapped, they take the buffered path too
+        if (Size > 0 && Size >= MapThreshold)
+        {
+            Out_Mapping.open(StringCast<ANSICHAR>(*File).Get());
+            Out_bMapped = Out_Mapping.is_open();
+            return Out_bMapped;
+        }
+
+        return ReadWhole(File, Out_Buffer);
+    }
+}
+
+struct GFileSystemImpl::ReadView::Impl
+{
+    boost::iostreams::mapped_file_source Mapping;
+    std::string Buffer;
+    bool bValid;
+    bool bMapped;
+
+    Impl()
+        : bValid(false),
+          bMapped(false)
+    {
+
+    }
+};
+
+GFileSystemImpl::ReadView::ReadView()
+    : Pimpl(std::make_unique<GFileSystemImpl::ReadView::Impl>())
+{
+
+}
+
+GFileSystemImpl::ReadView::ReadView(ReadView&& Other)
+    : Pimpl(std::move(Other.Pimpl))
+{
+    Other.Pimpl = std::make_unique<GFileSystemImpl::ReadView::Impl>();
+}
+
+GFileSystemImpl::ReadView& GFileSystemImpl::ReadView::operator=(
+        ReadView&& Other)
+{
+    if (this != &Other)
+    {
+        Pimpl = std::move(Other.Pimpl);
+        Other.Pimpl = std::make_unique<GFileSystemImpl::ReadView::Impl>();
+    }
+
+    return *this;
+}
+
+GFileSystemImpl::ReadView::~ReadView() = default;
+
+bool GFileSystemImpl::ReadView::IsValid() const
+{
+    return Pimpl->bValid;
+}
+
+bool GFileSystemImpl::ReadView::IsMapped() const
+{
+    return Pimpl->bMapped;
+}
+
+const char* GFileSystemImpl::ReadView::GetData() const
+{
+    return Pimpl->bMapped ? Pimpl->Mapping.data() : Pimpl->Buffer.data();
+}
+
+std::size_t GFileSystemImpl::ReadView::GetSize() const
+{
+    return Pimpl->bMapped ? Pimpl->Mapping.size() : Pimpl->Buffer.size();
+}
 
-#include <GHacks/GInclude_Windows.h>
+bool GFileSystemImpl::ReadView::Decode(FString& Out_Data) const
+{
+    const std::size_t Size = GetSize();
 
-#define  GFILESYSTEM_ERROR_DIALOG_TITLE "IO Error"
-#define  GFILESYSTEM_UNKNOWN_ERROR      "GFileSystem: unknown error!"
+    Out_Data.Empty();
+
+    if (Size == 0)
+    {
+        return true;
+    }
+
+    if (Size > static_cast<std::size_t>(std::numeric_limits<int32>::max()))
+    {
+        return false;
+    }
+
+    const auto Converter = StringCast<WIDECHAR>(GetData(),
+                                                static_cast<int32>(Size));
+    Out_Data = FString(Converter.Length(), Converter.Get());
+
+    return true;
+}
 
 void GFileSystemImpl::CombinePaths(FString& Out_CombinedPaths,
                                    const std::initializer_list<FString>& Paths)
 {
-    boost::filesystem::path CombinedPaths;
+    GPathBuilderImpl CombinedPaths;
 
     for (const FString& Path : Paths)
     {
-        CombinedPaths /=
-                boost::filesystem::path(StringCast<ANSICHAR>(*Path).Get());
+        CombinedPaths.Append(Path);
     }
 
-    Out_CombinedPaths =
-            StringCast<WIDECHAR>(CombinedPaths.string().c_str()).Get();
+    CombinedPaths.ToString(Out_CombinedPaths);
+}
+
+FString GFileSystemImpl::MakeTemporaryPath(const FString& File)
+{
+    const boost::filesystem::path Unique(
+                boost::filesystem::unique_path(GFILESYSTEM_PARTIAL_PATTERN));
+
+    return File + StringCast<WIDECHAR>(Unique.string().c_str()).Get()
+            + TEXT(GFILESYSTEM_PARTIAL_SUFFIX);
 }
 
 bool GFileSystemImpl::DirectoryExists(const FString& Directory)
@@ -75,25 +851,10 @@ bool GFileSystemImpl::DirectoryExists(const FString& Directory)
     {
         boost::filesystem::path Path(StringCast<ANSICHAR>(*Directory).Get());
 
-        if (boost::filesystem::exists(Path))
-        {
-            if (boost::filesystem::is_directory(Path))
-            {
-                return true;
-            }
-            else if (boost::filesystem::is_regular_file(Path))
-            {
-                return false;
-            }
-            else
-            {
-                return false;
-            }
-        }
-        else
-        {
-            return false;
-        }
+        /// NOTE
+        /// One stat() instead of exists() followed by is_directory()
+        return boost::filesystem::is_directory(
+                    boost::filesystem::status(Path));
     }
 
     catch (const boost::filesystem::filesystem_error& Exception)
@@ -125,25 +886,8 @@ bool GFileSystemImpl::FileExists(const FString& File)
     {
         boost::filesystem::path Path(StringCast<ANSICHAR>(*File).Get());
 
-        if (boost::filesystem::exists(Path))
-        {
-            if (boost::filesystem::is_regular_file(Path))
-            {
-                return true;
-            }
-            else if (boost::filesystem::is_directory(Path))
-            {
-                return false;
-            }
-            else
-            {
-                return false;
-            }
-        }
-        else
-        {
-            return false;
-        }
+        return boost::filesystem::is_regular_file(
+                    boost::filesystem::status(Path));
     }
 
     catch (const boost::filesystem::filesystem_error& Exception)
@@ -304,12 +1048,66 @@ void GFileSystemImpl::CopyFile(const FString& From, const FString& To,
 {
     try
     {
-        boost::filesystem::copy_file(
-                    StringCast<ANSICHAR>(*From).Get(),
-                    StringCast<ANSICHAR>(*To).Get(),
-                    bOverwrite
-                    ? boost::filesystem::copy_option::overwrite_if_exists
-                    : boost::filesystem::copy_option::fail_if_exists);
+        (void)CopyFileContents(From, To, bOverwrite, CopyProgressCallback());
+    }
+
+    catch (const boost::filesystem::filesystem_error& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GFILESYSTEM_UNKNOWN_ERROR,
+                    GFILESYSTEM_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GFILESYSTEM_UNKNOWN_ERROR).Get());
+    }
+}
+
+GFileSystemImpl::ECopyResult GFileSystemImpl::CopyFile(
+        const FString& From, const FString& To, const bool bOverwrite,
+        const CopyProgressCallback& OnProgress)
+{
+    try
+    {
+        return CopyFileContents(From, To, bOverwrite, OnProgress);
+    }
+
+    catch (...)
+    {
+        return ECopyResult::Failed;
+    }
+}
+
+GFileSystemImpl::ReadView GFileSystemImpl::OpenReadView(
+        const FString& File, const std::size_t MapThreshold)
+{
+    ReadView View;
+
+    try
+    {
+        View.Pimpl->bValid = LoadView(File, MapThreshold,
+                                      View.Pimpl->Mapping,
+                                      View.Pimpl->Buffer,
+                                      View.Pimpl->bMapped);
     }
 
     catch (const boost::filesystem::filesystem_error& Exception)
@@ -322,6 +1120,16 @@ void GFileSystemImpl::CopyFile(const FString& From, const FString& To,
                StringCast<WIDECHAR>(Exception.what()).Get());
     }
 
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
     catch (...)
     {
 #if defined ( _WIN32 ) || defined ( _WIN64 )
@@ -331,6 +1139,29 @@ void GFileSystemImpl::CopyFile(const FString& From, const FString& To,
         checkf(false, TEXT("%s"),
                StringCast<WIDECHAR>(GFILESYSTEM_UNKNOWN_ERROR).Get());
     }
+
+    return View;
+}
+
+GFileSystemImpl::ReadView GFileSystemImpl::TryOpenReadView(
+        const FString& File, const std::size_t MapThreshold)
+{
+    ReadView View;
+
+    try
+    {
+        View.Pimpl->bValid = LoadView(File, MapThreshold,
+                                      View.Pimpl->Mapping,
+                                      View.Pimpl->Buffer,
+                                      View.Pimpl->bMapped);
+    }
+
+    catch (...)
+    {
+        return ReadView();
+    }
+
+    return View;
 }
 
 void GFileSystemImpl::Read(const FString& File, FString& Out_Data)
@@ -339,12 +1170,10 @@ void GFileSystemImpl::Read(const FString& File, FString& Out_Data)
     {
         Out_Data = TEXT("");
 
-        std::ifstream InputFileStream(StringCast<ANSICHAR>(*File).Get());
-        std::string Data((std::istreambuf_iterator<char>(InputFileStream)),
-                         std::istreambuf_iterator<char>());
-        InputFileStream.close();
-
-        Out_Data = StringCast<WIDECHAR>(Data.c_str()).Get();
+        if (!OpenReadView(File).Decode(Out_Data))
+        {
+            throw std::length_error(GFILESYSTEM_DECODE_ERROR);
+        }
     }
 
     catch (const boost::filesystem::filesystem_error& Exception)
@@ -382,12 +1211,7 @@ void GFileSystemImpl::Read(const FString& File, std::string& Out_Data)
 {
     try
     {
-        Out_Data.clear();
-
-        std::ifstream InputFileStream(StringCast<ANSICHAR>(*File).Get());
-        Out_Data.assign((std::istreambuf_iterator<char>(InputFileStream)),
-                        std::istreambuf_iterator<char>());
-        InputFileStream.close();
+        ReadWhole(File, Out_Data);
     }
 
     catch (const boost::filesystem::filesystem_error& Exception)
@@ -426,7 +1250,8 @@ void GFileSystemImpl::Write(const FString& File, const FString& Data)
     try
     {
         std::ofstream OutputFileStream(StringCast<ANSICHAR>(*File).Get(),
-                                       std::ios::out | std::ios::trunc);
+                                       std::ios::out | std::ios::binary
+                                       | std::ios::trunc);
         if (OutputFileStream.is_open())
         {
             OutputFileStream << StringCast<ANSICHAR>(*Data).Get();
@@ -479,7 +1304,8 @@ void GFileSystemImpl::Write(const FString& File, const std::string& Data)
     try
     {
         std::ofstream OutputFileStream(StringCast<ANSICHAR>(*File).Get(),
-                                       std::ios::out | std::ios::trunc);
+                                       std::ios::out | std::ios::binary
+                                       | std::ios::trunc);
         if (OutputFileStream.is_open())
         {
             OutputFileStream << Data;
@@ -526,3 +1352,195 @@ void GFileSystemImpl::Write(const FString& File, const std::string& Data)
                StringCast<WIDECHAR>(GFILESYSTEM_UNKNOWN_ERROR).Get());
     }
 }
+
+void GFileSystemImpl::Write(const FString& File, const void* Data,
+                            const std::size_t Size, const EWriteMode Mode)
+{
+    Write(File, {WriteBuffer{Data, Size}}, Mode);
+}
+
+void GFileSystemImpl::Write(const FString& File,
+                            const std::vector<WriteBuffer>& Buffers,
+                            const EWriteMode Mode)
+{
+    try
+    {
+        WriteFile(File, Buffers, Mode);
+    }
+
+    catch (const boost::filesystem::filesystem_error& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GFILESYSTEM_UNKNOWN_ERROR,
+                    GFILESYSTEM_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GFILESYSTEM_UNKNOWN_ERROR).Get());
+    }
+
+}
+
+bool GFileSystemImpl::TryCreateDirectory(const FString& Directory,
+                                         const bool bCreateParents)
+{
+    boost::system::error_code ErrorCode;
+    const boost::filesystem::path Path(StringCast<ANSICHAR>(*Directory).Get());
+
+    if (bCreateParents)
+    {
+        boost::filesystem::create_directories(Path, ErrorCode);
+    }
+    else
+    {
+        boost::filesystem::create_directory(Path, ErrorCode);
+    }
+
+    return !ErrorCode;
+}
+
+bool GFileSystemImpl::TryErase(const FString& Path, const bool bRecursive)
+{
+    boost::system::error_code ErrorCode;
+
+    if (bRecursive)
+    {
+        boost::filesystem::remove_all(StringCast<ANSICHAR>(*Path).Get(),
+                                      ErrorCode);
+    }
+    else
+    {
+        boost::filesystem::remove(StringCast<ANSICHAR>(*Path).Get(),
+                                  ErrorCode);
+    }
+
+    return !ErrorCode;
+}
+
+bool GFileSystemImpl::TryWrite(const FString& File,
+                               const std::vector<WriteBuffer>& Buffers,
+                               const EWriteMode Mode)
+{
+    try
+    {
+        WriteFile(File, Buffers, Mode);
+    }
+
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool GFileSystemImpl::CommitTemporary(const FString& TemporaryFile,
+                                      const FString& File)
+{
+    try
+    {
+        const boost::filesystem::path Target(
+                    StringCast<ANSICHAR>(*File).Get());
+
+        SyncFile(TemporaryFile);
+        boost::filesystem::rename(
+                    StringCast<ANSICHAR>(*TemporaryFile).Get(), Target);
+
+#if defined ( __linux__ )
+        SyncDirectory(Target.parent_path());
+#endif  /* defined ( __linux__ ) */
+    }
+
+    catch (...)
+    {
+        boost::system::error_code ErrorCode;
+        boost::filesystem::remove(
+                    StringCast<ANSICHAR>(*TemporaryFile).Get(), ErrorCode);
+        return false;
+    }
+
+    return true;
+}
+
+void GFileSystemImpl::Preallocate(const FString& File, const uint64 Size)
+{
+    try
+    {
+#if defined ( __linux__ )
+        const int Descriptor = open(StringCast<ANSICHAR>(*File).Get(),
+                                    O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (Descriptor < 0)
+        {
+            ThrowLastError(Descriptor);
+        }
+
+        if (Size > 0 && fallocate(Descriptor, FALLOC_FL_KEEP_SIZE, 0,
+                                  static_cast<off_t>(Size)) != 0
+                && errno != EOPNOTSUPP)
+        {
+            ThrowLastError(Descriptor);
+        }
+
+        close(Descriptor);
+#else
+        (void)Size;
+
+        if (!boost::filesystem::exists(StringCast<ANSICHAR>(*File).Get()))
+        {
+            std::ofstream OutputFileStream(
+                        StringCast<ANSICHAR>(*File).Get(),
+                        std::ios::out | std::ios::binary);
+        }
+#endif  /* defined ( __linux__ ) */
+    }
+
+    catch (const boost::filesystem::filesystem_error& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (const std::exception& Exception)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, Exception.what(), GFILESYSTEM_ERROR_DIALOG_TITLE,
+                    MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(Exception.what()).Get());
+    }
+
+    catch (...)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        MessageBoxA(0, GFILESYSTEM_UNKNOWN_ERROR,
+                    GFILESYSTEM_ERROR_DIALOG_TITLE, MB_OK);
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+        checkf(false, TEXT("%s"),
+               StringCast<WIDECHAR>(GFILESYSTEM_UNKNOWN_ERROR).Get());
+    }
+
+}
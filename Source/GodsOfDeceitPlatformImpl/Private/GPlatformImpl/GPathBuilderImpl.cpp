@@ -0,0 +1,233 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Allocation-light TCHAR path builder with interning
+ */
+
+
+#include "GPlatformImpl/GPathBuilderImpl.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include <Misc/CString.h>
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+#define     GPATH_BUILDER_SEPARATOR             TEXT('\\')
+#define     GPATH_BUILDER_MAX_LEADING           2
+#else
+#define     GPATH_BUILDER_SEPARATOR             TEXT('/')
+#define     GPATH_BUILDER_MAX_LEADING           1
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+
+namespace
+{
+    FORCEINLINE bool IsSeparator(const TCHAR Character)
+    {
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        return Character == TEXT('/') || Character == TEXT('\\');
+#else
+        return Character == TEXT('/');
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+    }
+
+    /// NOTE
+    /// Whether the trailing separator of Path is part of its root, i.e.
+    /// "/", "\\" or, on Windows, "C:\", and must never get trimmed
+    template <typename BUFFER>
+    bool EndsWithRoot(const BUFFER& Path)
+    {
+        const int32 Separator = Path.Num() - 1;
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+        if (Separator > 0 && Path[Separator - 1] == TEXT(':'))
+        {
+            return true;
+        }
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+
+        for (int32 Index = 0; Index < Separator; ++Index)
+        {
+            if (!IsSeparator(Path[Index]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+GPathBuilderImpl::GPathBuilderImpl()
+{
+    Buffer.Add(TEXT('\0'));
+}
+
+GPathBuilderImpl::GPathBuilderImpl(const TCHAR* Path)
+    : GPathBuilderImpl()
+{
+    Append(Path);
+}
+
+GPathBuilderImpl::GPathBuilderImpl(const FString& Path)
+    : GPathBuilderImpl()
+{
+    Append(Path);
+}
+
+GPathBuilderImpl& GPathBuilderImpl::Append(const TCHAR* Component,
+                                           const int32 Length)
+{
+    if (Component == nullptr || Length <= 0)
+    {
+        return *this;
+    }
+
+    Buffer.Pop(false);
+    Buffer.Reserve(Buffer.Num() + Length + 2);
+
+    int32 Index = 0;
+
+    if (Buffer.Num() > 0)
+    {
+        while (Index < Length && IsSeparator(Component[Index]))
+        {
+            ++Index;
+        }
+
+        if (Index < Length && !IsSeparator(Buffer.Last()))
+        {
+            Buffer.Add(GPATH_BUILDER_SEPARATOR);
+        }
+    }
+    else
+    {
+        /// NOTE
+        /// A root, or on Windows the "\\" of a UNC path
+        while (Index < Length && IsSeparator(Component[Index]))
+        {
+            if (Index < GPATH_BUILDER_MAX_LEADING)
+            {
+                Buffer.Add(Component[Index]);
+            }
+
+            ++Index;
+        }
+    }
+
+    /// NOTE
+    /// A "." segment can only be dropped when a separator precedes it,
+    /// a leading "." is the only thing saying the path is relative to it
+    int32 SegmentStart = Buffer.Num();
+
+    for (; Index < Length; ++Index)
+    {
+        const TCHAR Character = Component[Index];
+
+        if (!IsSeparator(Character))
+        {
+            Buffer.Add(Character);
+            continue;
+        }
+
+        if (SegmentStart > 0 && Buffer.Num() - SegmentStart == 1
+                && Buffer.Last() == TEXT('.'))
+        {
+            Buffer.Pop(false);
+            continue;
+        }
+
+        if (Buffer.Num() > 0 && IsSeparator(Buffer.Last()))
+        {
+            continue;
+        }
+
+        Buffer.Add(Character);
+        SegmentStart = Buffer.Num();
+    }
+
+    if (SegmentStart > 0 && Buffer.Num() - SegmentStart == 1
+            && Buffer.Last() == TEXT('.'))
+    {
+        Buffer.Pop(false);
+
+        if (!EndsWithRoot(Buffer))
+        {
+            Buffer.Pop(false);
+        }
+    }
+
+    Buffer.Add(TEXT('\0'));
+
+    return *this;
+}
+
+GPathBuilderImpl& GPathBuilderImpl::Append(const TCHAR* Component)
+{
+    return Component != nullptr
+            ? Append(Component, FCString::Strlen(Component)) : *this;
+}
+
+void GPathBuilderImpl::Reset()
+{
+    Buffer.Reset();
+    Buffer.Add(TEXT('\0'));
+}
+
+void GPathBuilderImpl::ToString(FString& Out_Path) const
+{
+    Out_Path.Reset(Len());
+    Out_Path.AppendChars(Buffer.GetData(), Len());
+}
+
+FString GPathBuilderImpl::ToString() const
+{
+    return FString(Len(), Buffer.GetData());
+}
+
+const TCHAR* GPathBuilderImpl::Intern(const FString& Path)
+{
+    /// NOTE
+    /// Node-based, pointers to the strings survive rehashing
+    static std::mutex Lock;
+    static std::unordered_set<std::basic_string<TCHAR>> Paths;
+
+    const GPathBuilderImpl Normalized(Path);
+
+    std::lock_guard<std::mutex> LockGuard(Lock);
+    (void)LockGuard;
+
+    return Paths.emplace(*Normalized,
+                         static_cast<std::size_t>(Normalized.Len()))
+            .first->c_str();
+}
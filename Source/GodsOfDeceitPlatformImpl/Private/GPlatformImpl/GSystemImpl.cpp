@@ -57,6 +57,34 @@ THIRD_PARTY_INCLUDES_END
 
 #include <GVersionImpl/GBuildInfoImpl.h>
 
+#include "GPlatformImpl/GPathBuilderImpl.h"
+
+namespace
+{
+    /// NOTE
+    /// Resolved and interned once; the per-user directories below are
+    /// joined against them on every call
+    const TCHAR* GetUserHomeBase()
+    {
+        static const TCHAR* const Base = GPathBuilderImpl::Intern(
+                    GSystemImpl::GetSystemDirectoryPath(
+                        EGSystemDirectory::UserHome));
+        return Base;
+    }
+
+#if defined ( _WIN32 ) || defined ( _WIN64 )
+    const TCHAR* GetMyGamesBase()
+    {
+        static const TCHAR* const Base = GPathBuilderImpl::Intern(
+                    (GPathBuilderImpl(GSystemImpl::GetSystemDirectoryPath(
+                                          EGSystemDirectory::UserDocuments))
+                     /= TEXT(GOD_WINDOWS_MY_GAMES_DIRECTORY_NAME))
+                    .ToString());
+        return Base;
+    }
+#endif  /* defined ( _WIN32 ) || defined ( _WIN64 ) */
+}
+
 FString GSystemImpl::GetExecutablePath()
 {
     boost::filesystem::path Path(
@@ -128,16 +156,9 @@ FString GSystemImpl::GetSystemDirectoryPath(const EGSystemDirectory Directory)
     case EGSystemDirectory::UserDesktop:
     {
 #if defined ( __linux__ )
-        PathString = GSystemImpl::GetSystemDirectoryPath(
-                    EGSystemDirectory::UserHome);
-        if (PathString.EndsWith(GSystemImpl::GetDirectorySeparatorChar(),
-                                ESearchCase::IgnoreCase))
-        {
-            PathString = PathString.LeftChop(PathString.Len() - 2);
-        }
-
-        PathString += GSystemImpl::GetDirectorySeparatorChar()
-                + TEXT("Desktop");
+        GPathBuilderImpl Builder(GetUserHomeBase());
+        Builder /= TEXT("Desktop");
+        Builder.ToString(PathString);
 #elif defined ( _WIN32 ) || defined ( _WIN64 )
         char PathBuffer[MAX_PATH];
         HRESULT result = SHGetFolderPathA(
@@ -158,16 +179,9 @@ FString GSystemImpl::GetSystemDirectoryPath(const EGSystemDirectory Directory)
     case EGSystemDirectory::UserDocuments:
     {
 #if defined ( __linux__ )
-        PathString = GSystemImpl::GetSystemDirectoryPath(
-                    EGSystemDirectory::UserHome);
-        if (PathString.EndsWith(GSystemImpl::GetDirectorySeparatorChar(),
-                                ESearchCase::IgnoreCase))
-        {
-            PathString = PathString.LeftChop(PathString.Len() - 2);
-        }
-
-        PathString += GSystemImpl::GetDirectorySeparatorChar()
-                + TEXT("Documents");
+        GPathBuilderImpl Builder(GetUserHomeBase());
+        Builder /= TEXT("Documents");
+        Builder.ToString(PathString);
 #elif defined ( _WIN32 ) || defined ( _WIN64 )
         char PathBuffer[MAX_PATH];
         HRESULT Result = SHGetFolderPathA(NULL, CSIDL_PERSONAL, NULL,
@@ -189,38 +203,17 @@ FString GSystemImpl::GetSystemDirectoryPath(const EGSystemDirectory Directory)
     case EGSystemDirectory::UserGameData:
     {
 #if defined ( __linux__ )
-        PathString = GSystemImpl::GetSystemDirectoryPath(
-                    EGSystemDirectory::UserHome);
-        if (PathString.EndsWith(GSystemImpl::GetDirectorySeparatorChar(),
-                                ESearchCase::IgnoreCase))
-        {
-            PathString = PathString.LeftChop(PathString.Len() - 2);
-        }
-
-        PathString += GSystemImpl::GetDirectorySeparatorChar()
-                + FString(TEXT(".local"))
-                + GSystemImpl::GetDirectorySeparatorChar()
-                + FString(TEXT("share"))
-                + GSystemImpl::GetDirectorySeparatorChar()
-                + GBuildInfoImpl::GetProductCompanyName()
-                + GSystemImpl::GetDirectorySeparatorChar()
-                + GBuildInfoImpl::GetProductName();
+        GPathBuilderImpl Builder(GetUserHomeBase());
+        Builder /= TEXT(".local");
+        Builder /= TEXT("share");
+        Builder /= GBuildInfoImpl::GetProductCompanyName();
+        Builder /= GBuildInfoImpl::GetProductName();
+        Builder.ToString(PathString);
 #elif defined ( _WIN32 ) || defined ( _WIN64 )
-        PathString = GSystemImpl::GetSystemDirectoryPath(
-                    EGSystemDirectory::UserDocuments);
-        if (PathString.EndsWith(GSystemImpl::GetDirectorySeparatorChar(),
-                                ESearchCase::IgnoreCase))
-        {
-            PathString = PathString.LeftChop(PathString.Len() - 2);
-        }
-
-        PathString += GSystemImpl::GetDirectorySeparatorChar()
-                + FString(StringCast<WIDECHAR>(
-                              GOD_WINDOWS_MY_GAMES_DIRECTORY_NAME).Get())
-                + GSystemImpl::GetDirectorySeparatorChar()
-                + GBuildInfoImpl::GetProductCompanyName()
-                + GSystemImpl::GetDirectorySeparatorChar()
-                + GBuildInfoImpl::GetProductName();
+        GPathBuilderImpl Builder(GetMyGamesBase());
+        Builder /= GBuildInfoImpl::GetProductCompanyName();
+        Builder /= GBuildInfoImpl::GetProductName();
+        Builder.ToString(PathString);
 #endif  /* defined ( __linux__ ) */
     } break;
 
@@ -0,0 +1,146 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Asynchronous, prioritized file I/O service
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+#include "GPlatformImpl/GFileSystemImpl.h"
+
+/// NOTE
+/// Runs GFileSystemImpl operations on a small pool of worker threads so
+/// that the game thread never blocks on disk. Requests are taken highest
+/// priority first, first-in first-out within a priority. Consecutive erase
+/// or directory creation requests get drained up to BatchSize per wake-up,
+/// reads, writes and copies one at a time. A request that has not started
+/// yet can be cancelled.
+///
+/// Completions are queued and delivered on whichever thread calls
+/// DispatchCompletions(), normally once per frame on the game thread.
+///
+/// There is no io_uring backend: liburing is not among the vendored
+/// third-party libraries, so every platform uses the thread pool.
+class GODSOFDECEITPLATFORMIMPL_API GAsyncFileSystemImpl
+{
+public:
+    typedef uint64 RequestId;
+
+    enum class EPriority : uint8
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    enum class EResult : uint8
+    {
+        Succeeded,
+        Failed,
+        Cancelled
+    };
+
+    typedef std::function<void(const EResult Result)> CompletionCallback;
+    typedef std::function<void(const EResult Result,
+                               const GFileSystemImpl::ReadView& View)>
+    ReadCallback;
+
+    struct Settings
+    {
+        uint32 Threads;
+        uint32 BatchSize;
+
+        Settings()
+            : Threads(2),
+              BatchSize(16)
+        {
+
+        }
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    explicit GAsyncFileSystemImpl(const Settings& InSettings = Settings());
+
+    /// NOTE
+    /// Waits for every queued request to finish, undispatched completions
+    /// are dropped
+    virtual ~GAsyncFileSystemImpl();
+
+public:
+    RequestId Read(const FString& File, const ReadCallback& OnComplete,
+                   const EPriority Priority = EPriority::Normal);
+    RequestId Write(const FString& File, std::string Data,
+                    const GFileSystemImpl::EWriteMode Mode,
+                    const CompletionCallback& OnComplete,
+                    const EPriority Priority = EPriority::Normal);
+    /// NOTE
+    /// OnProgress runs on the worker thread, returning false from it
+    /// aborts the copy and the completion reports Cancelled
+    RequestId CopyFile(const FString& From, const FString& To,
+                       const CompletionCallback& OnComplete,
+                       const EPriority Priority = EPriority::Normal,
+                       const GFileSystemImpl::CopyProgressCallback&
+                       OnProgress = GFileSystemImpl::CopyProgressCallback());
+    RequestId Erase(const FString& Path, const CompletionCallback& OnComplete,
+                    const EPriority Priority = EPriority::Normal);
+    RequestId CreateDirectory(const FString& Directory,
+                              const CompletionCallback& OnComplete,
+                              const EPriority Priority = EPriority::Normal);
+
+    /// NOTE
+    /// Returns false once the request has started or finished, otherwise
+    /// its completion reports Cancelled
+    bool Cancel(const RequestId Id);
+
+    /// NOTE
+    /// Runs the completions of finished requests on the calling thread,
+    /// returns how many ran
+    uint32 DispatchCompletions();
+
+    /// NOTE
+    /// Blocks until every request submitted so far has finished
+    void WaitForAll();
+
+    uint32 GetPendingCount() const;
+};
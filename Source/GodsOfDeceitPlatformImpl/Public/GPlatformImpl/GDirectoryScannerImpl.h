@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Parallel recursive directory scanner with filters
+ */
+
+
+#pragma once
+
+#include <ctime>
+#include <functional>
+#include <vector>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+/// NOTE
+/// Walks a directory tree on a pool of threads, each worker taking the
+/// next pending directory so that large subtrees spread across all cores.
+/// Results are streamed one directory's worth at a time through the
+/// callback; calls are serialized, but arrive on the worker threads in no
+/// particular order. Symbolic links to directories are reported but never
+/// followed, and unreadable directories are skipped.
+///
+/// The first exception thrown while scanning, by the callback or
+/// otherwise, stops handing out directories; Scan() rethrows it on the
+/// calling thread once every worker has finished.
+class GODSOFDECEITPLATFORMIMPL_API GDirectoryScannerImpl
+{
+public:
+    struct Entry
+    {
+        FString Path;
+        bool bDirectory;
+        /// NOTE
+        /// Only filled in with bCollectStats
+        uint64 Size;
+        std::time_t LastWriteTime;
+    };
+
+    typedef std::function<void(const std::vector<Entry>& Entries)>
+    ScanCallback;
+
+    struct Settings
+    {
+        /// NOTE
+        /// Zero uses one thread per hardware thread
+        uint32 Threads;
+        bool bRecursive;
+        bool bIncludeDirectories;
+        bool bCollectStats;
+        /// NOTE
+        /// Case-insensitive glob on the file name, '*' and '?' wildcards,
+        /// empty matches all
+        FString Pattern;
+        /// NOTE
+        /// Case-insensitive, with the leading dot, e.g. ".sav"; empty
+        /// matches all. Directories are never filtered by extension.
+        std::vector<FString> Extensions;
+
+        Settings()
+            : Threads(0),
+              bRecursive(true),
+              bIncludeDirectories(false),
+              bCollectStats(false)
+        {
+
+        }
+    };
+
+public:
+    /// NOTE
+    /// Blocks until the whole tree is scanned, returns the number of
+    /// entries reported
+    static uint64 Scan(const FString& Root, const Settings& InSettings,
+                       const ScanCallback& OnEntries);
+    /// NOTE
+    /// Out_Errors counts the directories that could not be opened or were
+    /// only partly listed, and the entries whose status could not be read
+    static uint64 Scan(const FString& Root, const Settings& InSettings,
+                       const ScanCallback& OnEntries, uint64& Out_Errors);
+};
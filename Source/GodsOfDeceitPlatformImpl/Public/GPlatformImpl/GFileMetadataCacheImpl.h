@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Filesystem metadata cache invalidated through inotify
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+/// NOTE
+/// Answers DirectoryExists, FileExists and GetFileSize from memory for
+/// entries inside watched directories, one stat() per entry until an
+/// inotify event on its directory invalidates it. Watches are not
+/// recursive. Paths outside the watched directories, and every path on
+/// platforms without inotify, go straight to GFileSystemImpl.
+///
+/// Events are applied on a background thread, so results can be stale for
+/// a short while, even right after this process's own writes, until that
+/// thread has drained the queue. A watched directory that is moved stops
+/// being watched.
+class GODSOFDECEITPLATFORMIMPL_API GFileMetadataCacheImpl
+{
+public:
+    struct Stats
+    {
+        uint64 Hits;
+        uint64 Misses;
+        /// NOTE
+        /// Lookups outside any watched directory
+        uint64 Bypasses;
+        uint64 Invalidations;
+        uint64 Entries;
+        uint64 WatchedDirectories;
+    };
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> Pimpl;
+
+public:
+    GFileMetadataCacheImpl();
+    virtual ~GFileMetadataCacheImpl();
+
+public:
+    /// NOTE
+    /// Returns false when the directory cannot be watched, lookups in it
+    /// are then never cached
+    bool Watch(const FString& Directory);
+    void Unwatch(const FString& Directory);
+
+    bool DirectoryExists(const FString& Directory);
+    bool FileExists(const FString& File);
+    std::size_t GetFileSize(const FString& File);
+
+    /// NOTE
+    /// Drops every cached entry, the watches stay
+    void Invalidate();
+
+    Stats GetStats() const;
+};
@@ -36,8 +36,11 @@
 
 #pragma once
 
+#include <functional>
 #include <initializer_list>
+#include <memory>
 #include <string>
+#include <vector>
 #include <cstddef>
 
 #include <Containers/StringConv.h>
@@ -46,6 +49,71 @@
 
 class GODSOFDECEITPLATFORMIMPL_API GFileSystemImpl
 {
+public:
+    /// NOTE
+    /// Read-only contents of a whole file. Files at or above the mapping
+    /// threshold are memory-mapped and paged in on access, smaller ones
+    /// are read into an owned buffer in one go. The data stays valid as
+    /// long as the view does.
+    class GODSOFDECEITPLATFORMIMPL_API ReadView
+    {
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> Pimpl;
+
+    public:
+        ReadView();
+        ReadView(ReadView&& Other);
+        ReadView& operator=(ReadView&& Other);
+        virtual ~ReadView();
+
+    public:
+        bool IsValid() const;
+        bool IsMapped() const;
+
+        const char* GetData() const;
+        std::size_t GetSize() const;
+
+        /// NOTE
+        /// Decodes the contents straight into an FString, without an
+        /// intermediate std::string. Returns false and leaves it empty for
+        /// contents larger than an FString can hold.
+        bool Decode(FString& Out_Data) const;
+
+        friend class GFileSystemImpl;
+    };
+
+    struct WriteBuffer
+    {
+        const void* Data;
+        std::size_t Size;
+    };
+
+    /// NOTE
+    /// Called as a copy makes progress, returning false aborts it
+    typedef std::function<bool(const uint64 Copied, const uint64 Total)>
+    CopyProgressCallback;
+
+    enum class ECopyResult : uint8
+    {
+        Succeeded,
+        Cancelled,
+        Failed
+    };
+
+    enum class EWriteMode : uint8
+    {
+        /// NOTE
+        /// Truncates and rewrites the file in place
+        Truncate,
+        /// NOTE
+        /// Writes a unique sibling temporary file, syncs it and renames it
+        /// over the target, readers see either the old or the new
+        /// contents. The sync happens on Linux and Windows only, and a
+        /// failed write removes the temporary file.
+        Atomic
+    };
+
 public:
     static void CombinePaths(FString& Out_CombinedPaths,
                              const std::initializer_list<FString>& Paths);
@@ -57,6 +125,12 @@ public:
         return CombinedPaths;
     }
 
+    /// NOTE
+    /// A sibling of File with a random infix and a ".partial" suffix to
+    /// write before moving it into place; concurrent writers of the same
+    /// file each get their own
+    static FString MakeTemporaryPath(const FString& File);
+
     static bool DirectoryExists(const FString& Directory);
     static bool FileExists(const FString& File);
     static std::size_t GetFileSize(const FString& File);
@@ -67,10 +141,67 @@ public:
     static void Move(const FString& From, const FString& To);
     static void CopyFile(const FString& From, const FString& To,
                          const bool bOverwrite = true);
+    /// NOTE
+    /// On Linux the copy is a reflink where the filesystem supports it,
+    /// then an in-kernel copy_file_range or sendfile, and a buffered copy
+    /// last. Returns Cancelled when aborted and Failed on errors, without
+    /// the error dialog; either way the partial copy is erased.
+    static ECopyResult CopyFile(const FString& From, const FString& To,
+                         const bool bOverwrite,
+                         const CopyProgressCallback& OnProgress);
 
+    /// NOTE
+    /// Returns an invalid view when the file cannot be opened
+    static ReadView OpenReadView(const FString& File,
+                                 const std::size_t MapThreshold = 256 * 1024);
+    /// NOTE
+    /// Same as OpenReadView() without the error dialog, any failure yields
+    /// an invalid view. Meant for worker threads.
+    static ReadView TryOpenReadView(
+            const FString& File,
+            const std::size_t MapThreshold = 256 * 1024);
+
+    /// NOTE
+    /// Strings are read and written in binary mode on every platform, the
+    /// bytes on disk round-trip unchanged and line endings are left alone
     static void Read(const FString& File, FString& Out_Data);
     static void Read(const FString& File, std::string& Out_Data);
 
     static void Write(const FString& File, const FString& Data);
     static void Write(const FString& File, const std::string& Data);
+
+    /// NOTE
+    /// Binary writes, the buffers are gathered into the file in order with
+    /// as few system calls as the platform allows
+    static void Write(const FString& File, const void* Data,
+                      const std::size_t Size,
+                      const EWriteMode Mode = EWriteMode::Truncate);
+    static void Write(const FString& File,
+                      const std::vector<WriteBuffer>& Buffers,
+                      const EWriteMode Mode = EWriteMode::Truncate);
+
+    /// NOTE
+    /// Same as CreateDirectory(), Erase() and Write() above without the
+    /// error dialog, failures are only reported through the return value.
+    /// Meant for worker threads.
+    static bool TryCreateDirectory(const FString& Directory,
+                                   const bool bCreateParents = true);
+    static bool TryErase(const FString& Path, const bool bRecursive = true);
+    static bool TryWrite(const FString& File,
+                         const std::vector<WriteBuffer>& Buffers,
+                         const EWriteMode Mode = EWriteMode::Truncate);
+
+    /// NOTE
+    /// Completes an atomic write of a file produced some other way, e.g.
+    /// streamed into MakeTemporaryPath(File): syncs TemporaryFile, renames
+    /// it over File and syncs the directory, as EWriteMode::Atomic does.
+    /// Returns false, having removed TemporaryFile, without the error
+    /// dialog.
+    static bool CommitTemporary(const FString& TemporaryFile,
+                                const FString& File);
+
+    /// NOTE
+    /// Reserves disk space for the file, creating it when missing, without
+    /// changing its visible size. A no-op where unsupported.
+    static void Preallocate(const FString& File, const uint64 Size);
 };
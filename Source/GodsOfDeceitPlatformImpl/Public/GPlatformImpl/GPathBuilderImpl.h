@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @author  Mamadou Babaei <info@babaei.net>
+ * @version 0.1.0
+ *
+ * @section LICENSE
+ *
+ * (The MIT License)
+ *
+ * Copyright (c) 2018 - 2019 Mamadou Babaei
+ * Copyright (c) 2018 - 2019 Seditious Games Studio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Allocation-light TCHAR path builder with interning
+ */
+
+
+#pragma once
+
+#include <Containers/Array.h>
+#include <Containers/ContainerAllocationPolicies.h>
+#include <Containers/UnrealString.h>
+#include <CoreTypes.h>
+
+#define     GPATH_BUILDER_INLINE_SIZE       260
+
+/// NOTE
+/// Joins path components in TCHAR, in place, without going through a
+/// narrow encoding or boost::filesystem. Paths up to
+/// GPATH_BUILDER_INLINE_SIZE characters never touch the heap.
+///
+/// Components are joined with exactly one separator, runs of separators
+/// collapse into one and "." segments are dropped; ".." is kept as it is,
+/// resolving it would be wrong across symbolic links. A leading "\\" is
+/// kept on Windows for UNC paths, and a root keeps its separator, i.e.
+/// "/." stays "/" and "C:\." becomes "C:\".
+class GODSOFDECEITPLATFORMIMPL_API GPathBuilderImpl
+{
+private:
+    /// NOTE
+    /// Always null-terminated
+    TArray<TCHAR, TInlineAllocator<GPATH_BUILDER_INLINE_SIZE>> Buffer;
+
+public:
+    GPathBuilderImpl();
+    explicit GPathBuilderImpl(const TCHAR* Path);
+    explicit GPathBuilderImpl(const FString& Path);
+
+public:
+    GPathBuilderImpl& Append(const TCHAR* Component, const int32 Length);
+    GPathBuilderImpl& Append(const TCHAR* Component);
+
+    FORCEINLINE GPathBuilderImpl& Append(const FString& Component)
+    {
+        return Append(*Component, Component.Len());
+    }
+
+    FORCEINLINE GPathBuilderImpl& operator/=(const FString& Component)
+    {
+        return Append(Component);
+    }
+
+    FORCEINLINE GPathBuilderImpl& operator/=(const TCHAR* Component)
+    {
+        return Append(Component);
+    }
+
+    /// NOTE
+    /// Keeps the storage for the next path
+    void Reset();
+
+    FORCEINLINE const TCHAR* operator*() const
+    {
+        return Buffer.GetData();
+    }
+
+    FORCEINLINE int32 Len() const
+    {
+        return Buffer.Num() - 1;
+    }
+
+    FORCEINLINE bool IsEmpty() const
+    {
+        return Len() == 0;
+    }
+
+    /// NOTE
+    /// Reuses the allocation Out_Path already has
+    void ToString(FString& Out_Path) const;
+    FString ToString() const;
+
+    /// NOTE
+    /// Normalizes the path once and returns a pointer to a process-wide
+    /// copy, the same pointer for equal paths. It stays valid until exit,
+    /// meant for base directories that are joined against over and over.
+    static const TCHAR* Intern(const FString& Path);
+};